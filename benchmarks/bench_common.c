@@ -0,0 +1,124 @@
+#include "bench_common.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syslog.h>
+#include <time.h>
+
+void bench_open_log(const char * name)
+{
+#if CONFIG_UCCN_LOGGING
+  openlog(name, LOG_PID | LOG_PERROR, LOG_USER);
+  setlogmask(LOG_UPTO(LOG_WARNING));
+#else
+  (void)name;
+#endif
+}
+
+uint64_t bench_now(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+int bench_node_init(struct uccn_node_s * node, const char * name, size_t max_num_peers)
+{
+  struct uccn_network_s network;
+#if CONFIG_UCCN_DYNAMIC_CAPACITY
+  struct uccn_node_capacity_s capacity = UCCN_NODE_CAPACITY_DEFAULT;
+#endif
+
+  inet_aton("127.0.0.1", &network.inetaddr);
+  inet_aton("255.0.0.0", &network.netmask);
+#if CONFIG_UCCN_DYNAMIC_CAPACITY
+  if (max_num_peers > 0) {
+    capacity.max_num_peers = max_num_peers;
+  }
+  if (uccn_node_init(node, &network, name, &capacity, NULL, 0) != 0) {
+#else
+  if (max_num_peers > CONFIG_UCCN_MAX_NUM_PEERS) {
+    fprintf(stderr, "'%s' node takes up to %d peers, %zu asked\n",
+            name, CONFIG_UCCN_MAX_NUM_PEERS, max_num_peers);
+    return -1;
+  }
+  if (uccn_node_init(node, &network, name) != 0) {
+#endif
+    fprintf(stderr, "Failed to initialize '%s' node\n", name);
+    return -1;
+  }
+  return 0;
+}
+
+static void * bench_spinner_main(void * arg)
+{
+  struct timespec timeout;
+  struct bench_spinner_s * spinner = arg;
+
+  TIMESPEC_SECONDS_INIT(&timeout, 1);
+  while (!__atomic_load_n(&spinner->stopped, __ATOMIC_ACQUIRE)) {
+    if (uccn_spin(spinner->node, &timeout) < 0) {
+      fprintf(stderr, "Failed to spin on '%s' node\n", spinner->node->name);
+      break;
+    }
+  }
+  return NULL;
+}
+
+int bench_spinner_start(struct bench_spinner_s * spinner, struct uccn_node_s * node)
+{
+  int ret;
+
+  spinner->node = node;
+  spinner->stopped = false;
+  if ((ret = pthread_create(&spinner->thread, NULL, bench_spinner_main, spinner)) != 0) {
+    errno = ret;
+    perror("Failed to start spinner thread");
+    return -1;
+  }
+  return 0;
+}
+
+int bench_spinner_stop(struct bench_spinner_s * spinner)
+{
+  __atomic_store_n(&spinner->stopped, true, __ATOMIC_RELEASE);
+  if (uccn_stop(spinner->node) < 0) {
+    return -1;
+  }
+  return pthread_join(spinner->thread, NULL) == 0 ? 0 : -1;
+}
+
+int bench_wait_for_links(const struct uccn_content_endpoint_s * endpoint,
+                         size_t num_peers, unsigned int timeout_ms)
+{
+  struct timespec delay;
+  uint64_t deadline = bench_now() + timeout_ms * 1000000ULL;
+
+  TIMESPEC_MICROSECONDS_INIT(&delay, 1000);
+  while (__atomic_load_n(&endpoint->num_peers, __ATOMIC_RELAXED) < num_peers) {
+    if (bench_now() > deadline) {
+      fprintf(stderr, "'%s' endpoint got %zu out of %zu peers\n", endpoint->resource->path,
+              __atomic_load_n(&endpoint->num_peers, __ATOMIC_RELAXED), num_peers);
+      return -1;
+    }
+    nanosleep(&delay, NULL);
+  }
+  return 0;
+}
+
+size_t bench_parse_size(int argc, char * argv[], int i, size_t default_value)
+{
+  char * end;
+  unsigned long value;
+
+  if (i >= argc) {
+    return default_value;
+  }
+  value = strtoul(argv[i], &end, 0);
+  if (*end != '\0' || value == 0) {
+    fprintf(stderr, "Ignoring '%s', not a positive integer\n", argv[i]);
+    return default_value;
+  }
+  return value;
+}
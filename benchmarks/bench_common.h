@@ -0,0 +1,56 @@
+#ifndef BENCHMARKS_BENCH_COMMON_H_
+#define BENCHMARKS_BENCH_COMMON_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <pthread.h>
+
+#include "uccn/uccn.h"
+
+#if !CONFIG_UCCN_MULTITHREADED
+#error "Benchmarks spin nodes on threads of their own"
+#endif
+
+// Spins a node on a thread of its own until stopped
+struct bench_spinner_s
+{
+  struct uccn_node_s * node;
+  pthread_t thread;
+  bool stopped;
+};
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+// Logs warnings and errors to stderr, leaving the rest out of measurements
+void bench_open_log(const char * name);
+
+// Monotonic time, in nanoseconds
+uint64_t bench_now(void);
+
+// Brings up a node on the loopback interface. Nodes take as many peers
+// as asked (zero for the default) in dynamic capacity builds, and fail to
+// come up if asked more than they can take otherwise.
+int bench_node_init(struct uccn_node_s * node, const char * name, size_t max_num_peers);
+
+int bench_spinner_start(struct bench_spinner_s * spinner, struct uccn_node_s * node);
+
+int bench_spinner_stop(struct bench_spinner_s * spinner);
+
+// Waits for an endpoint to be linked to as many peers, while something
+// else spins its node. Returns -1 on timeout.
+int bench_wait_for_links(const struct uccn_content_endpoint_s * endpoint,
+                         size_t num_peers, unsigned int timeout_ms);
+
+// Parses a positive integer argument, falling back to a default
+size_t bench_parse_size(int argc, char * argv[], int i, size_t default_value);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // BENCHMARKS_BENCH_COMMON_H_
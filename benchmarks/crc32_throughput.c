@@ -0,0 +1,88 @@
+// Checksums buffers from 16 bytes up to 1 MB with each CRC32 kernel this
+// CPU supports, and with crc32() as dispatched, to tell their throughput.
+//
+// Usage: crc32_throughput [total_bytes_per_size]
+
+// Kernels are static, so they are built right into the benchmark
+#include "../src/common/crc32.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench_common.h"
+
+#define MIN_SIZE 16
+#define MAX_SIZE (1024 * 1024)
+
+struct kernel_s
+{
+  const char * name;
+  crc32_kernel_fn kernel;
+};
+
+static double measure(crc32_kernel_fn kernel, const uint8_t * buffer,
+                      size_t size, size_t total_bytes)
+{
+  size_t i, num_rounds = total_bytes / size;
+  uint64_t start, elapsed;
+  volatile uint32_t sink = 0;
+
+  // Warm up caches and branch predictors
+  sink ^= kernel(0, buffer, size);
+  start = bench_now();
+  for (i = 0; i < num_rounds; ++i) {
+    sink ^= kernel(sink, buffer, size);
+  }
+  elapsed = bench_now() - start;
+  return (double)num_rounds * size / (elapsed > 0 ? elapsed : 1);
+}
+
+int main(int argc, char * argv[])
+{
+  size_t i, k, size, num_kernels = 0;
+  uint8_t * buffer;
+  struct kernel_s kernels[5];
+
+  size_t total_bytes = bench_parse_size(argc, argv, 1, 256 * 1024 * 1024);
+
+  bench_open_log(argv[0]);
+  if ((buffer = malloc(MAX_SIZE)) == NULL) {
+    perror("Failed to allocate benchmark buffer");
+    return EXIT_FAILURE;
+  }
+  for (i = 0; i < MAX_SIZE; ++i) {
+    buffer[i] = (uint8_t)(i * 31 + (i >> 8));
+  }
+  // Sets up slicing tables, and the kernel in use
+  crc32_dispatch(0, buffer, 0);
+
+  kernels[num_kernels++] = (struct kernel_s){ "bytewise", crc32_bytewise };
+  kernels[num_kernels++] = (struct kernel_s){ "slice-by-8", crc32_slice_by_8 };
+#if CRC32_PCLMUL
+  if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1")) {
+    kernels[num_kernels++] = (struct kernel_s){ "pclmul", crc32_pclmul };
+  }
+#elif CRC32_ARMV8
+  if (getauxval(AT_HWCAP) & HWCAP_CRC32) {
+    kernels[num_kernels++] = (struct kernel_s){ "armv8", crc32_armv8 };
+  }
+#endif
+  kernels[num_kernels++] = (struct kernel_s){ "crc32()", crc32_update };
+
+  printf("GB/s, %zu bytes per size\n%10s", total_bytes, "size");
+  for (k = 0; k < num_kernels; ++k) {
+    printf(" %12s", kernels[k].name);
+  }
+  printf("\n");
+  for (size = MIN_SIZE; size <= MAX_SIZE; size *= 4) {
+    printf("%10zu", size);
+    for (k = 0; k < num_kernels; ++k) {
+      // Bytewise would take ages over the same amount of data
+      printf(" %12.2f", measure(kernels[k].kernel, buffer, size,
+                                k == 0 ? total_bytes / 16 : total_bytes));
+    }
+    printf("\n");
+  }
+  free(buffer);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,193 @@
+// Brings a tracker up, then its provider after a growing delay, and tells
+// how long the tracker took to link to it and how many discovery packets
+// it sent meanwhile, next to how many a fixed discovery period would have
+// taken. Discovery packets are counted by listening on the discovery port,
+// as every node on the host does.
+//
+// Usage: discovery_convergence [max_delay_s]
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "uccn/uccn.h"
+
+#include "bench_common.h"
+
+struct sniffer_s
+{
+  int socket;
+  pthread_t thread;
+  bool stopped;
+  size_t num_packets;
+};
+
+static void * sniffer_main(void * arg)
+{
+  char buffer[CONFIG_UCCN_INCOMING_BUFFER_SIZE];
+  struct sniffer_s * sniffer = arg;
+
+  while (!__atomic_load_n(&sniffer->stopped, __ATOMIC_ACQUIRE)) {
+    if (recv(sniffer->socket, buffer, sizeof(buffer), 0) >= 0) {
+      __atomic_fetch_add(&sniffer->num_packets, 1, __ATOMIC_RELAXED);
+    }
+  }
+  return NULL;
+}
+
+static int sniffer_start(struct sniffer_s * sniffer)
+{
+  int opt = 1;
+  struct sockaddr_in address;
+  struct timeval timeout = { .tv_sec = 0, .tv_usec = 100000 };
+#if CONFIG_UCCN_MULTICAST_DISCOVERY
+  struct ip_mreq membership;
+#endif
+
+  memset(sniffer, 0, sizeof(*sniffer));
+  if ((sniffer->socket = socket(PF_INET, SOCK_DGRAM, 0)) < 0) {
+    return -1;
+  }
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(CONFIG_UCCN_PORT);
+  address.sin_addr.s_addr = INADDR_ANY;
+  if (setsockopt(sniffer->socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+      setsockopt(sniffer->socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0 ||
+      bind(sniffer->socket, (struct sockaddr *)&address, sizeof(address)) < 0) {
+    goto fail;
+  }
+#if CONFIG_UCCN_MULTICAST_DISCOVERY
+  membership.imr_multiaddr.s_addr = htonl(CONFIG_UCCN_DISCOVERY_GROUP);
+  inet_aton("127.0.0.1", &membership.imr_interface);
+  if (setsockopt(sniffer->socket, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+                 &membership, sizeof(membership)) < 0) {
+    goto fail;
+  }
+#endif
+  if (pthread_create(&sniffer->thread, NULL, sniffer_main, sniffer) != 0) {
+    goto fail;
+  }
+  return 0;
+ fail:
+  close(sniffer->socket);
+  return -1;
+}
+
+static void sniffer_stop(struct sniffer_s * sniffer)
+{
+  __atomic_store_n(&sniffer->stopped, true, __ATOMIC_RELEASE);
+  pthread_join(sniffer->thread, NULL);
+  close(sniffer->socket);
+}
+
+static void on_content(struct uccn_content_tracker_s * tracker, void * content)
+{
+  (void)tracker;
+  (void)content;
+}
+
+static void sleep_ms(uint64_t ms)
+{
+  struct timespec delay = { .tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000 };
+
+  while (nanosleep(&delay, &delay) < 0 && errno == EINTR) {
+  }
+}
+
+int main(int argc, char * argv[])
+{
+  int ret = EXIT_FAILURE;
+  size_t delay_s, num_nodes = 0, num_spinners = 0;
+  size_t num_packets, num_fixed_packets;
+  uint64_t start, convergence_time;
+
+  size_t max_delay_s = bench_parse_size(argc, argv, 1, 8);
+
+  struct uccn_node_s nodes[2];
+  struct bench_spinner_s spinners[2];
+  struct uccn_raw_data_s resource;
+  struct uccn_content_tracker_s * tracker;
+  struct sniffer_s sniffer;
+
+  bench_open_log(argv[0]);
+  if (sniffer_start(&sniffer) < 0) {
+    perror("Failed to listen on the discovery port");
+    return EXIT_FAILURE;
+  }
+  uccn_raw_data_init(&resource, "/bench/discovery");
+
+  printf("provider delayed up to %zu s, discovery every %d ms up to %d ms\n",
+         max_delay_s, CONFIG_UCCN_PEER_DISCOVERY_PERIOD_MS,
+         CONFIG_UCCN_MAX_PEER_DISCOVERY_PERIOD_MS);
+  printf("%10s %16s %12s %12s\n", "delay s", "convergence ms", "packets", "fixed period");
+  for (delay_s = 0; ; delay_s = delay_s > 0 ? delay_s * 2 : 1) {
+    if (delay_s > max_delay_s) {
+      delay_s = max_delay_s;
+    }
+    if (bench_node_init(&nodes[0], "tracker", 0) < 0) {
+      goto leave;
+    }
+    ++num_nodes;
+    if ((tracker = uccn_track(&nodes[0], &resource.base, on_content, NULL)) == NULL) {
+      goto leave;
+    }
+    __atomic_store_n(&sniffer.num_packets, 0, __ATOMIC_RELAXED);
+    start = bench_now();
+    if (bench_spinner_start(&spinners[0], &nodes[0]) < 0) {
+      goto leave;
+    }
+    ++num_spinners;
+    sleep_ms(delay_s * 1000);
+
+    if (bench_node_init(&nodes[1], "provider", 0) < 0) {
+      goto leave;
+    }
+    ++num_nodes;
+    if (uccn_advertise(&nodes[1], &resource.base) == NULL) {
+      goto leave;
+    }
+    if (bench_spinner_start(&spinners[1], &nodes[1]) < 0) {
+      goto leave;
+    }
+    ++num_spinners;
+    if (bench_wait_for_links(&tracker->endpoint, 1,
+                             2 * CONFIG_UCCN_MAX_PEER_DISCOVERY_PERIOD_MS) < 0) {
+      goto leave;
+    }
+    convergence_time = bench_now() - start - delay_s * 1000000000ull;
+    num_packets = __atomic_load_n(&sniffer.num_packets, __ATOMIC_RELAXED);
+    // Packets a fixed period would have taken to the same point in time
+    num_fixed_packets = 1 + (delay_s * 1000 + convergence_time / 1000000) /
+        CONFIG_UCCN_PEER_DISCOVERY_PERIOD_MS;
+    printf("%10zu %16.1f %12zu %12zu\n", delay_s, convergence_time / 1e6,
+           num_packets, num_fixed_packets);
+
+    while (num_spinners > 0) {
+      bench_spinner_stop(&spinners[--num_spinners]);
+    }
+    while (num_nodes > 0) {
+      uccn_node_fini(&nodes[--num_nodes]);
+    }
+    if (delay_s == max_delay_s) {
+      break;
+    }
+  }
+  ret = EXIT_SUCCESS;
+ leave:
+  while (num_spinners > 0) {
+    bench_spinner_stop(&spinners[--num_spinners]);
+  }
+  while (num_nodes > 0) {
+    uccn_node_fini(&nodes[--num_nodes]);
+  }
+  sniffer_stop(&sniffer);
+  return ret;
+}
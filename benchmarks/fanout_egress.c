@@ -0,0 +1,194 @@
+// Fans content out to a growing number of trackers on loopback, through
+// uccn_fanout_endpoint(), and tells how many datagrams and bytes left the
+// host and how much CPU time the posting thread took per post. Unicast
+// fanout grows linearly with trackers, multicast builds send to the group
+// once, and shared memory builds take rings to trackers on the same host
+// instead. Datagrams are read off the kernel UDP counters, so anything else
+// sending over UDP meanwhile adds to them.
+//
+// Usage: fanout_egress [max_num_trackers] [num_posts] [content_size]
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "uccn/uccn.h"
+#include "uccn/uccn_internal.h"
+
+#include "bench_common.h"
+
+// IPv4 and UDP headers
+#define UDP_OVERHEAD  28
+
+static int read_out_datagrams(uint64_t * count)
+{
+  FILE * fp;
+  int ret = -1;
+  bool header_read = false;
+  char line[512];
+  unsigned long long fields[4];
+
+  if ((fp = fopen("/proc/net/snmp", "r")) == NULL) {
+    return -1;
+  }
+  while (fgets(line, sizeof(line), fp) != NULL) {
+    if (strncmp(line, "Udp:", 4) != 0) {
+      continue;
+    }
+    // First line names fields, second one holds counters
+    if (!header_read) {
+      header_read = true;
+      continue;
+    }
+    if (sscanf(line, "Udp: %llu %llu %llu %llu",
+               &fields[0], &fields[1], &fields[2], &fields[3]) == 4) {
+      *count = fields[3];
+      ret = 0;
+    }
+    break;
+  }
+  fclose(fp);
+  return ret;
+}
+
+static uint64_t thread_cpu_now(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static void on_content(struct uccn_content_tracker_s * tracker, void * content)
+{
+  (void)content;
+  __atomic_fetch_add((size_t *)tracker->arg, 1, __ATOMIC_RELAXED);
+}
+
+int main(int argc, char * argv[])
+{
+  int ret = EXIT_FAILURE;
+  size_t i, num_trackers;
+  uint64_t start, cpu_time, datagrams_before, datagrams_after, datagrams;
+
+  size_t max_num_trackers = bench_parse_size(argc, argv, 1, CONFIG_UCCN_MAX_NUM_PEERS - 1);
+  size_t num_posts = bench_parse_size(argc, argv, 2, 20000);
+  size_t content_size = bench_parse_size(argc, argv, 3, 64);
+
+  struct uccn_node_s * nodes;
+  struct bench_spinner_s * spinners;
+  size_t num_nodes = 0, num_spinners = 0;
+  size_t num_received = 0;
+
+  struct uccn_raw_data_s resource;
+  struct uccn_content_provider_s * provider;
+  struct iovec iov[2];
+  char header[UCCN_CONTENT_HEADER_SIZE];
+
+  bench_open_log(argv[0]);
+  if (content_size + UCCN_CONTENT_HEADER_ROOM > CONFIG_UCCN_OUTGOING_BUFFER_SIZE) {
+    fprintf(stderr, "Up to %d bytes of content fit a packet\n",
+            CONFIG_UCCN_OUTGOING_BUFFER_SIZE - UCCN_CONTENT_HEADER_ROOM);
+    return EXIT_FAILURE;
+  }
+  if (read_out_datagrams(&datagrams_before) < 0) {
+    perror("Failed to read UDP counters");
+    return EXIT_FAILURE;
+  }
+
+  nodes = calloc(max_num_trackers + 1, sizeof(*nodes));
+  spinners = calloc(max_num_trackers + 1, sizeof(*spinners));
+  iov[1].iov_base = calloc(1, content_size);
+  iov[1].iov_len = content_size;
+  if (nodes == NULL || spinners == NULL || iov[1].iov_base == NULL) {
+    perror("Failed to allocate benchmark state");
+    goto leave;
+  }
+
+  uccn_raw_data_init(&resource, "/bench/egress");
+  if (bench_node_init(&nodes[0], "provider", max_num_trackers + 1) < 0) {
+    goto leave;
+  }
+  ++num_nodes;
+  if ((provider = uccn_advertise(&nodes[0], &resource.base)) == NULL) {
+    goto leave;
+  }
+  if (bench_spinner_start(&spinners[0], &nodes[0]) < 0) {
+    goto leave;
+  }
+  ++num_spinners;
+
+  iov[0].iov_base = header;
+  iov[0].iov_len = uccn_write_content_header(header, resource.base.hash,
+                                             NULL, content_size);
+
+#if CONFIG_UCCN_MULTICAST_CONTENT
+  printf("multicast fanout, ");
+#else
+  printf("unicast fanout, ");
+#endif
+  printf("%zu posts of %zu bytes\n", num_posts, content_size);
+  printf("%10s %16s %16s %14s %12s\n", "trackers", "datagrams/post",
+         "egress B/post", "cpu ns/post", "received");
+  for (num_trackers = 1; ; num_trackers *= 2) {
+    if (num_trackers > max_num_trackers) {
+      num_trackers = max_num_trackers;
+    }
+    // Bring more trackers up, and wait for all to be linked
+    for (i = num_nodes; i <= num_trackers; ++i) {
+      if (bench_node_init(&nodes[i], "tracker", max_num_trackers + 1) < 0) {
+        goto leave;
+      }
+      ++num_nodes;
+      if (uccn_track(&nodes[i], &resource.base, on_content, &num_received) == NULL) {
+        goto leave;
+      }
+      if (bench_spinner_start(&spinners[i], &nodes[i]) < 0) {
+        goto leave;
+      }
+      ++num_spinners;
+    }
+    if (bench_wait_for_links(&provider->endpoint, num_trackers, 10000) < 0) {
+      goto leave;
+    }
+
+    __atomic_store_n(&num_received, 0, __ATOMIC_RELAXED);
+    if (read_out_datagrams(&datagrams_before) < 0) {
+      goto leave;
+    }
+    start = thread_cpu_now();
+    for (i = 0; i < num_posts; ++i) {
+      if (uccn_fanout_endpoint(&provider->endpoint, iov, NULL, 2) < 0) {
+        fprintf(stderr, "Failed to fan content out (%s)\n", strerror(errno));
+        goto leave;
+      }
+    }
+    cpu_time = thread_cpu_now() - start;
+    if (read_out_datagrams(&datagrams_after) < 0) {
+      goto leave;
+    }
+    datagrams = datagrams_after - datagrams_before;
+    printf("%10zu %16.2f %16.1f %14.0f %12zu\n", num_trackers,
+           (double)datagrams / num_posts,
+           (double)datagrams * (iov[0].iov_len + content_size + UDP_OVERHEAD) / num_posts,
+           (double)cpu_time / num_posts,
+           __atomic_load_n(&num_received, __ATOMIC_RELAXED));
+    if (num_trackers == max_num_trackers) {
+      break;
+    }
+  }
+  ret = EXIT_SUCCESS;
+ leave:
+  for (i = 0; i < num_spinners; ++i) {
+    bench_spinner_stop(&spinners[i]);
+  }
+  for (i = 0; i < num_nodes; ++i) {
+    uccn_node_fini(&nodes[i]);
+  }
+  free(iov[1].iov_base);
+  free(spinners);
+  free(nodes);
+  return ret;
+}
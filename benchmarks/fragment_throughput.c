@@ -0,0 +1,155 @@
+// Posts raw content from 1 KB up to 8 MB to a tracker on loopback, one
+// post at a time, and times how long it takes to be reassembled and
+// delivered. The tracker asks for a socket receive buffer large enough
+// to take whole posts, as fragments otherwise get dropped in bursts.
+//
+// Usage: fragment_throughput [max_content_size] [bytes_per_size]
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/socket.h>
+
+#include "uccn/uccn.h"
+
+#include "bench_common.h"
+
+#if !CONFIG_UCCN_FRAGMENTATION
+#error "Content has to be fragmented to go beyond a packet"
+#endif
+
+static void on_content(struct uccn_content_tracker_s * tracker, void * content)
+{
+  struct buffer_head_s * blob = content;
+  __atomic_store_n((size_t *)tracker->arg, blob->length, __ATOMIC_RELEASE);
+}
+
+static int wait_for_content(size_t * received, size_t length, unsigned int timeout_ms)
+{
+  struct timespec delay;
+  uint64_t deadline = bench_now() + timeout_ms * 1000000ULL;
+
+  TIMESPEC_MICROSECONDS_INIT(&delay, 20);
+  while (__atomic_load_n(received, __ATOMIC_ACQUIRE) != length) {
+    if (bench_now() > deadline) {
+      return -1;
+    }
+    nanosleep(&delay, NULL);
+  }
+  return 0;
+}
+
+int main(int argc, char * argv[])
+{
+  int ret = EXIT_FAILURE;
+  int buffer_size;
+  socklen_t option_size = sizeof(buffer_size);
+  size_t i, size, num_posts, num_delivered;
+  size_t received = 0;
+  uint64_t start, elapsed, latency;
+
+  size_t max_content_size = bench_parse_size(argc, argv, 1, CONFIG_UCCN_MAX_REASSEMBLY_SIZE);
+  size_t bytes_per_size = bench_parse_size(argc, argv, 2, 64 * 1024 * 1024);
+
+  struct uccn_node_s nodes[2];
+  struct bench_spinner_s spinners[2];
+  size_t num_nodes = 0, num_spinners = 0;
+
+  struct uccn_raw_data_s resource;
+  struct uccn_content_provider_s * provider;
+  struct uccn_content_tracker_s * tracker;
+  struct buffer_head_s content;
+
+  bench_open_log(argv[0]);
+  if (max_content_size > CONFIG_UCCN_MAX_REASSEMBLY_SIZE) {
+    fprintf(stderr, "Up to %d bytes of content can be reassembled\n",
+            CONFIG_UCCN_MAX_REASSEMBLY_SIZE);
+    return EXIT_FAILURE;
+  }
+  content.data = malloc(max_content_size);
+  if (content.data == NULL) {
+    perror("Failed to allocate content");
+    return EXIT_FAILURE;
+  }
+  for (i = 0; i < max_content_size; ++i) {
+    ((char *)content.data)[i] = (char)i;
+  }
+  content.size = max_content_size;
+
+  uccn_raw_data_init(&resource, "/bench/fragments");
+  if (bench_node_init(&nodes[0], "provider", 0) < 0) {
+    goto leave;
+  }
+  ++num_nodes;
+  if (bench_node_init(&nodes[1], "tracker", 0) < 0) {
+    goto leave;
+  }
+  ++num_nodes;
+  if ((provider = uccn_advertise(&nodes[0], &resource.base)) == NULL ||
+      (tracker = uccn_track(&nodes[1], &resource.base, on_content, &received)) == NULL) {
+    goto leave;
+  }
+  // Forcing it past the system maximum takes privileges, try anyway
+  buffer_size = 4 * max_content_size;
+  if (setsockopt(nodes[1].socket, SOL_SOCKET, SO_RCVBUFFORCE,
+                 &buffer_size, sizeof(buffer_size)) < 0) {
+    setsockopt(nodes[1].socket, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+  }
+  getsockopt(nodes[1].socket, SOL_SOCKET, SO_RCVBUF, &buffer_size, &option_size);
+
+  for (i = 0; i < num_nodes; ++i) {
+    if (bench_spinner_start(&spinners[i], &nodes[i]) < 0) {
+      goto leave;
+    }
+    ++num_spinners;
+  }
+  if (bench_wait_for_links(&provider->endpoint, 1, 10000) < 0) {
+    goto leave;
+  }
+
+  printf("%d bytes of tracker socket receive buffer\n", buffer_size);
+  printf("%10s %10s %12s %12s %10s\n", "size", "fragments", "MB/s", "latency us", "delivered");
+  for (size = 1024; size <= max_content_size; size *= 2) {
+    num_posts = bytes_per_size / size;
+    if (num_posts < 4) {
+      num_posts = 4;
+    } else if (num_posts > 1000) {
+      num_posts = 1000;
+    }
+    content.length = size;
+    num_delivered = 0;
+    latency = 0;
+    start = bench_now();
+    for (i = 0; i < num_posts; ++i) {
+      __atomic_store_n(&received, 0, __ATOMIC_RELAXED);
+      elapsed = bench_now();
+      if (uccn_post(provider, &content) < 0) {
+        fprintf(stderr, "Failed to post %zu bytes (%s)\n", size, strerror(errno));
+        goto leave;
+      }
+      // Lost fragments leave content incomplete, move on past those
+      if (wait_for_content(&received, size, CONFIG_UCCN_REASSEMBLY_TIMEOUT_MS) == 0) {
+        latency += bench_now() - elapsed;
+        ++num_delivered;
+      }
+    }
+    elapsed = bench_now() - start;
+    printf("%10zu %10zu %12.1f %12.1f %9zu%%\n", size,
+           (size + CONFIG_UCCN_MAX_FRAGMENT_SIZE - 1) / CONFIG_UCCN_MAX_FRAGMENT_SIZE,
+           num_delivered * size * 1e3 / elapsed,
+           num_delivered > 0 ? latency / 1e3 / num_delivered : 0.,
+           100 * num_delivered / num_posts);
+  }
+  ret = EXIT_SUCCESS;
+ leave:
+  for (i = 0; i < num_spinners; ++i) {
+    bench_spinner_stop(&spinners[i]);
+  }
+  for (i = 0; i < num_nodes; ++i) {
+    uccn_node_fini(&nodes[i]);
+  }
+  free(content.data);
+  return ret;
+}
@@ -0,0 +1,202 @@
+// Has N publisher threads post to the same provider, or just read its
+// links, while the node spins on another thread and links get updated
+// every so often, as link groups do. Posts read links under a sequence
+// lock, so publishers should scale without waiting on one another.
+//
+// Usage: post_contention [max_num_publishers] [duration_ms] [update_period_us]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uccn/uccn.h"
+#include "uccn/uccn_internal.h"
+
+#include "bench_common.h"
+
+#define NUM_TRACKERS 2
+
+struct publisher_s
+{
+  struct uccn_content_provider_s * provider;
+  const struct buffer_head_s * content;
+  bool read_only;
+  pthread_t thread;
+  uint64_t num_ops;
+  uint64_t max_latency;
+};
+
+struct updater_s
+{
+  struct uccn_content_provider_s * provider;
+  long period_us;
+  pthread_t thread;
+};
+
+static bool g_stopped;
+
+static void on_content(struct uccn_content_tracker_s * tracker, void * content)
+{
+  (void)tracker;
+  (void)content;
+}
+
+static void * publisher_main(void * arg)
+{
+  size_t num_peers;
+  uint64_t start, latency;
+  struct uccn_link_s links[CONFIG_UCCN_SEND_BATCH_SIZE];
+  struct publisher_s * publisher = arg;
+
+  while (!__atomic_load_n(&g_stopped, __ATOMIC_RELAXED)) {
+    start = bench_now();
+    if (publisher->read_only) {
+      uccn_read_links(&publisher->provider->endpoint, 0, links,
+                      CONFIG_UCCN_SEND_BATCH_SIZE, &num_peers);
+    } else if (uccn_post(publisher->provider, publisher->content) < 0) {
+      fprintf(stderr, "Failed to post content\n");
+      break;
+    }
+    latency = bench_now() - start;
+    if (latency > publisher->max_latency) {
+      publisher->max_latency = latency;
+    }
+    ++publisher->num_ops;
+  }
+  return NULL;
+}
+
+// Rewrites links as they are, as relinking on link groups would
+static void * updater_main(void * arg)
+{
+  struct timespec period;
+  struct updater_s * updater = arg;
+  struct uccn_content_endpoint_s * endpoint = &updater->provider->endpoint;
+  struct uccn_node_s * node = endpoint->node;
+
+  period.tv_sec = updater->period_us / 1000000;
+  period.tv_nsec = (updater->period_us % 1000000) * 1000;
+  while (!__atomic_load_n(&g_stopped, __ATOMIC_RELAXED)) {
+    pthread_mutex_lock(&node->mutex);
+    uccn_begin_links_update(endpoint);
+    memmove(endpoint->peers, endpoint->peers, endpoint->num_peers * sizeof(*endpoint->peers));
+    uccn_end_links_update(endpoint);
+    pthread_mutex_unlock(&node->mutex);
+    nanosleep(&period, NULL);
+  }
+  return NULL;
+}
+
+int main(int argc, char * argv[])
+{
+  int ret = EXIT_FAILURE;
+  size_t i, n, phase, num_started;
+  uint64_t total_ops, max_latency;
+  char data[64];
+
+  size_t max_num_publishers = bench_parse_size(argc, argv, 1, 8);
+  size_t duration_ms = bench_parse_size(argc, argv, 2, 1000);
+  size_t update_period_us = bench_parse_size(argc, argv, 3, 100);
+
+  struct uccn_node_s nodes[1 + NUM_TRACKERS];
+  struct bench_spinner_s spinners[1 + NUM_TRACKERS];
+  size_t num_nodes = 0, num_spinners = 0;
+
+  struct uccn_raw_data_s resource;
+  struct uccn_content_provider_s * provider;
+  struct buffer_head_s content = { data, sizeof(data), sizeof(data) };
+  struct publisher_s * publishers;
+  struct updater_s updater;
+  struct timespec duration;
+
+  static const char * phases[] = { "read links", "post" };
+
+  bench_open_log(argv[0]);
+  memset(data, 0, sizeof(data));
+  publishers = calloc(max_num_publishers, sizeof(*publishers));
+  if (publishers == NULL) {
+    perror("Failed to allocate publishers");
+    return EXIT_FAILURE;
+  }
+
+  uccn_raw_data_init(&resource, "/bench/contention");
+  for (i = 0; i < 1 + NUM_TRACKERS; ++i) {
+    if (bench_node_init(&nodes[i], i == 0 ? "provider" : "tracker", 0) < 0) {
+      goto leave;
+    }
+    ++num_nodes;
+  }
+  if ((provider = uccn_advertise(&nodes[0], &resource.base)) == NULL) {
+    goto leave;
+  }
+  for (i = 1; i < num_nodes; ++i) {
+    if (uccn_track(&nodes[i], &resource.base, on_content, NULL) == NULL) {
+      goto leave;
+    }
+  }
+  for (i = 0; i < num_nodes; ++i) {
+    if (bench_spinner_start(&spinners[i], &nodes[i]) < 0) {
+      goto leave;
+    }
+    ++num_spinners;
+  }
+  if (bench_wait_for_links(&provider->endpoint, NUM_TRACKERS, 10000) < 0) {
+    goto leave;
+  }
+
+  duration.tv_sec = duration_ms / 1000;
+  duration.tv_nsec = (duration_ms % 1000) * 1000000L;
+  printf("%zu trackers, links updated every %zu us\n", (size_t)NUM_TRACKERS, update_period_us);
+  printf("%-12s %10s %14s %14s %14s\n", "", "threads", "ops/s", "ops/s/thread", "max ns");
+  for (phase = 0; phase < 2; ++phase) {
+    for (n = 1; n <= max_num_publishers; n *= 2) {
+      __atomic_store_n(&g_stopped, false, __ATOMIC_RELAXED);
+      for (i = 0; i < n; ++i) {
+        memset(&publishers[i], 0, sizeof(publishers[i]));
+        publishers[i].provider = provider;
+        publishers[i].content = &content;
+        publishers[i].read_only = phase == 0;
+      }
+      updater.provider = provider;
+      updater.period_us = update_period_us;
+      if (pthread_create(&updater.thread, NULL, updater_main, &updater) != 0) {
+        perror("Failed to start updater");
+        goto leave;
+      }
+      for (num_started = 0; num_started < n; ++num_started) {
+        if (pthread_create(&publishers[num_started].thread, NULL,
+                           publisher_main, &publishers[num_started]) != 0) {
+          perror("Failed to start publisher");
+          break;
+        }
+      }
+      nanosleep(&duration, NULL);
+      __atomic_store_n(&g_stopped, true, __ATOMIC_RELAXED);
+      pthread_join(updater.thread, NULL);
+      total_ops = max_latency = 0;
+      for (i = 0; i < num_started; ++i) {
+        pthread_join(publishers[i].thread, NULL);
+        total_ops += publishers[i].num_ops;
+        if (publishers[i].max_latency > max_latency) {
+          max_latency = publishers[i].max_latency;
+        }
+      }
+      if (num_started < n) {
+        goto leave;
+      }
+      printf("%-12s %10zu %14.0f %14.0f %14llu\n", phases[phase], n,
+             total_ops * 1e3 / duration_ms, total_ops * 1e3 / duration_ms / n,
+             (unsigned long long)max_latency);
+    }
+  }
+  ret = EXIT_SUCCESS;
+ leave:
+  for (i = 0; i < num_spinners; ++i) {
+    bench_spinner_stop(&spinners[i]);
+  }
+  for (i = 0; i < num_nodes; ++i) {
+    uccn_node_fini(&nodes[i]);
+  }
+  free(publishers);
+  return ret;
+}
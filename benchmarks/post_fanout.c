@@ -0,0 +1,232 @@
+// Posts raw content to trackers on loopback, first as uccn_post() used to
+// (one sendto() and clock_gettime() per peer, under the node mutex) then
+// through uccn_post(). A thread contending for the node mutex, as the
+// spinning thread does, tells how long posts held it up.
+//
+// Usage: post_fanout [num_trackers] [num_posts] [content_size]
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uccn/uccn.h"
+#include "uccn/uccn_internal.h"
+
+#include "bench_common.h"
+
+struct contender_s
+{
+  struct uccn_node_s * node;
+  pthread_t thread;
+  bool stopped;
+  uint64_t num_waits;
+  uint64_t total_wait;
+  uint64_t max_wait;
+};
+
+static void * contender_main(void * arg)
+{
+  uint64_t start, wait;
+  struct timespec delay;
+  struct contender_s * contender = arg;
+
+  TIMESPEC_MICROSECONDS_INIT(&delay, 50);
+  while (!__atomic_load_n(&contender->stopped, __ATOMIC_ACQUIRE)) {
+    start = bench_now();
+    if (pthread_mutex_lock(&contender->node->mutex) != 0) {
+      break;
+    }
+    wait = bench_now() - start;
+    pthread_mutex_unlock(&contender->node->mutex);
+    ++contender->num_waits;
+    contender->total_wait += wait;
+    if (wait > contender->max_wait) {
+      contender->max_wait = wait;
+    }
+    nanosleep(&delay, NULL);
+  }
+  return NULL;
+}
+
+static int contender_start(struct contender_s * contender, struct uccn_node_s * node)
+{
+  memset(contender, 0, sizeof(*contender));
+  contender->node = node;
+  return pthread_create(&contender->thread, NULL, contender_main, contender) == 0 ? 0 : -1;
+}
+
+static void contender_stop(struct contender_s * contender)
+{
+  __atomic_store_n(&contender->stopped, true, __ATOMIC_RELEASE);
+  pthread_join(contender->thread, NULL);
+}
+
+// What uccn_post() did before fanning out in batches
+static int post_one_by_one(struct uccn_content_provider_s * provider,
+                           const struct buffer_head_s * content,
+                           uint64_t * hold_time)
+{
+  int ret = 0;
+  size_t i, num_links, num_peers;
+  ssize_t nbytes;
+  uint64_t start;
+  struct iovec iov[2];
+  struct msghdr msg;
+  struct timespec current_time;
+  char header[UCCN_CONTENT_HEADER_SIZE];
+  struct uccn_link_s links[CONFIG_UCCN_SEND_BATCH_SIZE];
+
+  struct uccn_content_endpoint_s * endpoint = &provider->endpoint;
+  struct uccn_node_s * node = endpoint->node;
+
+  iov[0].iov_base = header;
+  iov[0].iov_len = uccn_write_content_header(header, endpoint->resource->hash,
+                                             NULL, content->length);
+  iov[1].iov_base = content->data;
+  iov[1].iov_len = content->length;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = 2;
+
+  if (pthread_mutex_lock(&node->mutex) != 0) {
+    return -1;
+  }
+  start = bench_now();
+  num_links = uccn_read_links(endpoint, 0, links, CONFIG_UCCN_SEND_BATCH_SIZE, &num_peers);
+  for (i = 0; i < num_links; ++i) {
+    msg.msg_name = &links[i].address;
+    msg.msg_namelen = sizeof(links[i].address);
+    nbytes = sendmsg(node->socket, &msg, 0);
+    if (nbytes < 0) {
+      ret = -1;
+      break;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &current_time);
+  }
+  *hold_time += bench_now() - start;
+  pthread_mutex_unlock(&node->mutex);
+  return ret;
+}
+
+static void on_content(struct uccn_content_tracker_s * tracker, void * content)
+{
+  (void)content;
+  __atomic_fetch_add((size_t *)tracker->arg, 1, __ATOMIC_RELAXED);
+}
+
+int main(int argc, char * argv[])
+{
+  int ret = EXIT_FAILURE;
+  size_t i, round;
+  uint64_t start, elapsed, hold_time;
+
+  size_t num_trackers = bench_parse_size(argc, argv, 1, CONFIG_UCCN_MAX_NUM_PEERS - 1);
+  size_t num_posts = bench_parse_size(argc, argv, 2, 100000);
+  size_t content_size = bench_parse_size(argc, argv, 3, 64);
+
+  struct uccn_node_s * nodes;
+  struct bench_spinner_s * spinners;
+  size_t num_nodes = 0, num_spinners = 0;
+  size_t num_received = 0;
+
+  struct uccn_raw_data_s resource;
+  struct uccn_content_provider_s * provider;
+  struct buffer_head_s content;
+  struct contender_s contender;
+
+  static const char * rounds[] = { "one by one", "uccn_post" };
+
+  bench_open_log(argv[0]);
+  if (num_trackers > CONFIG_UCCN_SEND_BATCH_SIZE) {
+    fprintf(stderr, "Up to %d trackers fit a send batch\n", CONFIG_UCCN_SEND_BATCH_SIZE);
+    return EXIT_FAILURE;
+  }
+  if (content_size + UCCN_CONTENT_HEADER_ROOM > CONFIG_UCCN_OUTGOING_BUFFER_SIZE) {
+    fprintf(stderr, "Up to %d bytes of content fit a packet\n",
+            CONFIG_UCCN_OUTGOING_BUFFER_SIZE - UCCN_CONTENT_HEADER_ROOM);
+    return EXIT_FAILURE;
+  }
+
+  nodes = calloc(num_trackers + 1, sizeof(*nodes));
+  spinners = calloc(num_trackers + 1, sizeof(*spinners));
+  content.data = calloc(1, content_size);
+  content.size = content.length = content_size;
+  if (nodes == NULL || spinners == NULL || content.data == NULL) {
+    perror("Failed to allocate benchmark state");
+    goto leave;
+  }
+
+  uccn_raw_data_init(&resource, "/bench/post");
+  if (bench_node_init(&nodes[0], "provider", num_trackers + 1) < 0) {
+    goto leave;
+  }
+  ++num_nodes;
+  if ((provider = uccn_advertise(&nodes[0], &resource.base)) == NULL) {
+    goto leave;
+  }
+  for (i = 1; i <= num_trackers; ++i) {
+    if (bench_node_init(&nodes[i], "tracker", num_trackers + 1) < 0) {
+      goto leave;
+    }
+    ++num_nodes;
+    if (uccn_track(&nodes[i], &resource.base, on_content, &num_received) == NULL) {
+      goto leave;
+    }
+  }
+  for (i = 0; i < num_nodes; ++i) {
+    if (bench_spinner_start(&spinners[i], &nodes[i]) < 0) {
+      goto leave;
+    }
+    ++num_spinners;
+  }
+  if (bench_wait_for_links(&provider->endpoint, num_trackers, 10000) < 0) {
+    goto leave;
+  }
+
+  printf("%zu trackers, %zu posts of %zu bytes\n", num_trackers, num_posts, content_size);
+  printf("%-12s %12s %14s %14s %14s %10s\n", "", "posts/s",
+         "hold/post ns", "mean wait ns", "max wait ns", "received");
+  for (round = 0; round < 2; ++round) {
+    hold_time = 0;
+    __atomic_store_n(&num_received, 0, __ATOMIC_RELAXED);
+    if (contender_start(&contender, &nodes[0]) < 0) {
+      goto leave;
+    }
+    start = bench_now();
+    for (i = 0; i < num_posts; ++i) {
+      if (round == 0) {
+        ret = post_one_by_one(provider, &content, &hold_time);
+      } else {
+        ret = uccn_post(provider, &content);
+      }
+      if (ret < 0) {
+        break;
+      }
+    }
+    elapsed = bench_now() - start;
+    contender_stop(&contender);
+    if (ret < 0) {
+      fprintf(stderr, "Failed to post content (%s)\n", strerror(errno));
+      ret = EXIT_FAILURE;
+      goto leave;
+    }
+    printf("%-12s %12.0f %14.0f %14.0f %14llu %10zu\n", rounds[round],
+           num_posts * 1e9 / elapsed, (double)hold_time / num_posts,
+           contender.num_waits > 0 ? (double)contender.total_wait / contender.num_waits : 0.,
+           (unsigned long long)contender.max_wait,
+           __atomic_load_n(&num_received, __ATOMIC_RELAXED));
+  }
+  ret = EXIT_SUCCESS;
+ leave:
+  for (i = 0; i < num_spinners; ++i) {
+    bench_spinner_stop(&spinners[i]);
+  }
+  for (i = 0; i < num_nodes; ++i) {
+    uccn_node_fini(&nodes[i]);
+  }
+  free(content.data);
+  free(spinners);
+  free(nodes);
+  return ret;
+}
@@ -0,0 +1,97 @@
+// Looks resources up by hash, as content dispatch does, through a hash
+// index and through a linear scan over endpoints (as done before indices)
+// for increasing resource counts.
+//
+// Usage: resource_lookup [max_num_resources] [num_lookups]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "uccn/uccn.h"
+
+#include "bench_common.h"
+
+static struct uccn_raw_data_s * linear_find(struct uccn_raw_data_s * resources,
+                                            size_t num_resources, uint32_t hash)
+{
+  size_t i;
+  for (i = 0; i < num_resources; ++i) {
+    if (resources[i].base.hash == hash) {
+      return &resources[i];
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char * argv[])
+{
+  int ret = EXIT_FAILURE;
+  char path[CONFIG_UCCN_MAX_RESOURCE_PATH_SIZE];
+  size_t i, n, capacity;
+  uint64_t start, indexed_time, linear_time;
+  uint32_t * lookups = NULL;
+  uintptr_t checksum = 0;
+
+  size_t max_num_resources = bench_parse_size(argc, argv, 1, 1024);
+  size_t num_lookups = bench_parse_size(argc, argv, 2, 1000000);
+
+  struct uccn_raw_data_s * resources = NULL;
+  struct hash_index_entry_s * entries = NULL;
+  struct hash_index_s index;
+
+  resources = calloc(max_num_resources, sizeof(*resources));
+  entries = calloc(hash_index_capacity(max_num_resources), sizeof(*entries));
+  lookups = calloc(num_lookups, sizeof(*lookups));
+  if (resources == NULL || entries == NULL || lookups == NULL) {
+    perror("Failed to allocate benchmark state");
+    goto leave;
+  }
+  for (i = 0; i < max_num_resources; ++i) {
+    snprintf(path, sizeof(path), "/bench/resource/%zu", i);
+    uccn_raw_data_init(&resources[i], path);
+  }
+
+  printf("%10s %14s %14s\n", "resources", "indexed ns", "linear ns");
+  for (n = 1; n <= max_num_resources; n *= 2) {
+    capacity = hash_index_capacity(n);
+    hash_index_init(&index, entries, capacity);
+    for (i = 0; i < n; ++i) {
+      if (hash_index_insert(&index, resources[i].base.hash, &resources[i]) < 0) {
+        fprintf(stderr, "Failed to index '%s'\n", resources[i].base.path);
+        goto leave;
+      }
+    }
+    // Hit resources at random, as content for any of them may come in
+    srand(n);
+    for (i = 0; i < num_lookups; ++i) {
+      lookups[i] = resources[rand() % n].base.hash;
+    }
+
+    start = bench_now();
+    for (i = 0; i < num_lookups; ++i) {
+      checksum += (uintptr_t)hash_index_find(&index, lookups[i]);
+    }
+    indexed_time = bench_now() - start;
+
+    start = bench_now();
+    for (i = 0; i < num_lookups; ++i) {
+      checksum -= (uintptr_t)linear_find(resources, n, lookups[i]);
+    }
+    linear_time = bench_now() - start;
+
+    printf("%10zu %14.2f %14.2f\n", n,
+           (double)indexed_time / num_lookups,
+           (double)linear_time / num_lookups);
+  }
+  // Both found the same, and lookups were not optimized away
+  if (checksum != 0) {
+    fprintf(stderr, "Indexed and linear lookups disagree\n");
+    goto leave;
+  }
+  ret = EXIT_SUCCESS;
+ leave:
+  free(lookups);
+  free(entries);
+  free(resources);
+  return ret;
+}
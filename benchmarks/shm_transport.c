@@ -0,0 +1,220 @@
+// Posts content to a tracker on the same host through a shared memory
+// ring, then over UDP once the ring is taken away, telling one way latency
+// (one post in flight at a time) and throughput (posts back to back) for
+// each. Builds without shared memory rings only measure UDP.
+//
+// Usage: shm_transport [num_posts] [content_size]
+
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uccn/uccn.h"
+#include "uccn/uccn_internal.h"
+
+#include "bench_common.h"
+
+struct tracker_state_s
+{
+  size_t num_received;
+  uint64_t total_latency;
+  uint64_t max_latency;
+};
+
+static void on_content(struct uccn_content_tracker_s * tracker, void * content)
+{
+  uint64_t stamp, latency;
+  struct buffer_head_s * blob = content;
+  struct tracker_state_s * state = tracker->arg;
+
+  memcpy(&stamp, blob->data, sizeof(stamp));
+  latency = bench_now() - stamp;
+  state->total_latency += latency;
+  if (latency > state->max_latency) {
+    state->max_latency = latency;
+  }
+  __atomic_add_fetch(&state->num_received, 1, __ATOMIC_RELEASE);
+}
+
+#if CONFIG_UCCN_SHM_TRANSPORT
+static bool has_ring(struct uccn_content_provider_s * provider)
+{
+  bool found = false;
+  struct uccn_node_s * node = provider->endpoint.node;
+
+  pthread_mutex_lock(&node->mutex);
+  found = provider->endpoint.num_peers > 0 && provider->endpoint.peers[0].channel != NULL;
+  pthread_mutex_unlock(&node->mutex);
+  return found;
+}
+
+// Takes provider links off their rings, for content to go over UDP
+static void detach_rings(struct uccn_content_provider_s * provider)
+{
+  size_t i;
+  struct uccn_shm_channel_s * channel;
+  struct uccn_content_endpoint_s * endpoint = &provider->endpoint;
+
+  pthread_mutex_lock(&endpoint->node->mutex);
+  for (i = 0; i < endpoint->num_peers; ++i) {
+    if ((channel = endpoint->peers[i].channel) != NULL) {
+      uccn_begin_links_update(endpoint);
+      endpoint->peers[i].channel = NULL;
+      uccn_end_links_update(endpoint);
+      uccn_close_shm_channel(endpoint->node, channel);
+    }
+  }
+  pthread_mutex_unlock(&endpoint->node->mutex);
+}
+#endif
+
+// Waits a while for the tracker to get as much content
+static size_t wait_for_content(struct tracker_state_s * state, size_t num_expected,
+                               unsigned int timeout_ms)
+{
+  size_t num_received;
+  uint64_t deadline = bench_now() + timeout_ms * 1000000ULL;
+
+  while ((num_received = __atomic_load_n(&state->num_received, __ATOMIC_ACQUIRE)) < num_expected &&
+         bench_now() < deadline) {
+    sched_yield();
+  }
+  return num_received;
+}
+
+static int run(const char * name, struct uccn_content_provider_s * provider,
+               struct tracker_state_s * state, struct buffer_head_s * content,
+               size_t num_posts)
+{
+  size_t i, num_latency_samples, num_received;
+  uint64_t start, elapsed, stamp;
+
+  // One at a time, for latency
+  memset(state, 0, sizeof(*state));
+  num_latency_samples = num_posts < 10000 ? num_posts : 10000;
+  for (i = 0; i < num_latency_samples; ++i) {
+    stamp = bench_now();
+    memcpy(content->data, &stamp, sizeof(stamp));
+    if (uccn_post(provider, content) < 0) {
+      fprintf(stderr, "Failed to post content (%s)\n", strerror(errno));
+      return -1;
+    }
+    if (wait_for_content(state, i + 1, 1000) <= i) {
+      fprintf(stderr, "Content got lost on the way\n");
+      return -1;
+    }
+  }
+  printf("%-6s %12.0f %12llu", name, (double)state->total_latency / num_latency_samples,
+         (unsigned long long)state->max_latency);
+
+  // Back to back, for throughput
+  memset(state, 0, sizeof(*state));
+  start = bench_now();
+  for (i = 0; i < num_posts; ++i) {
+    stamp = bench_now();
+    memcpy(content->data, &stamp, sizeof(stamp));
+    if (uccn_post(provider, content) < 0) {
+      fprintf(stderr, "Failed to post content (%s)\n", strerror(errno));
+      return -1;
+    }
+  }
+  num_received = wait_for_content(state, num_posts, 1000);
+  elapsed = bench_now() - start;
+  printf(" %12.0f %12.0f %9.1f%%\n", num_posts * 1e9 / elapsed,
+         num_received * 1e9 / elapsed, 100. * num_received / num_posts);
+  return 0;
+}
+
+int main(int argc, char * argv[])
+{
+  int ret = EXIT_FAILURE;
+  size_t i, num_nodes = 0, num_spinners = 0;
+  uint64_t deadline;
+
+  size_t num_posts = bench_parse_size(argc, argv, 1, 100000);
+  size_t content_size = bench_parse_size(argc, argv, 2, 64);
+
+  struct uccn_node_s nodes[2];
+  struct bench_spinner_s spinners[2];
+  struct uccn_raw_data_s resource;
+  struct uccn_content_provider_s * provider;
+  struct tracker_state_s state;
+  struct buffer_head_s content;
+
+  bench_open_log(argv[0]);
+  if (content_size < sizeof(uint64_t) ||
+      content_size + UCCN_CONTENT_HEADER_ROOM > CONFIG_UCCN_OUTGOING_BUFFER_SIZE) {
+    fprintf(stderr, "From %zu up to %d bytes of content fit a packet\n", sizeof(uint64_t),
+            CONFIG_UCCN_OUTGOING_BUFFER_SIZE - UCCN_CONTENT_HEADER_ROOM);
+    return EXIT_FAILURE;
+  }
+  content.data = calloc(1, content_size);
+  content.size = content.length = content_size;
+  if (content.data == NULL) {
+    perror("Failed to allocate content");
+    return EXIT_FAILURE;
+  }
+
+  uccn_raw_data_init(&resource, "/bench/shm");
+  memset(&state, 0, sizeof(state));
+  if (bench_node_init(&nodes[0], "provider", 0) < 0) {
+    goto leave;
+  }
+  ++num_nodes;
+  if ((provider = uccn_advertise(&nodes[0], &resource.base)) == NULL) {
+    goto leave;
+  }
+  if (bench_node_init(&nodes[1], "tracker", 0) < 0) {
+    goto leave;
+  }
+  ++num_nodes;
+  if (uccn_track(&nodes[1], &resource.base, on_content, &state) == NULL) {
+    goto leave;
+  }
+  for (i = 0; i < num_nodes; ++i) {
+    if (bench_spinner_start(&spinners[i], &nodes[i]) < 0) {
+      goto leave;
+    }
+    ++num_spinners;
+  }
+  if (bench_wait_for_links(&provider->endpoint, 1, 10000) < 0) {
+    goto leave;
+  }
+
+  printf("%zu posts of %zu bytes\n", num_posts, content_size);
+  printf("%-6s %12s %12s %12s %12s %10s\n", "", "mean lat ns", "max lat ns",
+         "posts/s", "received/s", "received");
+#if CONFIG_UCCN_SHM_TRANSPORT
+  // Rings are offered once the tracker hears back from the provider
+  deadline = bench_now() + 2000000000ULL;
+  while (!has_ring(provider) && bench_now() < deadline) {
+    sched_yield();
+  }
+  if (!has_ring(provider)) {
+    fprintf(stderr, "No ring was set up between nodes\n");
+    goto leave;
+  }
+  if (run("shm", provider, &state, &content, num_posts) < 0) {
+    goto leave;
+  }
+  detach_rings(provider);
+#else
+  (void)deadline;
+  printf("(built without shared memory rings)\n");
+#endif
+  if (run("udp", provider, &state, &content, num_posts) < 0) {
+    goto leave;
+  }
+  ret = EXIT_SUCCESS;
+ leave:
+  for (i = 0; i < num_spinners; ++i) {
+    bench_spinner_stop(&spinners[i]);
+  }
+  for (i = 0; i < num_nodes; ++i) {
+    uccn_node_fini(&nodes[i]);
+  }
+  free(content.data);
+  return ret;
+}
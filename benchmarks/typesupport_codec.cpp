@@ -0,0 +1,168 @@
+// Serializes and deserializes a record through typesupport generated by
+// uccn/typesupport.hpp and through a hand-written codec that packs the
+// same bytes, calling both through their typesupport as records are.
+//
+// Usage: typesupport_codec [num_records]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "uccn/typesupport.hpp"
+
+#include "bench_common.h"
+
+namespace {
+
+struct reading
+{
+  uint32_t sensor;
+  int64_t stamp;
+  bool valid;
+  double values[8];
+  char label[32];
+};
+
+ssize_t reading_serialize(const uccn_record_typesupport_s * ts,
+                          const void * content, buffer_head_s * blob)
+{
+  size_t i;
+  mpack_writer_t writer;
+  const reading * record = static_cast<const reading *>(content);
+  (void)ts;
+  mpack_writer_init(&writer, static_cast<char *>(blob->data), blob->size);
+  mpack_write_u32(&writer, record->sensor);
+  mpack_write_i64(&writer, record->stamp);
+  mpack_write_bool(&writer, record->valid);
+  mpack_start_array(&writer, 8);
+  for (i = 0; i < 8; ++i) {
+    mpack_write_double(&writer, record->values[i]);
+  }
+  mpack_finish_array(&writer);
+  mpack_write_str(&writer, record->label, strnlen(record->label, sizeof(record->label) - 1));
+  blob->length = mpack_writer_buffer_used(&writer);
+  if (mpack_writer_destroy(&writer) != mpack_ok) {
+    return -1;
+  }
+  return blob->length;
+}
+
+ssize_t reading_deserialize(const uccn_record_typesupport_s * ts,
+                            const buffer_head_s * blob, void * content)
+{
+  size_t i;
+  mpack_reader_t reader;
+  reading * record = static_cast<reading *>(content);
+  (void)ts;
+  mpack_reader_init_data(&reader, static_cast<const char *>(blob->data), blob->length);
+  record->sensor = mpack_expect_u32(&reader);
+  record->stamp = mpack_expect_i64(&reader);
+  record->valid = mpack_expect_bool(&reader);
+  mpack_expect_array_match(&reader, 8);
+  for (i = 0; i < 8; ++i) {
+    record->values[i] = mpack_expect_double(&reader);
+  }
+  mpack_done_array(&reader);
+  mpack_expect_cstr(&reader, record->label, sizeof(record->label));
+  if (mpack_reader_destroy(&reader) != mpack_ok) {
+    return -1;
+  }
+  return blob->length;
+}
+
+uccn_record_typesupport_s g_handwritten_typesupport = {
+  sizeof(reading), reading_serialize, reading_deserialize, 0
+};
+
+using generated = uccn::mpack_typesupport<reading,
+                                          UCCN_FIELD(reading, sensor),
+                                          UCCN_FIELD(reading, stamp),
+                                          UCCN_FIELD(reading, valid),
+                                          UCCN_FIELD(reading, values),
+                                          UCCN_FIELD(reading, label)>;
+
+struct result
+{
+  double serialize_ns;
+  double deserialize_ns;
+  size_t length;
+};
+
+int measure(const uccn_record_typesupport_s * ts, const reading & record,
+            size_t num_records, char * buffer, size_t buffer_size, result * out)
+{
+  size_t i;
+  uint64_t start;
+  reading copy;
+  buffer_head_s blob;
+
+  blob.data = buffer;
+  blob.size = buffer_size;
+  start = bench_now();
+  for (i = 0; i < num_records; ++i) {
+    if (ts->serialize(ts, &record, &blob) < 0) {
+      return -1;
+    }
+  }
+  out->serialize_ns = (double)(bench_now() - start) / num_records;
+  out->length = blob.length;
+
+  start = bench_now();
+  for (i = 0; i < num_records; ++i) {
+    if (ts->deserialize(ts, &blob, &copy) < 0) {
+      return -1;
+    }
+  }
+  out->deserialize_ns = (double)(bench_now() - start) / num_records;
+  if (copy.sensor != record.sensor || copy.stamp != record.stamp ||
+      memcmp(copy.values, record.values, sizeof(copy.values)) != 0 ||
+      strcmp(copy.label, record.label) != 0) {
+    return -1;
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char * argv[])
+{
+  size_t i;
+  reading record;
+  result results[2];
+  char buffers[2][generated::max_size];
+  const uccn_record_typesupport_s * typesupports[2] = {
+    &g_handwritten_typesupport, generated::get()
+  };
+  static const char * names[] = { "hand-written", "typesupport.hpp" };
+
+  size_t num_records = bench_parse_size(argc, argv, 1, 1000000);
+
+  bench_open_log(argv[0]);
+  memset(&record, 0, sizeof(record));
+  record.sensor = 42;
+  record.stamp = 1700000000123456789LL;
+  record.valid = true;
+  for (i = 0; i < 8; ++i) {
+    record.values[i] = 0.5 * i - 1.25;
+  }
+  strcpy(record.label, "front left wheel");
+
+  printf("%zu records, up to %zu bytes packed\n", num_records, generated::max_size);
+  printf("%-16s %16s %16s %8s\n", "", "serialize ns", "deserialize ns", "bytes");
+  for (i = 0; i < 2; ++i) {
+    if (measure(typesupports[i], record, num_records,
+                buffers[i], sizeof(buffers[i]), &results[i]) < 0) {
+      fprintf(stderr, "Failed to round trip records through %s codec\n", names[i]);
+      return EXIT_FAILURE;
+    }
+    printf("%-16s %16.1f %16.1f %8zu\n", names[i], results[i].serialize_ns,
+           results[i].deserialize_ns, results[i].length);
+  }
+  // Both pack the very same bytes, for C and C++ nodes to talk
+  if (results[0].length != results[1].length ||
+      memcmp(buffers[0], buffers[1], results[0].length) != 0) {
+    fprintf(stderr, "Codecs pack different bytes\n");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
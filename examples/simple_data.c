@@ -3,12 +3,6 @@
 #include "uccn/uccn.h"
 #include "mpack/mpack.h"
 
-static void * simple_data_allocate(const struct uccn_record_typesupport_s * ts) {
-  static struct examples_simple_data_s buffer;
-  (void)ts;
-  return &buffer;
-}
-
 static ssize_t simple_data_serialize(const struct uccn_record_typesupport_s * ts,
                                      const struct examples_simple_data_s * content,
                                      struct buffer_head_s * blob) {
@@ -39,7 +33,7 @@ static ssize_t simple_data_deserialize(const struct uccn_record_typesupport_s *
 }
 
 static struct uccn_record_typesupport_s g_simple_data_typesupport = {
-  .allocate = (uccn_record_allocate_fn)simple_data_allocate,
+  .size = sizeof(struct examples_simple_data_s),
   .serialize = (uccn_record_serialize_fn)simple_data_serialize,
   .deserialize = (uccn_record_deserialize_fn)simple_data_deserialize
 };
@@ -41,7 +41,12 @@ int main(int argc, char * argv[]) {
   inet_aton("127.0.0.1", &network.inetaddr);
   inet_aton("255.0.0.0", &network.netmask);
 
+#if CONFIG_UCCN_DYNAMIC_CAPACITY
+  struct uccn_node_capacity_s capacity = UCCN_NODE_CAPACITY_DEFAULT;
+  if (uccn_node_init(&node, &network, "provider", &capacity, NULL, 0) != 0) {
+#else
   if (uccn_node_init(&node, &network, "provider") != 0) {
+#endif
     perror("Failed to initialize 'provider' node.\n");
     return -1;
   }
@@ -11,6 +11,10 @@ extern "C"
 
 uint32_t crc32(const uint8_t * buffer, size_t size);
 
+// Carries on a checksum over more data, such that chaining updates over
+// consecutive chunks starting from 0 matches crc32() over all of them.
+uint32_t crc32_update(uint32_t checksum, const uint8_t * buffer, size_t size);
+
 #if defined(__cplusplus)
 }
 #endif
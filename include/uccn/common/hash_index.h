@@ -0,0 +1,103 @@
+#ifndef UCCN_COMMON_HASH_INDEX_H_
+#define UCCN_COMMON_HASH_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed capacity, open addressing (linear probing) index from non-zero
+// 32 bit hashes to opaque values. Storage is provided by the caller.
+
+struct hash_index_entry_s
+{
+  uint32_t key;
+  void * value;
+};
+
+struct hash_index_s
+{
+  struct hash_index_entry_s * entries;
+  size_t mask;
+  size_t count;
+};
+
+#define HASH_INDEX_SMEAR1_(x) ((x) | ((x) >> 1))
+#define HASH_INDEX_SMEAR2_(x) (HASH_INDEX_SMEAR1_(x) | (HASH_INDEX_SMEAR1_(x) >> 2))
+#define HASH_INDEX_SMEAR4_(x) (HASH_INDEX_SMEAR2_(x) | (HASH_INDEX_SMEAR2_(x) >> 4))
+#define HASH_INDEX_SMEAR8_(x) (HASH_INDEX_SMEAR4_(x) | (HASH_INDEX_SMEAR4_(x) >> 8))
+#define HASH_INDEX_SMEAR16_(x) (HASH_INDEX_SMEAR8_(x) | (HASH_INDEX_SMEAR8_(x) >> 16))
+
+// Smallest power of two capacity keeping the load factor at or below 1/2
+#define HASH_INDEX_CAPACITY(n) (HASH_INDEX_SMEAR16_(2 * (n) - 1) + 1)
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+// Runtime counterpart of HASH_INDEX_CAPACITY()
+static inline size_t hash_index_capacity(size_t n) {
+  size_t capacity = 1;
+  while (capacity < 2 * n) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+static inline void hash_index_init(struct hash_index_s * index,
+                                   struct hash_index_entry_s * entries,
+                                   size_t capacity) {
+  size_t i;
+  // capacity must be a power of two
+  index->entries = entries;
+  index->mask = capacity - 1;
+  index->count = 0;
+  for (i = 0; i < capacity; ++i) {
+    entries[i].key = 0;
+    entries[i].value = NULL;
+  }
+}
+
+static inline size_t hash_index_slot(const struct hash_index_s * index, uint32_t key) {
+  // Keys are expected to be well mixed already (e.g. CRC32s)
+  return (size_t)(key ^ (key >> 16)) & index->mask;
+}
+
+static inline void * hash_index_find(const struct hash_index_s * index, uint32_t key) {
+  size_t i = hash_index_slot(index, key);
+  while (index->entries[i].key != 0) {
+    if (index->entries[i].key == key) {
+      return index->entries[i].value;
+    }
+    i = (i + 1) & index->mask;
+  }
+  return NULL;
+}
+
+static inline int hash_index_insert(struct hash_index_s * index, uint32_t key, void * value) {
+  size_t i;
+  if (key == 0) {
+    return -1;
+  }
+  i = hash_index_slot(index, key);
+  while (index->entries[i].key != 0) {
+    if (index->entries[i].key == key) {
+      index->entries[i].value = value;
+      return 0;
+    }
+    i = (i + 1) & index->mask;
+  }
+  // Keep probes ending on an empty slot
+  if (2 * (index->count + 1) > index->mask + 1) {
+    return -1;
+  }
+  index->entries[i].key = key;
+  index->entries[i].value = value;
+  ++index->count;
+  return 1;
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // UCCN_COMMON_HASH_INDEX_H_
@@ -13,10 +13,20 @@
 #define CONFIG_UCCN_MAX_RESOURCE_PATH_SIZE 64
 #endif
 
+// Size peers, trackers and providers at node initialization rather than
+// at build time. Maximum counts below then become the default capacity.
+#ifndef CONFIG_UCCN_DYNAMIC_CAPACITY
+#define CONFIG_UCCN_DYNAMIC_CAPACITY 0
+#endif
+
 #ifndef CONFIG_UCCN_MAX_NUM_PEERS
 #define CONFIG_UCCN_MAX_NUM_PEERS 5
 #endif
 
+#if CONFIG_UCCN_MAX_NUM_PEERS >= 65535
+#error "uCCN peer handles cannot address that many peers"
+#endif
+
 #ifndef CONFIG_UCCN_MAX_NUM_RESOURCES
 #define CONFIG_UCCN_MAX_NUM_RESOURCES 10
 #endif
@@ -41,11 +51,112 @@
 #define CONFIG_UCCN_MAX_CONTENT_SIZE 256
 #endif
 
+// Unpacked content objects each tracker can have out on loan at once
+#ifndef CONFIG_UCCN_CONTENT_POOL_SIZE
+#define CONFIG_UCCN_CONTENT_POOL_SIZE 4
+#endif
+
+#if CONFIG_UCCN_CONTENT_POOL_SIZE < 1 || CONFIG_UCCN_CONTENT_POOL_SIZE > 32
+#error "uCCN content pools must hold between 1 and 32 objects"
+#endif
+
+// Checksum content end to end (CRC32 of each blob or fragment) for peers
+// that agree to it, dropping and counting content that does not match.
+// Agreement goes as a reserved hash in link arrays, which nodes that
+// predate checksums find no endpoint for and skip, so content to and from
+// them just goes unchecked.
+#ifndef CONFIG_UCCN_CONTENT_CHECKSUMS
+#define CONFIG_UCCN_CONTENT_CHECKSUMS 0
+#endif
+
+// Send discovery to a multicast group rather than to the subnet broadcast
+// address, so that hosts without nodes filter it out before it reaches
+// them, and so that it can be routed. Broadcast discovery from other nodes
+// is still answered.
+#ifndef CONFIG_UCCN_MULTICAST_DISCOVERY
+#define CONFIG_UCCN_MULTICAST_DISCOVERY 0
+#endif
+
+#if CONFIG_UCCN_MULTICAST_DISCOVERY
+
+// In host byte order (239.254.0.1 by default)
+#ifndef CONFIG_UCCN_DISCOVERY_GROUP
+#define CONFIG_UCCN_DISCOVERY_GROUP 0xEFFE0001
+#endif
+
+#if (CONFIG_UCCN_DISCOVERY_GROUP >> 28) != 0xE
+#error "uCCN discovery group must be a multicast address"
+#endif
+
+// Hops discovery may take, one keeps it in the local network
+#ifndef CONFIG_UCCN_DISCOVERY_TTL
+#define CONFIG_UCCN_DISCOVERY_TTL 1
+#endif
+
+#endif
+
+// Send content once to a multicast group per resource, rather than once
+// per tracker, to peers that agree to it. Trackers join the groups of what
+// they track on the discovery port. Like checksums, agreement goes as a
+// reserved hash in link arrays that older nodes skip, and content goes to
+// them once per tracker as before.
+#ifndef CONFIG_UCCN_MULTICAST_CONTENT
+#define CONFIG_UCCN_MULTICAST_CONTENT 0
+#endif
+
+#if CONFIG_UCCN_MULTICAST_CONTENT
+
+// Resource groups take the low bits of resource hashes under this prefix,
+// in host byte order (239.255.0.0/16 by default, i.e. organization local)
+#ifndef CONFIG_UCCN_CONTENT_GROUP_PREFIX
+#define CONFIG_UCCN_CONTENT_GROUP_PREFIX 0xEFFF0000
+#endif
+
+#ifndef CONFIG_UCCN_CONTENT_GROUP_BITS
+#define CONFIG_UCCN_CONTENT_GROUP_BITS 16
+#endif
+
+#if CONFIG_UCCN_CONTENT_GROUP_BITS < 1 || CONFIG_UCCN_CONTENT_GROUP_BITS > 28
+#error "uCCN content groups must take between 1 and 28 bits of a multicast address"
+#endif
+
+// Hops content sent to groups may take, one keeps it in the local network
+#ifndef CONFIG_UCCN_CONTENT_GROUP_TTL
+#if CONFIG_UCCN_MULTICAST_DISCOVERY
+#define CONFIG_UCCN_CONTENT_GROUP_TTL CONFIG_UCCN_DISCOVERY_TTL
+#else
+#define CONFIG_UCCN_CONTENT_GROUP_TTL 1
+#endif
+#endif
+
+#if CONFIG_UCCN_MULTICAST_DISCOVERY
+// Both go out the same socket
+#if CONFIG_UCCN_CONTENT_GROUP_TTL != CONFIG_UCCN_DISCOVERY_TTL
+#error "uCCN content groups and discovery must share a TTL"
+#endif
+#if (CONFIG_UCCN_DISCOVERY_GROUP >> CONFIG_UCCN_CONTENT_GROUP_BITS) == \
+    (CONFIG_UCCN_CONTENT_GROUP_PREFIX >> CONFIG_UCCN_CONTENT_GROUP_BITS)
+#error "uCCN discovery group cannot be among content groups"
+#endif
+#endif
+
+#endif
+
+// Split content that does not fit a single packet into fragments, and
+// reassemble it on reception
+#ifndef CONFIG_UCCN_FRAGMENTATION
+#if defined(__linux__)
+#define CONFIG_UCCN_FRAGMENTATION 1
+#else
+#define CONFIG_UCCN_FRAGMENTATION 0
+#endif
+#endif
+
 #ifndef CONFIG_UCCN_INCOMING_BUFFER_SIZE
 #define CONFIG_UCCN_INCOMING_BUFFER_SIZE 512
 #endif
 
-#if CONFIG_UCCN_MAX_CONTENT_SIZE > CONFIG_UCCN_INCOMING_BUFFER_SIZE
+#if !CONFIG_UCCN_FRAGMENTATION && CONFIG_UCCN_MAX_CONTENT_SIZE > CONFIG_UCCN_INCOMING_BUFFER_SIZE
 #error "uCCN incoming buffer cannot be smaller than the maximum content size"
 #endif
 
@@ -53,10 +164,50 @@
 #define CONFIG_UCCN_OUTGOING_BUFFER_SIZE 512
 #endif
 
-#if CONFIG_UCCN_MAX_CONTENT_SIZE > CONFIG_UCCN_OUTGOING_BUFFER_SIZE
+#if !CONFIG_UCCN_FRAGMENTATION && CONFIG_UCCN_MAX_CONTENT_SIZE > CONFIG_UCCN_OUTGOING_BUFFER_SIZE
 #error "uCCN outgoing buffer cannot be smaller than the maximum content size"
 #endif
 
+#if CONFIG_UCCN_FRAGMENTATION
+
+// Leaves room for packet and fragment headers in the outgoing buffer
+#ifndef CONFIG_UCCN_MAX_FRAGMENT_SIZE
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+#define CONFIG_UCCN_MAX_FRAGMENT_SIZE (CONFIG_UCCN_OUTGOING_BUFFER_SIZE - 40)
+#else
+#define CONFIG_UCCN_MAX_FRAGMENT_SIZE (CONFIG_UCCN_OUTGOING_BUFFER_SIZE - 32)
+#endif
+#endif
+
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+#if CONFIG_UCCN_MAX_FRAGMENT_SIZE + 40 > CONFIG_UCCN_OUTGOING_BUFFER_SIZE
+#error "uCCN fragments must fit in the outgoing buffer, checksum included"
+#endif
+#elif CONFIG_UCCN_MAX_FRAGMENT_SIZE + 32 > CONFIG_UCCN_OUTGOING_BUFFER_SIZE
+#error "uCCN fragments must fit in the outgoing buffer"
+#endif
+
+// Socket receive buffer to ask for, so that bursts of fragments are not
+// dropped. Zero keeps the system default, which is bounded by the system
+// maximum (e.g. net.core.rmem_max on Linux) regardless.
+#ifndef CONFIG_UCCN_SOCKET_RECV_BUFFER_SIZE
+#define CONFIG_UCCN_SOCKET_RECV_BUFFER_SIZE 0
+#endif
+
+#ifndef CONFIG_UCCN_MAX_NUM_REASSEMBLIES
+#define CONFIG_UCCN_MAX_NUM_REASSEMBLIES 4
+#endif
+
+#ifndef CONFIG_UCCN_MAX_REASSEMBLY_SIZE
+#define CONFIG_UCCN_MAX_REASSEMBLY_SIZE (8 * 1024 * 1024)
+#endif
+
+#ifndef CONFIG_UCCN_REASSEMBLY_TIMEOUT_MS
+#define CONFIG_UCCN_REASSEMBLY_TIMEOUT_MS 1000
+#endif
+
+#endif
+
 #ifndef CONFIG_UCCN_LIVELINESS_TIMEOUT_MS
 #define CONFIG_UCCN_LIVELINESS_TIMEOUT_MS 2000
 #endif
@@ -73,18 +224,193 @@
 #define CONFIG_UCCN_PEER_DISCOVERY_PERIOD_MS 1000
 #endif
 
-#ifndef CONFIG_UCCN_ENDPOINT_PROBE_TIMEOUT_MS
-#define CONFIG_UCCN_ENDPOINT_PROBE_TIMEOUT_MS 500
+// Discovery backs off exponentially from the period above, while trackers
+// remain unmatched, up to this period
+#ifndef CONFIG_UCCN_MAX_PEER_DISCOVERY_PERIOD_MS
+#define CONFIG_UCCN_MAX_PEER_DISCOVERY_PERIOD_MS 16000
+#endif
+
+#if CONFIG_UCCN_MAX_PEER_DISCOVERY_PERIOD_MS < CONFIG_UCCN_PEER_DISCOVERY_PERIOD_MS
+#error "uCCN max peer discovery period cannot be shorter than the initial one"
+#endif
+
+// Discovery periods are shortened by a random amount up to this
+// percentage, so that nodes started together drift apart
+#ifndef CONFIG_UCCN_PEER_DISCOVERY_JITTER_PERCENT
+#define CONFIG_UCCN_PEER_DISCOVERY_JITTER_PERCENT 25
+#endif
+
+#if CONFIG_UCCN_PEER_DISCOVERY_JITTER_PERCENT < 0 || \
+    CONFIG_UCCN_PEER_DISCOVERY_JITTER_PERCENT >= 100
+#error "uCCN peer discovery jitter must be a percentage below 100"
 #endif
 
-#if CONFIG_UCCN_ENDPOINT_PROBE_TIMEOUT_MS >= CONFIG_UCCN_PEER_DISCOVERY_PERIOD_MS
-#error "uCCN must probe for endpoint state faster than it discovers peers"
+// Discovery packets that follow the first one in quick succession, on
+// startup and whenever a tracker is added, before backing off
+#ifndef CONFIG_UCCN_PEER_DISCOVERY_BURST
+#define CONFIG_UCCN_PEER_DISCOVERY_BURST 3
+#endif
+
+#ifndef CONFIG_UCCN_PEER_DISCOVERY_BURST_PERIOD_MS
+#define CONFIG_UCCN_PEER_DISCOVERY_BURST_PERIOD_MS 100
+#endif
+
+#if CONFIG_UCCN_PEER_DISCOVERY_BURST_PERIOD_MS > CONFIG_UCCN_PEER_DISCOVERY_PERIOD_MS
+#error "uCCN peer discovery bursts cannot be slower than discovery itself"
+#endif
+
+// Granularity of peer liveliness and discovery timers, which go off up
+// to this late. Peers are unlinked as soon as they time out.
+#ifndef CONFIG_UCCN_TIMER_RESOLUTION_MS
+#define CONFIG_UCCN_TIMER_RESOLUTION_MS 1
+#endif
+
+#if CONFIG_UCCN_TIMER_RESOLUTION_MS < 1 || \
+    CONFIG_UCCN_TIMER_RESOLUTION_MS > CONFIG_UCCN_PEER_DISCOVERY_BURST_PERIOD_MS
+#error "uCCN timers cannot be coarser than peer discovery bursts"
 #endif
 
 #ifndef CONFIG_UCCN_MULTITHREADED
 #define CONFIG_UCCN_MULTITHREADED 1
 #endif
 
+#ifndef CONFIG_UCCN_BATCHED_IO
+#if defined(__linux__)
+#define CONFIG_UCCN_BATCHED_IO 1
+#else
+#define CONFIG_UCCN_BATCHED_IO 0
+#endif
+#endif
+
+#ifndef CONFIG_UCCN_RECV_BATCH_SIZE
+#if CONFIG_UCCN_BATCHED_IO
+#define CONFIG_UCCN_RECV_BATCH_SIZE 8
+#else
+#define CONFIG_UCCN_RECV_BATCH_SIZE 1
+#endif
+#endif
+
+#if CONFIG_UCCN_RECV_BATCH_SIZE < 1
+#error "uCCN must be able to receive at least one packet at a time"
+#endif
+
+#ifndef CONFIG_UCCN_EPOLL
+#if defined(__linux__)
+#define CONFIG_UCCN_EPOLL 1
+#else
+#define CONFIG_UCCN_EPOLL 0
+#endif
+#endif
+
+#ifndef CONFIG_UCCN_MAX_NUM_WATCHES
+#define CONFIG_UCCN_MAX_NUM_WATCHES 4
+#endif
+
+#ifndef CONFIG_UCCN_SEND_BATCH_SIZE
+#define CONFIG_UCCN_SEND_BATCH_SIZE CONFIG_UCCN_MAX_NUM_PEERS
+#endif
+
+#if CONFIG_UCCN_SEND_BATCH_SIZE < 1
+#error "uCCN must be able to send at least one packet at a time"
+#endif
+
+// Number of posts that can build and send packets concurrently
+#ifndef CONFIG_UCCN_NUM_POST_BUFFERS
+#if CONFIG_UCCN_MULTITHREADED
+#define CONFIG_UCCN_NUM_POST_BUFFERS 4
+#else
+#define CONFIG_UCCN_NUM_POST_BUFFERS 1
+#endif
+#endif
+
+#if CONFIG_UCCN_NUM_POST_BUFFERS < 1 || CONFIG_UCCN_NUM_POST_BUFFERS > 32
+#error "uCCN post buffers must be between 1 and 32"
+#endif
+
+// Number of buffers that publishers can borrow to fill raw content in
+#ifndef CONFIG_UCCN_NUM_LOAN_BUFFERS
+#define CONFIG_UCCN_NUM_LOAN_BUFFERS 2
+#endif
+
+#if CONFIG_UCCN_NUM_LOAN_BUFFERS > 32
+#error "uCCN loan buffers must be 32 at most"
+#endif
+
+// Threads receiving content next to the spin loop, each with its own socket
+// sharing the node port. Content for a given resource always goes to the
+// same worker, so that its callbacks stay ordered (Linux only, see
+// SO_REUSEPORT). Zero has the spin loop receive everything.
+#ifndef CONFIG_UCCN_NUM_RECEIVE_WORKERS
+#define CONFIG_UCCN_NUM_RECEIVE_WORKERS 0
+#endif
+
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+#if !CONFIG_UCCN_MULTITHREADED
+#error "uCCN receive workers require multithreading support"
+#endif
+#if !defined(__linux__)
+#error "uCCN receive workers are only supported on Linux"
+#endif
+#endif
+
+// Run tracker callbacks on a pool of threads rather than on the thread
+// receiving content, with a bounded queue of (still packed) content per
+// tracker in between
+#ifndef CONFIG_UCCN_EXECUTOR
+#define CONFIG_UCCN_EXECUTOR 0
+#endif
+
+#if CONFIG_UCCN_EXECUTOR
+
+#if !CONFIG_UCCN_MULTITHREADED
+#error "uCCN executor requires multithreading support"
+#endif
+
+#ifndef CONFIG_UCCN_EXECUTOR_NUM_THREADS
+#define CONFIG_UCCN_EXECUTOR_NUM_THREADS 2
+#endif
+
+#ifndef CONFIG_UCCN_TRACKER_QUEUE_DEPTH
+#define CONFIG_UCCN_TRACKER_QUEUE_DEPTH 8
+#endif
+
+#if CONFIG_UCCN_EXECUTOR_NUM_THREADS < 1 || CONFIG_UCCN_TRACKER_QUEUE_DEPTH < 1
+#error "uCCN executor needs at least one thread and one queue slot per tracker"
+#endif
+
+#endif
+
+// Have providers and trackers on the same host exchange content through
+// shared memory rings rather than loopback UDP, one ring per resource and
+// peer. Trackers offer rings to providers over abstract Unix sockets, and
+// peers that do not take them up keep getting content over UDP.
+#ifndef CONFIG_UCCN_SHM_TRANSPORT
+#define CONFIG_UCCN_SHM_TRANSPORT 0
+#endif
+
+#if CONFIG_UCCN_SHM_TRANSPORT
+
+#if !defined(__linux__) || !CONFIG_UCCN_EPOLL
+#error "uCCN shared memory transport is only supported on Linux, with epoll"
+#endif
+
+// Bytes of content each ring can hold, headers included
+#ifndef CONFIG_UCCN_SHM_RING_SIZE
+#define CONFIG_UCCN_SHM_RING_SIZE (64 * 1024)
+#endif
+
+#if (CONFIG_UCCN_SHM_RING_SIZE & (CONFIG_UCCN_SHM_RING_SIZE - 1)) != 0 || \
+    CONFIG_UCCN_SHM_RING_SIZE < 2 * CONFIG_UCCN_OUTGOING_BUFFER_SIZE
+#error "uCCN shared memory rings must be a power of two, and hold a couple packets"
+#endif
+
+// Rings a node can have open at once, both ways
+#ifndef CONFIG_UCCN_MAX_NUM_SHM_CHANNELS
+#define CONFIG_UCCN_MAX_NUM_SHM_CHANNELS 8
+#endif
+
+#endif
+
 #ifndef CONFIG_UCCN_LOGGING
 #define CONFIG_UCCN_LOGGING 1
 #endif
@@ -0,0 +1,272 @@
+#ifndef UCCN_TYPESUPPORT_HPP_
+#define UCCN_TYPESUPPORT_HPP_
+
+#include "uccn/uccn.h"
+
+#include "mpack/mpack.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace uccn {
+
+// MessagePack codecs for record field types, along with their worst case
+// packed size. Character arrays hold NUL terminated strings.
+template<typename T>
+struct mpack_codec;
+
+namespace detail {
+
+constexpr size_t mpack_str_header_size(size_t length)
+{
+  return length < 32 ? 1 : length < 256 ? 2 : length < 65536 ? 3 : 5;
+}
+
+constexpr size_t mpack_array_header_size(size_t count)
+{
+  return count < 16 ? 1 : count < 65536 ? 3 : 5;
+}
+
+constexpr size_t sum()
+{
+  return 0;
+}
+
+template<typename... SizeTs>
+constexpr size_t sum(size_t size, SizeTs... sizes)
+{
+  return size + sum(sizes...);
+}
+
+// FNV-1a over 32 bit words, byte by byte
+constexpr uint32_t fnv1a(uint32_t hash, uint32_t word, size_t i = 0)
+{
+  return i == 4 ? hash : fnv1a((hash ^ ((word >> (8 * i)) & 0xff)) * 16777619u, word, i + 1);
+}
+
+constexpr uint32_t fnv1a_all(uint32_t hash)
+{
+  return hash;
+}
+
+template<typename... WordTs>
+constexpr uint32_t fnv1a_all(uint32_t hash, uint32_t word, WordTs... words)
+{
+  return fnv1a_all(fnv1a(hash, word), words...);
+}
+
+// Describes how a field type is laid out in memory: kind and size
+template<typename T>
+struct layout_traits
+{
+  static_assert(std::is_arithmetic<T>::value, "only arithmetic fields have a known layout");
+
+  static constexpr uint32_t kind =
+      std::is_same<T, char>::value ? 1u :  // signedness varies across platforms
+      std::is_same<T, bool>::value ? 2u :
+      std::is_floating_point<T>::value ? 3u :
+      std::is_signed<T>::value ? 4u : 5u;
+
+  static constexpr uint32_t code = kind << 24 | sizeof(T);
+};
+
+template<typename T, size_t N>
+struct layout_traits<T[N]>
+{
+  static constexpr uint32_t code = fnv1a(layout_traits<T>::code, N);
+};
+
+}  // namespace detail
+
+#define UCCN_MPACK_CODEC(type, suffix, size)                            \
+  template<>                                                            \
+  struct mpack_codec<type>                                              \
+  {                                                                     \
+    static constexpr size_t max_size = size;                            \
+    static void write(mpack_writer_t * writer, const type & value)      \
+    {                                                                   \
+      mpack_write_##suffix(writer, value);                              \
+    }                                                                   \
+    static void read(mpack_reader_t * reader, type & value)             \
+    {                                                                   \
+      value = mpack_expect_##suffix(reader);                            \
+    }                                                                   \
+  }
+
+UCCN_MPACK_CODEC(bool, bool, 1);
+UCCN_MPACK_CODEC(uint8_t, u8, 2);
+UCCN_MPACK_CODEC(uint16_t, u16, 3);
+UCCN_MPACK_CODEC(uint32_t, u32, 5);
+UCCN_MPACK_CODEC(uint64_t, u64, 9);
+UCCN_MPACK_CODEC(int8_t, i8, 2);
+UCCN_MPACK_CODEC(int16_t, i16, 3);
+UCCN_MPACK_CODEC(int32_t, i32, 5);
+UCCN_MPACK_CODEC(int64_t, i64, 9);
+UCCN_MPACK_CODEC(float, float, 5);
+UCCN_MPACK_CODEC(double, double, 9);
+
+#undef UCCN_MPACK_CODEC
+
+template<size_t N>
+struct mpack_codec<char[N]>
+{
+  static_assert(N > 0, "strings need room for a terminator");
+
+  static constexpr size_t max_size = detail::mpack_str_header_size(N - 1) + N - 1;
+
+  static void write(mpack_writer_t * writer, const char (&value)[N])
+  {
+    mpack_write_str(writer, value, strnlen(value, N - 1));
+  }
+
+  static void read(mpack_reader_t * reader, char (&value)[N])
+  {
+    mpack_expect_cstr(reader, value, N);
+  }
+};
+
+template<typename T, size_t N>
+struct mpack_codec<T[N]>
+{
+  static constexpr size_t max_size =
+      detail::mpack_array_header_size(N) + N * mpack_codec<T>::max_size;
+
+  static void write(mpack_writer_t * writer, const T (&value)[N])
+  {
+    mpack_start_array(writer, N);
+    for (size_t i = 0; i < N; ++i) {
+      mpack_codec<T>::write(writer, value[i]);
+    }
+    mpack_finish_array(writer);
+  }
+
+  static void read(mpack_reader_t * reader, T (&value)[N])
+  {
+    mpack_expect_array_match(reader, N);
+    for (size_t i = 0; i < N; ++i) {
+      mpack_codec<T>::read(reader, value[i]);
+    }
+    mpack_done_array(reader);
+  }
+};
+
+// A record field, as a member of the record type
+template<typename ContentT, typename FieldT, FieldT ContentT::*Member>
+struct field
+{
+  using codec = mpack_codec<FieldT>;
+
+  static constexpr size_t max_size = codec::max_size;
+
+  static constexpr uint32_t layout = detail::layout_traits<FieldT>::code;
+
+  static void write(mpack_writer_t * writer, const ContentT & content)
+  {
+    codec::write(writer, content.*Member);
+  }
+
+  static void read(mpack_reader_t * reader, ContentT & content)
+  {
+    codec::read(reader, content.*Member);
+  }
+};
+
+#define UCCN_FIELD(type, member) \
+  ::uccn::field<type, decltype(type::member), &type::member>
+
+// Typesupport for records that are packed as a sequence of fields, in the
+// given order, e.g.
+//
+//   const uccn_record_typesupport_s * simple_data::get_typesupport() {
+//     return uccn::mpack_typesupport<simple_data,
+//                                    UCCN_FIELD(simple_data, number),
+//                                    UCCN_FIELD(simple_data, data)>::get();
+//   }
+//
+// Codecs are resolved at compile time, so each record type gets a pair of
+// serialize/deserialize functions with all field codecs inlined.
+template<typename ContentT, typename... FieldTs>
+struct mpack_typesupport
+{
+  // Packed size upper bound, e.g. to size buffers or check it against
+  // CONFIG_UCCN_MAX_CONTENT_SIZE
+  static constexpr size_t max_size = detail::sum(FieldTs::max_size...);
+
+  static ssize_t serialize(const uccn_record_typesupport_s * ts,
+                           const void * content,
+                           buffer_head_s * blob)
+  {
+    mpack_writer_t writer;
+    const ContentT & record = *static_cast<const ContentT *>(content);
+    (void)ts;
+    (void)record;
+    mpack_writer_init(&writer, static_cast<char *>(blob->data), blob->size);
+    // Braced lists are evaluated in order, which keeps fields in order
+    int expansion[] = {0, (FieldTs::write(&writer, record), 0)...};
+    (void)expansion;
+    blob->length = mpack_writer_buffer_used(&writer);
+    if (mpack_writer_destroy(&writer) != mpack_ok) {
+      return -1;
+    }
+    return blob->length;
+  }
+
+  static ssize_t deserialize(const uccn_record_typesupport_s * ts,
+                             const buffer_head_s * blob,
+                             void * content)
+  {
+    mpack_reader_t reader;
+    ContentT & record = *static_cast<ContentT *>(content);
+    (void)ts;
+    (void)record;
+    mpack_reader_init_data(&reader, static_cast<const char *>(blob->data), blob->length);
+    int expansion[] = {0, (FieldTs::read(&reader, record), 0)...};
+    (void)expansion;
+    if (mpack_reader_destroy(&reader) != mpack_ok) {
+      return -1;
+    }
+    return blob->length;
+  }
+
+  static const uccn_record_typesupport_s * get()
+  {
+    static const uccn_record_typesupport_s typesupport = {
+      sizeof(ContentT), &serialize, &deserialize, 0
+    };
+    return &typesupport;
+  }
+};
+
+// Typesupport for trivially copyable records, which travel as laid out in
+// memory and get copied straight into tracker content objects. Peers tell
+// layouts apart by a schema hash over record size, alignment and the
+// fields listed, if any, e.g.
+//
+//   const uccn_record_typesupport_s * sample::get_typesupport() {
+//     return uccn::flat_typesupport<sample,
+//                                   UCCN_FIELD(sample, stamp),
+//                                   UCCN_FIELD(sample, values)>::get();
+//   }
+template<typename ContentT, typename... FieldTs>
+struct flat_typesupport
+{
+  static_assert(std::is_trivially_copyable<ContentT>::value,
+                "flat records must be trivially copyable");
+
+  static constexpr uint32_t schema = detail::fnv1a_all(
+      2166136261u, sizeof(ContentT), alignof(ContentT), FieldTs::layout...);
+
+  static const uccn_record_typesupport_s * get()
+  {
+    static const uccn_record_typesupport_s typesupport = {
+      sizeof(ContentT), nullptr, nullptr, schema
+    };
+    return &typesupport;
+  }
+};
+
+}  // namespace uccn
+
+#endif  // UCCN_TYPESUPPORT_HPP_
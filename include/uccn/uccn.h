@@ -17,8 +17,10 @@
 #include <sys/types.h>
 
 #include "uccn/common/buffer.h"
+#include "uccn/common/hash_index.h"
 #include "uccn/common/time.h"
 #include "uccn/utilities/eventfd.h"
+#include "uccn/utilities/upoll.h"
 
 struct uccn_resource_s;
 
@@ -36,6 +38,8 @@ struct uccn_resource_s
 {
   char path[CONFIG_UCCN_MAX_RESOURCE_PATH_SIZE];
   uint32_t hash;
+  // Size of unpacked content objects, zero if content is handed over as is
+  size_t content_size;
 
   uccn_content_unpack_fn unpack;
   uccn_content_pack_fn pack;
@@ -47,9 +51,6 @@ struct uccn_raw_data_s {
 
 struct uccn_record_typesupport_s;
 
-typedef void *(*uccn_record_allocate_fn)(
-    const struct uccn_record_typesupport_s * ts);
-
 typedef ssize_t (*uccn_record_serialize_fn)(
     const struct uccn_record_typesupport_s * ts,
     const void * content,
@@ -62,17 +63,44 @@ typedef ssize_t (*uccn_record_deserialize_fn)(
 
 struct uccn_record_typesupport_s
 {
-  uccn_record_allocate_fn allocate;
+  // Content objects are deserialized into memory owned by trackers
+  size_t size;
+  // Flat records, i.e. trivially copyable ones, go without these and
+  // travel as laid out in memory after their schema hash instead. The
+  // hash travels in host byte order too, so that peers of the other
+  // endianness see a mismatching schema rather than garbled records.
   uccn_record_serialize_fn serialize;
   uccn_record_deserialize_fn deserialize;
+  uint32_t schema;
 };
 
+// Typesupport for a flat record type, tagged with a hash of its layout
+#define UCCN_FLAT_TYPESUPPORT(type, schema_hash)                        \
+  { .size = sizeof(type), .serialize = NULL, .deserialize = NULL,       \
+    .schema = (schema_hash) }
+
+// Size of the schema hash that precedes flat records
+#define UCCN_FLAT_RECORD_HEADER_SIZE 4
+
 struct uccn_record_s
 {
   struct uccn_resource_s base;
   const struct uccn_record_typesupport_s * ts;
 };
 
+// Room taken by capabilities in advertised link arrays, besides resources
+#define UCCN_MAX_NUM_CAPABILITY_HASHES 2
+
+struct uccn_hash_set_s
+{
+  uint32_t * hashes;
+  size_t size;
+};
+
+// Generation-tagged reference to a peer slot in a node. Stale handles,
+// i.e. to peers that were removed (and possibly replaced), fail to resolve.
+typedef uint32_t uccn_peer_handle_t;
+
 struct uccn_peer_s
 {
   struct sockaddr_in address;
@@ -80,24 +108,97 @@ struct uccn_peer_s
   char name[CONFIG_UCCN_MAX_NODE_NAME_SIZE];
 
   bool alive;
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  // Whether the peer checks content checksums
+  bool checksums;
+#endif
+#if CONFIG_UCCN_MULTICAST_CONTENT
+  // Whether the peer takes content from resource groups
+  bool multicast;
+#endif
   struct {
     struct timespec next_remote_deadline;
     struct timespec next_local_deadline;
+    // Set off at (or before) the deadlines above, which move later
+    // without touching them
+    struct upoll_timer_s remote_timer;
+    struct upoll_timer_s local_timer;
   } liveliness;
 
-  uint32_t provided_content_hash;
-  uint32_t tracked_content_hash;
+  // Sorted, last advertised sets
+  struct uccn_hash_set_s provided_content;
+  struct uccn_hash_set_s tracked_content;
   size_t num_links;
+#if !CONFIG_UCCN_DYNAMIC_CAPACITY
+  uint32_t default_storage[2 * CONFIG_UCCN_MAX_NUM_RESOURCES];
+#endif
+
+  bool in_use;
+  uint16_t generation;
+  uint16_t next_free;
 };
 
 struct uccn_node_s;
 
+#if CONFIG_UCCN_SHM_TRANSPORT
+struct shm_ring_s;
+
+// Shared memory ring to or from a peer on the same host, for one resource.
+// Trackers map rings they consume, providers map rings offered to them.
+struct uccn_shm_channel_s
+{
+  uccn_peer_handle_t peer;
+  uint32_t hash;
+  bool outgoing;
+  struct shm_ring_s * ring;
+  size_t capacity;
+  // Kicked whenever the ring was empty, i.e. the consumer may be waiting
+  int doorbell;
+  // Posts reach channels through links without the node mutex. The node
+  // holds a reference while the channel is attached, posts hold one while
+  // using it, and whoever drops the last one unmaps the ring.
+  bool attached;
+  unsigned int refs;
+#if CONFIG_UCCN_MULTITHREADED
+  // Serializes concurrent posts to the same peer
+  pthread_mutex_t producer_mutex;
+#endif
+};
+#endif
+
+struct uccn_link_s
+{
+  uccn_peer_handle_t handle;
+  // Peer address, for posts to go out without resolving the handle
+  struct sockaddr_in address;
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  bool checksums;
+#endif
+#if CONFIG_UCCN_MULTICAST_CONTENT
+  bool multicast;
+#endif
+#if CONFIG_UCCN_SHM_TRANSPORT
+  // Shared memory ring that content takes instead of UDP, if any
+  struct uccn_shm_channel_s * channel;
+#endif
+};
+
 struct uccn_content_endpoint_s
 {
   struct uccn_node_s * node;
   const struct uccn_resource_s * resource;
-  struct uccn_peer_s * peers[CONFIG_UCCN_MAX_NUM_PEERS];
+  // Links are updated under a sequence lock, so that they can be read
+  // without holding the node mutex (odd while being updated)
+  unsigned int sequence;
+  struct uccn_link_s * peers;
   size_t num_peers;
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  // Linked peers that check content checksums
+  size_t num_checked_peers;
+#endif
+#if !CONFIG_UCCN_DYNAMIC_CAPACITY
+  struct uccn_link_s default_storage[CONFIG_UCCN_MAX_NUM_PEERS];
+#endif
 };
 
 struct uccn_content_tracker_s;
@@ -106,16 +207,153 @@ typedef void (*uccn_content_track_fn)(
     struct uccn_content_tracker_s *tracker,
     void * content);
 
+#if CONFIG_UCCN_EXECUTOR
+// What to do with content arriving for a tracker whose queue is full
+enum uccn_overflow_policy_e
+{
+  UCCN_DROP_OLDEST,
+  UCCN_DROP_NEWEST,
+  // Holds up the receiving thread, and thus the node mutex, until there is
+  // room. Callbacks of such trackers must not use the node API but to post.
+  UCCN_BLOCK
+};
+
+// Content in a single packet fits these, be it received or from a ring
+#if CONFIG_UCCN_INCOMING_BUFFER_SIZE > CONFIG_UCCN_OUTGOING_BUFFER_SIZE
+#define UCCN_QUEUED_CONTENT_SIZE CONFIG_UCCN_INCOMING_BUFFER_SIZE
+#else
+#define UCCN_QUEUED_CONTENT_SIZE CONFIG_UCCN_OUTGOING_BUFFER_SIZE
+#endif
+
+// Packed content queued for a tracker, copied into a buffer allocated
+// upfront unless handed over along with its storage (e.g. reassembled)
+struct uccn_queued_content_s
+{
+  struct buffer_head_s blob;
+  void * storage;
+  char * buffer;
+};
+
+// Packed content waiting for a tracker callback, as a ring of slots that
+// keep their buffers around to be reused
+struct uccn_content_queue_s
+{
+  struct uccn_queued_content_s slots[CONFIG_UCCN_TRACKER_QUEUE_DEPTH];
+  size_t head;
+  size_t length;
+  enum uccn_overflow_policy_e policy;
+  // Set while waiting for or being served by an executor thread, so that
+  // callbacks of a given tracker never run concurrently
+  bool scheduled;
+  struct uccn_content_tracker_s * next;
+
+  uint64_t num_dropped;
+  uint64_t num_dispatched;
+};
+#endif
+
+// Fixed-size slab of content objects that trackers lend to callbacks
+struct uccn_content_pool_s
+{
+  char * objects;
+  size_t stride;
+  // Bitmasks of objects out on loan, and of those kept by their callback
+  unsigned int in_use;
+  unsigned int kept;
+};
+
 struct uccn_content_tracker_s
 {
   struct uccn_content_endpoint_s endpoint;
   uccn_content_track_fn track;
   void * arg;
+  struct uccn_content_pool_s pool;
+#if CONFIG_UCCN_EXECUTOR
+  struct uccn_content_queue_s queue;
+#endif
 };
 
+#if CONFIG_UCCN_EXECUTOR
+struct uccn_tracker_stats_s
+{
+  size_t queue_depth;
+  uint64_t num_dropped;
+  uint64_t num_dispatched;
+};
+#endif
+
 struct uccn_content_provider_s
 {
   struct uccn_content_endpoint_s endpoint;
+  // Content objects lent to publishers, if any
+  struct uccn_content_pool_s pool;
+  // Monotonic time of the last post, in nanoseconds
+  uint64_t last_post_time;
+#if CONFIG_UCCN_FRAGMENTATION
+  uint32_t sequence;
+#endif
+};
+
+#if CONFIG_UCCN_FRAGMENTATION
+// Content being put back together from fragments sent by a peer. Kept
+// without a buffer once complete or timed out, to turn late fragments away.
+struct uccn_reassembly_s
+{
+  uccn_peer_handle_t peer;
+  uint32_t hash;
+  uint32_t sequence;
+  uint16_t num_fragments;
+  uint16_t num_received;
+  uint8_t * received;
+  struct buffer_head_s buffer;
+  struct timespec deadline;
+};
+#endif
+
+struct uccn_incoming_buffer_s
+{
+  struct buffer_head_s head;
+  struct sockaddr_in origin;
+  char default_storage[CONFIG_UCCN_INCOMING_BUFFER_SIZE];
+};
+
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+// Content takes 4 bytes at the very least (a hash, a bin header and a byte
+// of content), which bounds how much of it a packet may carry
+#define UCCN_MAX_CONTENT_PER_PACKET (CONFIG_UCCN_INCOMING_BUFFER_SIZE / 4)
+
+// Room for a batch worth of content, and always for a packet full of it
+#define UCCN_MAX_NUM_DEFERRED_CONTENT \
+  (CONFIG_UCCN_RECV_BATCH_SIZE + UCCN_MAX_CONTENT_PER_PACKET)
+
+// Content left for a worker to unpack and dispatch once the node is unlocked
+struct uccn_deferred_content_s
+{
+  struct uccn_content_tracker_s * tracker;
+  struct buffer_head_s blob;
+  void * storage;
+};
+
+struct uccn_receive_worker_s
+{
+  struct uccn_node_s * node;
+  int socket;
+  pthread_t thread;
+  bool running;
+
+  struct uccn_incoming_buffer_s incoming_buffers[CONFIG_UCCN_RECV_BATCH_SIZE];
+  struct uccn_deferred_content_s deferred[UCCN_MAX_NUM_DEFERRED_CONTENT];
+  size_t num_deferred;
+};
+#endif
+
+typedef void (*uccn_watch_fn)(int fd, void * arg);
+
+struct uccn_watch_s
+{
+  int fd;
+  uccn_watch_fn callback;
+  void * arg;
 };
 
 struct uccn_network_s
@@ -124,47 +362,193 @@ struct uccn_network_s
   struct in_addr netmask;
 };
 
+struct uccn_node_capacity_s
+{
+  size_t max_num_peers;
+  size_t max_num_resources;
+  size_t max_num_trackers;
+  size_t max_num_providers;
+};
+
+#define UCCN_NODE_CAPACITY_DEFAULT                      \
+  {                                                     \
+    .max_num_peers = CONFIG_UCCN_MAX_NUM_PEERS,         \
+    .max_num_resources = CONFIG_UCCN_MAX_NUM_RESOURCES, \
+    .max_num_trackers = CONFIG_UCCN_MAX_NUM_TRACKERS,   \
+    .max_num_providers = CONFIG_UCCN_MAX_NUM_PROVIDERS  \
+  }
+
+// Size of the header that precedes content in a content packet
+#define UCCN_CONTENT_HEADER_SIZE 14
+
+// Size of that same header when it carries a checksum
+#define UCCN_CHECKED_CONTENT_HEADER_SIZE 20
+
+// Room to leave for a header before content
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+#define UCCN_CONTENT_HEADER_ROOM UCCN_CHECKED_CONTENT_HEADER_SIZE
+#else
+#define UCCN_CONTENT_HEADER_ROOM UCCN_CONTENT_HEADER_SIZE
+#endif
+
+// Content is packed right into the outgoing buffer if it always fits
+#define UCCN_IN_PLACE_CONTENT \
+  (CONFIG_UCCN_MAX_CONTENT_SIZE + UCCN_CONTENT_HEADER_ROOM <= CONFIG_UCCN_OUTGOING_BUFFER_SIZE)
+
+// Posts build whole packets if content is packed in place, content alone otherwise
+#if UCCN_IN_PLACE_CONTENT
+#define UCCN_POST_BUFFER_SIZE CONFIG_UCCN_OUTGOING_BUFFER_SIZE
+#else
+#define UCCN_POST_BUFFER_SIZE CONFIG_UCCN_MAX_CONTENT_SIZE
+#endif
+
 struct uccn_node_s
 {
   int socket;
   struct sockaddr_in address;
 
   int broadcast_socket;
+  // Where discovery goes, the discovery group if multicast
   struct sockaddr_in broadcast_address;
 
   char location[INET_ADDRSTRLEN + 7];
   char name[CONFIG_UCCN_MAX_NODE_NAME_SIZE];
 
-  struct {
-    struct buffer_head_s head;
-    char default_storage[CONFIG_UCCN_INCOMING_BUFFER_SIZE];
-  } incoming_buffer;
+  struct uccn_incoming_buffer_s incoming_buffers[CONFIG_UCCN_RECV_BATCH_SIZE];
+  // Only ever used under the node mutex
   struct {
     struct buffer_head_s head;
     char default_storage[CONFIG_UCCN_OUTGOING_BUFFER_SIZE];
   } outgoing_buffer;
+  // Taken by posts for as long as it takes to pack and send
+  struct {
+    struct buffer_head_s head;
+    char default_storage[UCCN_POST_BUFFER_SIZE];
+  } post_buffers[CONFIG_UCCN_NUM_POST_BUFFERS];
+  unsigned int post_buffers_in_use;
+#if CONFIG_UCCN_MULTITHREADED
+  // Posts finding every post buffer in use wait on these for one
+  pthread_mutex_t post_buffers_mutex;
+  pthread_cond_t post_buffer_released;
+  unsigned int num_post_waiters;
+#endif
+#if CONFIG_UCCN_NUM_LOAN_BUFFERS > 0
+  // Lent to publishers of raw content, apart from post buffers so that
+  // long loans cannot starve posts
   struct {
     struct buffer_head_s head;
-    char default_storage[CONFIG_UCCN_MAX_CONTENT_SIZE];
-  } content_buffer;
+    // What publishers get, i.e. the buffer past room for a header
+    struct buffer_head_s window;
+    char default_storage[UCCN_POST_BUFFER_SIZE];
+  } loan_buffers[CONFIG_UCCN_NUM_LOAN_BUFFERS];
+  unsigned int loan_buffers_in_use;
+#endif
+
+  struct uccn_node_capacity_s capacity;
+
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  // Content dropped for not matching its checksum
+  unsigned long num_checksum_mismatches;
+#endif
 
-  struct uccn_peer_s
-    peers[CONFIG_UCCN_MAX_NUM_PEERS];
+  struct uccn_peer_s * peers;
   size_t num_peers;
+  uint16_t free_peers;
 
-  struct uccn_content_tracker_s
-    trackers[CONFIG_UCCN_MAX_NUM_TRACKERS];
+  struct uccn_content_tracker_s * trackers;
   size_t num_trackers;
+  struct hash_index_s tracker_index;
 
-  struct uccn_content_provider_s
-    providers[CONFIG_UCCN_MAX_NUM_PROVIDERS];
+  struct uccn_content_provider_s * providers;
   size_t num_providers;
+  struct hash_index_s provider_index;
+
+  // Scratch sets for link group processing
+  struct {
+    struct uccn_hash_set_s advertised;
+    struct uccn_hash_set_s tracked;
+    struct uccn_hash_set_s provided;
+  } link_sets;
+
+#if CONFIG_UCCN_DYNAMIC_CAPACITY
+  void * arena;
+  size_t arena_size;
+  bool owns_arena;
+#else
+  struct {
+    struct uccn_peer_s peers[CONFIG_UCCN_MAX_NUM_PEERS];
+    struct uccn_content_tracker_s trackers[CONFIG_UCCN_MAX_NUM_TRACKERS];
+    struct hash_index_entry_s tracker_index[
+      HASH_INDEX_CAPACITY(CONFIG_UCCN_MAX_NUM_TRACKERS)];
+    struct uccn_content_provider_s providers[CONFIG_UCCN_MAX_NUM_PROVIDERS];
+    struct hash_index_entry_s provider_index[
+      HASH_INDEX_CAPACITY(CONFIG_UCCN_MAX_NUM_PROVIDERS)];
+    uint32_t link_sets[3 * CONFIG_UCCN_MAX_NUM_RESOURCES + UCCN_MAX_NUM_CAPABILITY_HASHES];
+  } default_storage;
+#endif
+
+#if CONFIG_UCCN_FRAGMENTATION
+  struct uccn_reassembly_s
+    reassemblies[CONFIG_UCCN_MAX_NUM_REASSEMBLIES];
+#endif
+
+  struct {
+    // Peer liveliness and discovery timers
+    struct upoll_wheel_s wheel;
+    struct upoll_timer_s discovery_timer;
+    struct timespec next_discovery_time;
+    uint32_t discovery_period_ms;  // backed off while trackers go unmatched
+    uint32_t discovery_burst;  // discovery packets left to send in a row
+    uint32_t discovery_jitter_state;
+  } timers;
+
+  struct uccn_watch_s
+    watches[CONFIG_UCCN_MAX_NUM_WATCHES];
+  size_t num_watches;
+
+#if CONFIG_UCCN_EPOLL
+  int epoll_fd;
+  int timer_fd;
+  struct timespec timer_deadline;
+#endif
+
+#if CONFIG_UCCN_SHM_TRANSPORT
+  // Bound to an abstract address after the node one, rings are passed
+  // along through it
+  int shm_socket;
+  struct uccn_shm_channel_s
+    shm_channels[CONFIG_UCCN_MAX_NUM_SHM_CHANNELS];
+#endif
 
 #if CONFIG_UCCN_MULTITHREADED
+  // Posts do not take this one
   pthread_mutex_t mutex;
 #endif
 
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+  struct uccn_receive_worker_s
+    receive_workers[CONFIG_UCCN_NUM_RECEIVE_WORKERS];
+  // Worker currently processing packets, under the node mutex
+  struct uccn_receive_worker_s * deferring_worker;
+  struct eventfd_s workers_stop_event;
+#endif
+
+#if CONFIG_UCCN_EXECUTOR
+  struct {
+    pthread_t threads[CONFIG_UCCN_EXECUTOR_NUM_THREADS];
+    size_t num_threads;
+    pthread_mutex_t mutex;
+    // Signaled when trackers get content, and when queues free up
+    pthread_cond_t ready;
+    pthread_cond_t room;
+    struct uccn_content_tracker_s * first_ready;
+    struct uccn_content_tracker_s * last_ready;
+    bool stopping;
+  } executor;
+#endif
+
   struct eventfd_s stop_event;
+  struct eventfd_s wakeup_event;
 };
 
 #if defined(__cplusplus)
@@ -172,9 +556,25 @@ extern "C"
 {
 #endif
 
+#if CONFIG_UCCN_DYNAMIC_CAPACITY
+// Returns the arena size, in bytes, a node needs for the given capacity.
+size_t uccn_node_arena_size(const struct uccn_node_capacity_s * capacity);
+
+// Peers, endpoints and indices are carved out of the given arena, which
+// must outlive the node. A NULL arena is allocated on the heap instead.
+int uccn_node_init(struct uccn_node_s * node,
+                   const struct uccn_network_s * network,
+                   const char * name,
+                   const struct uccn_node_capacity_s * capacity,
+                   void * arena, size_t arena_size);
+#else
 int uccn_node_init(struct uccn_node_s * node,
                    const struct uccn_network_s * network,
                    const char * name);
+#endif
+
+// Returns the total memory, in bytes, taken up by the node.
+size_t uccn_node_footprint(const struct uccn_node_s * node);
 
 void uccn_raw_data_init(struct uccn_raw_data_s * raw_data, const char * path);
 
@@ -191,10 +591,59 @@ struct uccn_content_provider_s * uccn_advertise(struct uccn_node_s * node,
 
 int uccn_post(struct uccn_content_provider_s * provider, const void * content);
 
+// Lends something to fill content in, for it to be published without
+// copies: a content object for resources with a content size (e.g. records),
+// a buffer head to set data length on otherwise (e.g. raw data). Returns
+// NULL if there is nothing left to lend. Lent objects keep whatever
+// they held when last given back. Loans must be either published or
+// discarded, which gives them back in both cases.
+void * uccn_borrow(struct uccn_content_provider_s * provider);
+
+int uccn_publish(struct uccn_content_provider_s * provider, void * loan);
+
+void uccn_discard(struct uccn_content_provider_s * provider, void * loan);
+
+// Content handed to track callbacks is on loan, and goes back to the tracker
+// once the callback returns. Callbacks may keep it instead, for as long as
+// they need, and return it later from any thread. Only content of resources
+// with a content size (e.g. records) can be kept.
+void uccn_keep_content(struct uccn_content_tracker_s * tracker, void * content);
+
+void uccn_return_content(struct uccn_content_tracker_s * tracker, void * content);
+
+#if CONFIG_UCCN_EXECUTOR
+// Trackers drop their oldest content by default.
+int uccn_set_overflow_policy(struct uccn_content_tracker_s * tracker,
+                             enum uccn_overflow_policy_e policy);
+
+int uccn_get_tracker_stats(struct uccn_content_tracker_s * tracker,
+                           struct uccn_tracker_stats_s * stats);
+#endif
+
+int uccn_watch(struct uccn_node_s * node, int fd,
+               uccn_watch_fn callback, void * arg);
+
+int uccn_unwatch(struct uccn_node_s * node, int fd);
+
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+// Returns how much content got dropped for not matching its checksum
+unsigned long uccn_get_checksum_mismatches(struct uccn_node_s * node);
+#endif
+
+#if CONFIG_UCCN_EPOLL
+// Returns a file descriptor that becomes readable whenever the node has
+// work to do, so that it can be watched by another node's (or any other)
+// event loop and spun with a zero timeout from there.
+int uccn_fileno(struct uccn_node_s * node);
+#endif
+
 int uccn_spin(struct uccn_node_s * node, const struct timespec * timeout);
 
 int uccn_spin_until(struct uccn_node_s * node, const struct timespec * timeout_time);
 
+// Kicks the node spin loop from any thread, e.g. after queueing work for it.
+int uccn_wakeup(struct uccn_node_s * node);
+
 int uccn_stop(struct uccn_node_s * node);
 
 int uccn_node_fini(struct uccn_node_s * node);
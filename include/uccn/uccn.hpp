@@ -13,6 +13,7 @@
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #if CONFIG_UCCN_MULTITHREADED
 #include <thread>
@@ -21,6 +22,105 @@
 
 namespace uccn {
 
+// Something borrowed from a provider to fill content in, which gets
+// discarded unless published before it is reset or goes out of scope.
+template<typename ContentT>
+class post_loan final
+{
+public:
+  post_loan() = default;
+
+  post_loan(uccn_content_provider_s * c_provider, ContentT * content) noexcept
+    : c_provider_(c_provider), content_(content)
+  {
+  }
+
+  post_loan(post_loan && other) noexcept
+    : c_provider_(other.c_provider_), content_(other.content_)
+  {
+    other.content_ = nullptr;
+  }
+
+  post_loan & operator=(post_loan && other) noexcept
+  {
+    if (this != &other) {
+      reset();
+      c_provider_ = other.c_provider_;
+      content_ = other.content_;
+      other.content_ = nullptr;
+    }
+    return *this;
+  }
+
+  post_loan(const post_loan &) = delete;
+  post_loan & operator=(const post_loan &) = delete;
+
+  ~post_loan() { reset(); }
+
+  void reset() noexcept
+  {
+    if (content_) {
+      uccn_discard(c_provider_, content_);
+      content_ = nullptr;
+    }
+  }
+
+  ContentT * release() noexcept
+  {
+    ContentT * content = content_;
+    content_ = nullptr;
+    return content;
+  }
+
+  ContentT * get() const noexcept { return content_; }
+  ContentT & operator*() const noexcept { return *content_; }
+  ContentT * operator->() const noexcept { return content_; }
+  explicit operator bool() const noexcept { return content_ != nullptr; }
+
+private:
+  uccn_content_provider_s * c_provider_{nullptr};
+  ContentT * content_{nullptr};
+};
+
+namespace detail {
+
+template<typename ContentT>
+post_loan<ContentT> borrow(uccn_content_provider_s * c_provider)
+{
+  if (!c_provider) {
+    throw std::logic_error("uninitialized content provider");
+  }
+  void * content = uccn_borrow(c_provider);
+  if (content == nullptr) {
+    std::stringstream message;
+    message << "Nothing left to borrow for '"
+            << c_provider->endpoint.resource->path
+            << "' resource";
+    throw std::runtime_error(message.str());
+  }
+  return post_loan<ContentT>(c_provider, static_cast<ContentT *>(content));
+}
+
+template<typename ContentT>
+int publish(uccn_content_provider_s * c_provider, post_loan<ContentT> && loan)
+{
+  if (!loan) {
+    throw std::logic_error("nothing borrowed to publish");
+  }
+  // Published or not, the loan is given back
+  int ret = uccn_publish(c_provider, loan.release());
+  if (ret < 0) {
+    std::stringstream message;
+    message << "Failed to publish content to '"
+            << c_provider->endpoint.resource->path
+            << "' resource";
+    throw std::runtime_error(message.str());
+  }
+  return ret;
+}
+
+}  // namespace detail
+
 class raw_provider final {
  public:
   raw_provider() = default;
@@ -54,18 +154,26 @@ class raw_provider final {
   int post(const DataT * data, size_t length)
   {
     buffer_head_s raw_buffer;
-    raw_buffer.data = data;
-    raw_buffer.size = raw_buffer.length = length;
+    raw_buffer.data = const_cast<DataT *>(data);
+    raw_buffer.size = raw_buffer.length = length * sizeof(DataT);
     return post(&raw_buffer);
   }
 
   template<typename DataT>
-  int post(const std::vector<DataT> buffer)
+  int post(const std::vector<DataT> & buffer)
   {
-    buffer_head_s raw_buffer;
-    raw_buffer.data = buffer.data();
-    raw_buffer.size = buffer.length = buffer.size();
-    return post(&raw_buffer);
+    return post(buffer.data(), buffer.size());
+  }
+
+  // Borrows a buffer to fill in place, setting its length
+  post_loan<buffer_head_s> borrow()
+  {
+    return detail::borrow<buffer_head_s>(c_provider_);
+  }
+
+  int publish(post_loan<buffer_head_s> && loan)
+  {
+    return detail::publish(c_provider_, std::move(loan));
   }
 
  private:
@@ -108,10 +216,73 @@ public:
     return post(&content);
   }
 
+  post_loan<ContentT> borrow()
+  {
+    return detail::borrow<ContentT>(c_provider_);
+  }
+
+  int publish(post_loan<ContentT> && loan)
+  {
+    return detail::publish(c_provider_, std::move(loan));
+  }
+
  private:
   uccn_content_provider_s * c_provider_{nullptr};
 };
 
+// Content lent by a tracker, which gets it back once the loan is reset
+// or goes out of scope. Loans can be moved around and outlive callbacks.
+template<typename ContentT>
+class loan final
+{
+public:
+  loan() = default;
+
+  loan(uccn_content_tracker_s * c_tracker, ContentT * content) noexcept
+    : c_tracker_(c_tracker), content_(content)
+  {
+  }
+
+  loan(loan && other) noexcept
+    : c_tracker_(other.c_tracker_), content_(other.content_)
+  {
+    other.content_ = nullptr;
+  }
+
+  loan & operator=(loan && other) noexcept
+  {
+    if (this != &other) {
+      reset();
+      c_tracker_ = other.c_tracker_;
+      content_ = other.content_;
+      other.content_ = nullptr;
+    }
+    return *this;
+  }
+
+  loan(const loan &) = delete;
+  loan & operator=(const loan &) = delete;
+
+  ~loan() { reset(); }
+
+  void reset() noexcept
+  {
+    if (content_) {
+      uccn_return_content(c_tracker_, content_);
+      content_ = nullptr;
+    }
+  }
+
+  ContentT * get() const noexcept { return content_; }
+  ContentT & operator*() const noexcept { return *content_; }
+  ContentT * operator->() const noexcept { return content_; }
+  explicit operator bool() const noexcept { return content_ != nullptr; }
+
+private:
+  uccn_content_tracker_s * c_tracker_{nullptr};
+  ContentT * content_{nullptr};
+};
+
 class network final {
  public:
   network(const struct in_addr & inetaddr,
@@ -179,6 +350,35 @@ class record : public resource {
 
 class node final {
  public:
+#if CONFIG_UCCN_DYNAMIC_CAPACITY
+  node(const network & net, const std::string & name)
+    : node(net, name, default_capacity())
+  {
+  }
+
+  node(const network & net, const std::string & name,
+       const uccn_node_capacity_s & capacity,
+       void * arena = nullptr, size_t arena_size = 0)
+  {
+    if (uccn_node_init(&c_node_, net.c_network(), name.c_str(),
+                       &capacity, arena, arena_size) < 0)
+    {
+      std::stringstream message;
+      message << "Failed to initialize '" << name << "' node";
+      throw std::runtime_error(message.str());
+    }
+  }
+
+  static uccn_node_capacity_s default_capacity() noexcept
+  {
+    uccn_node_capacity_s capacity;
+    capacity.max_num_peers = CONFIG_UCCN_MAX_NUM_PEERS;
+    capacity.max_num_resources = CONFIG_UCCN_MAX_NUM_RESOURCES;
+    capacity.max_num_trackers = CONFIG_UCCN_MAX_NUM_TRACKERS;
+    capacity.max_num_providers = CONFIG_UCCN_MAX_NUM_PROVIDERS;
+    return capacity;
+  }
+#else
   node(const network & net, const std::string & name)
   {
     if (uccn_node_init(&c_node_, net.c_network(), name.c_str()) < 0)
@@ -188,6 +388,7 @@ class node final {
       throw std::runtime_error(message.str());
     }
   }
+#endif
 
   ~node()
   {
@@ -225,15 +426,26 @@ class node final {
   template <typename ContentT>
   void track(const record<ContentT> & resource, std::function<void (const ContentT &)> track)
   {
-    auto wrapper = [track](void * content) -> void {
+    auto wrapper = [track](uccn_content_tracker_s *, void * content) -> void {
       track(*static_cast<ContentT *>(content));
     };
     generic_track(resource, wrapper);
   }
 
+  template <typename ContentT>
+  void track(const record<ContentT> & resource, std::function<void (loan<ContentT>)> track)
+  {
+    auto wrapper = [track](uccn_content_tracker_s * c_tracker, void * content) -> void {
+      // Kept on behalf of the loan, which returns it when done
+      uccn_keep_content(c_tracker, content);
+      track(loan<ContentT>(c_tracker, static_cast<ContentT *>(content)));
+    };
+    generic_track(resource, wrapper);
+  }
+
   void track(const raw_data & resource, std::function<void (const buffer_head_s *)> track)
   {
-    auto wrapper = [track](void * content) -> void {
+    auto wrapper = [track](uccn_content_tracker_s *, void * content) -> void {
       track(static_cast<buffer_head_s *>(content));
     };
     generic_track(resource, wrapper);
@@ -242,9 +454,9 @@ class node final {
   template <typename DataT>
   void track(const raw_data & resource, std::function<void (const DataT *, size_t)> track)
   {
-    auto wrapper = [track](void * content) -> void {
+    auto wrapper = [track](uccn_content_tracker_s *, void * content) -> void {
       auto raw_buffer = static_cast<buffer_head_s *>(content);
-      track(static_cast<DataT *>(raw_buffer->data), raw_buffer->length);
+      track(static_cast<DataT *>(raw_buffer->data), raw_buffer->length / sizeof(DataT));
     };
     generic_track(resource, wrapper);
   }
@@ -252,7 +464,7 @@ class node final {
   template <typename DataT>
   void track(const raw_data & resource, std::function<void (const std::vector<DataT>)> track)
   {
-    auto wrapper = [track](void * content) -> void {
+    auto wrapper = [track](uccn_content_tracker_s *, void * content) -> void {
       auto raw_buffer = static_cast<buffer_head_s *>(content);
       track(std::vector<DataT>(static_cast<DataT *>(raw_buffer->data),
                                static_cast<DataT *>(raw_buffer->data + raw_buffer->length)));
@@ -260,6 +472,40 @@ class node final {
     generic_track(resource, wrapper);
   }
 
+  void watch(int fd, std::function<void (int)> callback)
+  {
+    {
+#if CONFIG_UCCN_MULTITHREADED
+      std::lock_guard<std::mutex> lock(mutex_);
+#endif
+      watch_cpp_functions_[fd] = callback;
+    }
+    if (uccn_watch(&c_node_, fd, &node::watch_c_function, this) < 0) {
+      std::stringstream message;
+      message << "Failed to watch fd " << fd << " from '" << c_node_.name << "' node";
+      throw std::runtime_error(message.str());
+    }
+  }
+
+  void unwatch(int fd)
+  {
+    if (uccn_unwatch(&c_node_, fd) < 0) {
+      std::stringstream message;
+      message << "Failed to unwatch fd " << fd << " from '" << c_node_.name << "' node";
+      throw std::runtime_error(message.str());
+    }
+#if CONFIG_UCCN_MULTITHREADED
+    std::lock_guard<std::mutex> lock(mutex_);
+#endif
+    watch_cpp_functions_.erase(fd);
+  }
+
+#if CONFIG_UCCN_EPOLL
+  int fileno() noexcept { return uccn_fileno(&c_node_); }
+#endif
+
+  size_t footprint() const noexcept { return uccn_node_footprint(&c_node_); }
+
   void spin_until(const struct timespec * timeout_time)
   {
     if (uccn_spin_until(&c_node_, timeout_time) < 0) {
@@ -304,6 +550,14 @@ class node final {
     spin(NULL);
   }
 
+  void wakeup() {
+    if (uccn_wakeup(&c_node_) < 0) {
+      std::stringstream message;
+      message << "Failed to wake '" << c_node_.name << "' node up";
+      throw std::runtime_error(message.str());
+    }
+  }
+
   void stop() {
     if (uccn_stop(&c_node_) < 0) {
       std::stringstream message;
@@ -313,12 +567,16 @@ class node final {
   }
 
  private:
-  void generic_track(const resource & resource, std::function<void (void *)> track) {
+  void generic_track(const resource & resource,
+                     std::function<void (uccn_content_tracker_s *, void *)> track) {
+    const uccn_resource_s * c_resource = resource.c_resource();
+    {
+      // Not held while tracking, callbacks take it under the node mutex
 #if CONFIG_UCCN_MULTITHREADED
-    std::lock_guard<std::mutex> lock(mutex_);
+      std::lock_guard<std::mutex> lock(mutex_);
 #endif
-    const uccn_resource_s * c_resource = resource.c_resource();
-    generic_track_cpp_functions_[c_resource->hash] = track;
+      generic_track_cpp_functions_[c_resource->hash] = track;
+    }
     uccn_content_tracker_s * c_tracker = uccn_track(
         &c_node_, c_resource, &node::generic_track_c_function, this);
     if (c_tracker == NULL) {
@@ -331,10 +589,35 @@ class node final {
   static void generic_track_c_function(uccn_content_tracker_s * tracker, void * content) {
     auto self = static_cast<node *>(tracker->arg);
     uccn_content_endpoint_s * endpoint = &tracker->endpoint;
-    self->generic_track_cpp_functions_[endpoint->resource->hash](content);
+    std::function<void(uccn_content_tracker_s *, void *)> track;
+    {
+      // Callbacks may run on other threads than the one tracking
+#if CONFIG_UCCN_MULTITHREADED
+      std::lock_guard<std::mutex> lock(self->mutex_);
+#endif
+      track = self->generic_track_cpp_functions_[endpoint->resource->hash];
+    }
+    track(tracker, content);
   };
 
-  std::unordered_map<uint32_t, std::function<void(void *)>> generic_track_cpp_functions_;
+  static void watch_c_function(int fd, void * arg) {
+    auto self = static_cast<node *>(arg);
+    std::function<void(int)> callback;
+    {
+#if CONFIG_UCCN_MULTITHREADED
+      std::lock_guard<std::mutex> lock(self->mutex_);
+#endif
+      callback = self->watch_cpp_functions_[fd];
+    }
+    if (callback) {
+      callback(fd);
+    }
+  }
+
+  std::unordered_map<uint32_t,
+                     std::function<void(uccn_content_tracker_s *, void *)>>
+      generic_track_cpp_functions_;
+  std::unordered_map<int, std::function<void(int)>> watch_cpp_functions_;
 
   uccn_node_s c_node_;
 #if CONFIG_UCCN_MULTITHREADED
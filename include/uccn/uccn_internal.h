@@ -5,15 +5,45 @@
 
 #include "mpack/mpack.h"
 
+#include <sys/uio.h>
+
 #define UCCN_NODE_NAME          0x8C
 #define UCCN_PROVIDED_ARRAY     0x4D
 #define UCCN_TRACKED_ARRAY      0xD4
 #define UCCN_MAX_NUM_LINK_DATA  3
 
+// Capabilities go along resource hashes in link arrays, as hashes that no
+// resource path is expected to have. Peers unaware of them find no endpoint
+// to link for these, and move on.
+#define UCCN_CHECKSUMS_HASH  0x00000001
+#define UCCN_MULTICAST_HASH  0x00000002
+#define UCCN_MAX_CAPABILITY_HASH  UCCN_MULTICAST_HASH
+#define UCCN_NUM_CAPABILITY_HASHES \
+  (CONFIG_UCCN_CONTENT_CHECKSUMS + CONFIG_UCCN_MULTICAST_CONTENT)
+
 #define UCCN_LINK_GROUP      0x5A
 #define UCCN_CONTENT_GROUP   0xA5
 #define UCCN_MAX_NUM_GROUPS  2
 
+#define UCCN_NUM_FRAGMENT_FIELDS  5
+#define UCCN_FRAGMENT_HEADER_SIZE  31
+#define UCCN_CHECKED_FRAGMENT_HEADER_SIZE  36
+
+#if CONFIG_UCCN_SHM_TRANSPORT
+#define UCCN_SHM_OFFER_MAGIC  0x7563636E
+
+// Sent along with a ring memfd and its doorbell eventfd to the provider
+struct uccn_shm_offer_s
+{
+  uint32_t magic;
+  uint32_t hash;
+  uint32_t capacity;
+};
+#endif
+
+#define UCCN_NULL_PEER_HANDLE  0
+#define UCCN_NO_FREE_PEERS     0xFFFF
+
 #define same_sockaddr_in(a, b)                        \
   (((a)->sin_addr.s_addr == (b)->sin_addr.s_addr) &&  \
    ((a)->sin_port == (b)->sin_port))
@@ -23,20 +53,87 @@ extern "C"
 {
 #endif
 
+static inline uccn_peer_handle_t
+uccn_peer_handle(const struct uccn_node_s * node, const struct uccn_peer_s * peer)
+{
+  return ((uccn_peer_handle_t)peer->generation << 16) |
+      (uccn_peer_handle_t)(peer - node->peers);
+}
+
+static inline struct uccn_peer_s *
+uccn_peer_lookup(struct uccn_node_s * node, uccn_peer_handle_t handle)
+{
+  struct uccn_peer_s * peer;
+  size_t index = handle & 0xFFFF;
+
+  if (index >= node->capacity.max_num_peers) {
+    return NULL;
+  }
+  peer = &node->peers[index];
+  if (!peer->in_use || peer->generation != (handle >> 16)) {
+    return NULL;
+  }
+  return peer;
+}
+
+struct uccn_peer_s * uccn_acquire_peer(struct uccn_node_s * node);
+
+void uccn_release_peer(struct uccn_node_s * node, struct uccn_peer_s * peer);
+
 int uccn_prepare_keepalive_packet(struct uccn_node_s * node,
                                   struct buffer_head_s * packet);
 
 int uccn_prepare_discovery_packet(struct uccn_node_s * node,
                                   struct buffer_head_s * packet);
 
+// Pushes the peer's local deadline past the last content posted to it
+void uccn_account_posts(struct uccn_node_s * node, struct uccn_peer_s * peer);
+
+// Sends the keepalive packet to the peer, unless posts did already, and
+// sets its local timer again
 int uccn_assert_liveliness(struct uccn_node_s * node,
-                           struct timespec * next_deadline);
+                           struct uccn_peer_s * peer,
+                           const struct buffer_head_s * keepalive_packet,
+                           const struct timespec * current_time);
+
+// Checksums are left out if NULL
+size_t uccn_write_content_header(char * header, uint32_t hash,
+                                 const uint32_t * checksum,
+                                 uint32_t length);
+
+#if CONFIG_UCCN_FRAGMENTATION
+size_t uccn_write_fragment_header(char * header, uint32_t hash,
+                                  uint32_t sequence, uint16_t index,
+                                  uint16_t num_fragments,
+                                  uint32_t total_length,
+                                  const uint32_t * checksum,
+                                  uint32_t length);
+#endif
+
+int uccn_fanout(struct uccn_node_s * node,
+                const struct iovec * iov,
+                size_t iovcnt,
+                const struct sockaddr_in * addresses,
+                size_t num_addresses);
+
+// Peers that check checksums get checked_iov instead, if not NULL
+int uccn_fanout_endpoint(struct uccn_content_endpoint_s * endpoint,
+                         const struct iovec * iov,
+                         const struct iovec * checked_iov,
+                         size_t iovcnt);
+
+#if CONFIG_UCCN_FRAGMENTATION
+int uccn_post_fragments(struct uccn_content_provider_s * provider,
+                        struct buffer_head_s * blob);
+#endif
 
 struct uccn_peer_s * uccn_register_peer(struct uccn_node_s * node,
                                         struct sockaddr_in * address);
 
 int uccn_discover_peers(struct uccn_node_s * node);
 
+int uccn_receive_batch(int sockfd, struct uccn_incoming_buffer_s * buffers);
+
 int uccn_process_incoming_unicast(struct uccn_node_s * node);
 
 int uccn_process_incoming_broadcast(struct uccn_node_s * node);
@@ -45,45 +142,140 @@ int uccn_process_incoming(struct uccn_node_s * node,
                           struct sockaddr_in * origin,
                           struct buffer_head_s * incoming_packet);
 
-int uccn_probe_endpoints(struct uccn_node_s * node,
-                         size_t * num_active_trackers,
-                         size_t * num_active_providers,
-                         struct timespec * next_probe_time);
+// Unlinks peers that are gone from all endpoints. Returns how many
+// trackers were left without providers.
+size_t uccn_probe_endpoints(struct uccn_node_s * node);
+
+size_t uccn_count_active_trackers(struct uccn_node_s * node);
+
+int uccn_init_content_pool(struct uccn_content_pool_s * pool, size_t content_size);
+
+void uccn_fini_content_pool(struct uccn_content_pool_s * pool);
+
+int uccn_dispatch_content(struct uccn_content_tracker_s * tracker,
+                          struct buffer_head_s * blob);
 
 int uccn_process_content_blob(struct uccn_node_s * node,
                               struct uccn_peer_s * peer,
                               uint32_t hash,
-                              struct buffer_head_s * blob);
+                              struct buffer_head_s * blob,
+                              void * storage);
+
+#if CONFIG_UCCN_EXECUTOR
+int uccn_start_executor(struct uccn_node_s * node);
+
+int uccn_stop_executor(struct uccn_node_s * node);
+
+int uccn_init_content_queue(struct uccn_content_queue_s * queue);
+
+void uccn_fini_content_queue(struct uccn_content_queue_s * queue);
+
+// Storage, if any, is handed over along with content, which is copied
+// otherwise
+int uccn_enqueue_content(struct uccn_node_s * node,
+                         struct uccn_content_tracker_s * tracker,
+                         const struct buffer_head_s * blob,
+                         void * storage);
+#endif
+
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+int uccn_start_receive_workers(struct uccn_node_s * node);
+
+int uccn_stop_receive_workers(struct uccn_node_s * node);
+
+int uccn_process_incoming_content(struct uccn_receive_worker_s * worker);
+#endif
+
+#if CONFIG_UCCN_FRAGMENTATION
+int uccn_process_content_fragment(struct uccn_node_s * node,
+                                  struct uccn_peer_s * peer,
+                                  uint32_t hash,
+                                  mpack_reader_t * reader);
+
+void uccn_release_reassembly(struct uccn_reassembly_s * reassembly);
+
+void uccn_expire_reassemblies(struct uccn_node_s * node,
+                              const struct timespec * current_time,
+                              struct timespec * next_deadline);
+#endif
 
 int uccn_process_content_group(struct uccn_node_s * node,
                                struct uccn_peer_s * peer,
                                mpack_reader_t * reader);
 
+void uccn_begin_links_update(struct uccn_content_endpoint_s * endpoint);
+
+void uccn_end_links_update(struct uccn_content_endpoint_s * endpoint);
+
+size_t uccn_read_links(struct uccn_content_endpoint_s * endpoint,
+                       size_t offset,
+                       struct uccn_link_s * links,
+                       size_t max_num_links,
+                       size_t * num_peers);
+
 int uccn_link(struct uccn_content_endpoint_s * endpoint,
               struct uccn_peer_s * peer);
 
 int uccn_unlink(struct uccn_content_endpoint_s * endpoint,
                 struct uccn_peer_s * peer);
 
-int uccn_link_trackers(struct uccn_node_s * node,
-                       struct uccn_peer_s * peer,
-                       uint32_t hash);
+#if CONFIG_UCCN_SHM_TRANSPORT
+// Offers the peer, if on the same host, a ring to post content through.
+// Returns 1 if offered, 0 if there was no point or room for it.
+int uccn_offer_shm_channel(struct uccn_node_s * node,
+                           struct uccn_peer_s * peer,
+                           uint32_t hash);
 
-int uccn_link_providers(struct uccn_node_s * node,
-                        struct uccn_peer_s * peer,
-                        uint32_t hash);
+int uccn_accept_shm_channel(struct uccn_node_s * node);
+
+int uccn_drain_shm_channel(struct uccn_node_s * node,
+                           struct uccn_shm_channel_s * channel);
+
+// Returns 1 if content went into the ring, 0 if it has to go some other way
+int uccn_shm_send(struct uccn_shm_channel_s * channel,
+                  uccn_peer_handle_t peer, uint32_t hash,
+                  const struct iovec * iov, size_t iovcnt);
+
+void uccn_close_shm_channel(struct uccn_node_s * node,
+                            struct uccn_shm_channel_s * channel);
+#endif
+
+int uccn_read_hash_set(mpack_reader_t * reader,
+                       struct uccn_hash_set_s * set,
+                       size_t capacity);
+
+bool uccn_hash_set_contains(const struct uccn_hash_set_s * set,
+                            uint32_t hash);
+
+void uccn_write_capability_hashes(mpack_writer_t * writer);
 
-int uccn_unlink_providers(struct uccn_node_s * node,
-                          struct uccn_peer_s * peer);
+// Takes capabilities out of a set of advertised hashes, into the peer
+void uccn_read_capability_hashes(struct uccn_peer_s * peer,
+                                 struct uccn_hash_set_s * set);
 
-int uccn_unlink_trackers(struct uccn_node_s * node,
-                         struct uccn_peer_s * peer);
+// Endpoints that get their first peer are counted into num_first_links,
+// if not NULL
+int uccn_relink(struct uccn_peer_s * peer,
+                struct hash_index_s * index,
+                struct uccn_hash_set_s * linked_set,
+                const struct uccn_hash_set_s * advertised_set,
+                struct uccn_hash_set_s * matched_set,
+                size_t * num_first_links);
 
 int uccn_process_link_group(struct uccn_node_s * node,
                             struct uccn_peer_s * peer,
                             mpack_reader_t * reader,
                             mpack_writer_t * writer);
 
+int uccn_process_timers(struct uccn_node_s * node,
+                        struct timespec * next_deadline);
+
+int uccn_dispatch_event(struct uccn_node_s * node, int fd);
+
+int uccn_poll_events(struct uccn_node_s * node,
+                     const struct timespec * next_deadline,
+                     const struct timespec * timeout_time);
+
 int uccn_process_packet(struct uccn_node_s * node,
                         struct uccn_peer_s * peer,
                         struct buffer_head_s * incoming_packet,
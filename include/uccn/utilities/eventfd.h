@@ -1,9 +1,23 @@
 #ifndef UCCN_UTILITIES_EVENTFD_H_
 #define UCCN_UTILITIES_EVENTFD_H_
 
+#ifndef EVENTFD_NATIVE
+#if defined(__linux__)
+#define EVENTFD_NATIVE 1
+#else
+#define EVENTFD_NATIVE 0
+#endif
+#endif
+
+// A level-triggered, pollable wakeup flag. Setting it any number of times
+// before it is cleared has the same effect as setting it once.
 struct eventfd_s
 {
+#if EVENTFD_NATIVE
+  int fd;
+#else
   int fd[2];
+#endif
 };
 
 #if defined(__cplusplus)
@@ -16,7 +30,11 @@ int eventfd_init(struct eventfd_s * ev);
 int eventfd_set(struct eventfd_s * ev);
 
 static inline int eventfd_fileno(struct eventfd_s * ev) {
+#if EVENTFD_NATIVE
+  return ev->fd;
+#else
   return ev->fd[0];
+#endif
 }
 
 int eventfd_clear(struct eventfd_s * ev);
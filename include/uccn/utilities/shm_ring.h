@@ -0,0 +1,55 @@
+#ifndef UCCN_UTILITIES_SHM_RING_H_
+#define UCCN_UTILITIES_SHM_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+// Single producer, single consumer ring of variable length entries, meant
+// to live in memory shared by two processes. Entries are stored whole, so
+// that consumers can process them in place. Positions only ever grow, and
+// each one is written by one side only.
+struct shm_ring_s
+{
+  uint32_t capacity;
+  char pad0[60];
+  uint64_t head;
+  char pad1[56];
+  uint64_t tail;
+  char pad2[56];
+  char data[];
+};
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+// Returns the size of a ring with room for capacity bytes of entries,
+// which must be a power of two.
+size_t shm_ring_footprint(size_t capacity);
+
+void shm_ring_init(struct shm_ring_s * ring, size_t capacity);
+
+// Both sides pass the capacity they agreed upon rather than trusting the
+// one in shared memory.
+
+// Returns 1 if the consumer may be waiting for entries and needs a wakeup,
+// 0 if not, -1 if the entry does not fit (yet).
+int shm_ring_push(struct shm_ring_s * ring, size_t capacity,
+                  const struct iovec * iov, size_t iovcnt);
+
+// Returns the length of the oldest entry and points data to it, -1 if
+// the ring is empty, -2 if the ring got corrupted. Entries stay put until
+// popped.
+ssize_t shm_ring_peek(struct shm_ring_s * ring, size_t capacity, void ** data);
+
+void shm_ring_pop(struct shm_ring_s * ring, size_t length);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif  // UCCN_UTILITIES_SHM_RING_H_
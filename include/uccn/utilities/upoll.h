@@ -1,7 +1,9 @@
 #ifndef UCCN_UTILITIES_UPOLL_H_
 #define UCCN_UTILITIES_UPOLL_H_
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 
 typedef void (*upoll_fn)(void * arg);
@@ -14,6 +16,37 @@ struct upoll_s {
   struct timespec next_poll_time;
 };
 
+// Hierarchical timer wheel, for many one-shot timers of which few expire
+// at a time. Each level has as many slots as bits in its occupancy mask,
+// and spans as many slots of the level below. Timers move down levels
+// as their expiry gets closer.
+#define UPOLL_WHEEL_SLOT_BITS 6
+#define UPOLL_WHEEL_NUM_SLOTS (1 << UPOLL_WHEEL_SLOT_BITS)
+#define UPOLL_WHEEL_NUM_LEVELS 4
+
+#if UPOLL_WHEEL_SLOT_BITS > 6
+#error "upoll wheel slots must fit in 64 bit occupancy masks"
+#endif
+
+// Timers are embedded in whatever they time, a zeroed timer is idle
+struct upoll_timer_s {
+  struct upoll_timer_s * next;
+  struct upoll_timer_s ** prev;
+  uint64_t expiry;  // in ticks
+  void * arg;
+};
+
+struct upoll_wheel_s {
+  struct timespec origin;
+  long resolution;  // in nanoseconds per tick
+  uint64_t ticks;  // elapsed since origin, as of the last advance
+  uint64_t occupied[UPOLL_WHEEL_NUM_LEVELS];
+  struct upoll_timer_s * slots[UPOLL_WHEEL_NUM_LEVELS][UPOLL_WHEEL_NUM_SLOTS];
+  // Beyond the top level's current turn
+  struct upoll_timer_s * overflow;
+  struct upoll_timer_s * expired;
+};
+
 #if defined(__cplusplus)
 extern "C"
 {
@@ -21,6 +54,37 @@ extern "C"
 
 int upoll(struct upoll_s * polls, size_t npolls, struct timespec * next_poll_time);
 
+void upoll_wheel_init(struct upoll_wheel_s * wheel,
+                      const struct timespec * origin,
+                      long resolution);
+
+void upoll_timer_init(struct upoll_timer_s * timer, void * arg);
+
+bool upoll_timer_pending(const struct upoll_timer_s * timer);
+
+// (Re)schedules the timer to expire at the deadline, rounded up to the
+// next tick. Deadlines already past expire on the next advance.
+void upoll_wheel_schedule(struct upoll_wheel_s * wheel,
+                          struct upoll_timer_s * timer,
+                          const struct timespec * deadline);
+
+void upoll_wheel_cancel(struct upoll_wheel_s * wheel, struct upoll_timer_s * timer);
+
+// Moves the wheel up to the current time, setting timers that expired
+// meanwhile aside. Only slots passed over are looked at.
+void upoll_wheel_advance(struct upoll_wheel_s * wheel,
+                         const struct timespec * current_time);
+
+// Pops a timer set aside as expired, if any. Timers popped are idle,
+// and others may be cancelled or (re)scheduled in between pops.
+struct upoll_timer_s * upoll_wheel_next_expired(struct upoll_wheel_s * wheel);
+
+// Tells when the wheel needs to advance next, infinity if it has no
+// timers. It may be earlier than the next expiry, when timers have to
+// move down a level.
+void upoll_wheel_next_deadline(const struct upoll_wheel_s * wheel,
+                               struct timespec * deadline);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -35,6 +35,24 @@
 
 #include "uccn/common/crc32.h"
 
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CRC32_PCLMUL 1
+#include <immintrin.h>
+#elif defined(__GNUC__) && defined(__aarch64__) && defined(__linux__)
+#define CRC32_ARMV8 1
+#include <arm_acle.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+typedef uint32_t (*crc32_kernel_fn)(uint32_t checksum, const uint8_t * src, size_t len);
+
+// Slicing tables, the first one being that of the bytewise logic above
+static uint32_t g_crc32_slices[8][256];
+
 static const uint32_t g_crc32_table[] =
 {
   0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f, 0xe963a535, 0x9e6495a3,
@@ -71,10 +89,9 @@ static const uint32_t g_crc32_table[] =
   0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
 };
 
-uint32_t crc32(const uint8_t * src, size_t len)
+static uint32_t crc32_bytewise(uint32_t checksum, const uint8_t * src, size_t len)
 {
   size_t i;
-  uint32_t checksum = 0;
 
   for (i = 0; i < len; i++) {
     checksum = g_crc32_table[(checksum & 0xff) ^ src[i]] ^ (checksum >> 8);
@@ -83,3 +100,192 @@ uint32_t crc32(const uint8_t * src, size_t len)
   return checksum;
 }
 
+// Eight bytes at a time, by looking up how each of them affects the
+// checksum eight, seven, ..., one byte(s) later.
+static uint32_t crc32_slice_by_8(uint32_t checksum, const uint8_t * src, size_t len)
+{
+  uint32_t lo, hi;
+
+  while (len >= 8) {
+    lo = checksum ^ ((uint32_t)src[0] | (uint32_t)src[1] << 8 |
+                     (uint32_t)src[2] << 16 | (uint32_t)src[3] << 24);
+    hi = ((uint32_t)src[4] | (uint32_t)src[5] << 8 |
+          (uint32_t)src[6] << 16 | (uint32_t)src[7] << 24);
+    checksum =
+        g_crc32_slices[7][lo & 0xff] ^ g_crc32_slices[6][(lo >> 8) & 0xff] ^
+        g_crc32_slices[5][(lo >> 16) & 0xff] ^ g_crc32_slices[4][lo >> 24] ^
+        g_crc32_slices[3][hi & 0xff] ^ g_crc32_slices[2][(hi >> 8) & 0xff] ^
+        g_crc32_slices[1][(hi >> 16) & 0xff] ^ g_crc32_slices[0][hi >> 24];
+    src += 8;
+    len -= 8;
+  }
+
+  return crc32_bytewise(checksum, src, len);
+}
+
+#if CRC32_PCLMUL
+
+// Folds 64 bytes at a time with carry-less multiplications, then reduces
+// down to 32 bits (see Intel's "Fast CRC Computation for Generic Polynomials
+// Using PCLMULQDQ Instruction"). Takes at least 64 bytes, 16 byte multiples.
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t crc32_pclmul_fold(uint32_t checksum, const uint8_t * src, size_t len)
+{
+  static const uint64_t k1k2[2] __attribute__((aligned(16))) = { 0x0154442bd4, 0x01c6e41596 };
+  static const uint64_t k3k4[2] __attribute__((aligned(16))) = { 0x01751997d0, 0x00ccaa009e };
+  static const uint64_t k5k0[2] __attribute__((aligned(16))) = { 0x0163cd6124, 0x0000000000 };
+  static const uint64_t poly[2] __attribute__((aligned(16))) = { 0x01db710641, 0x01f7011641 };
+
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+  x1 = _mm_loadu_si128((const __m128i *)(src + 0x00));
+  x2 = _mm_loadu_si128((const __m128i *)(src + 0x10));
+  x3 = _mm_loadu_si128((const __m128i *)(src + 0x20));
+  x4 = _mm_loadu_si128((const __m128i *)(src + 0x30));
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(checksum));
+  x0 = _mm_load_si128((const __m128i *)k1k2);
+  src += 64;
+  len -= 64;
+
+  while (len >= 64) {
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+    x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+    x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+    x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i *)(src + 0x00)));
+    x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i *)(src + 0x10)));
+    x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i *)(src + 0x20)));
+    x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i *)(src + 0x30)));
+    src += 64;
+    len -= 64;
+  }
+
+  // Fold 512 bits into 128 bits
+  x0 = _mm_load_si128((const __m128i *)k3k4);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+  while (len >= 16) {
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i *)src)), x5);
+    src += 16;
+    len -= 16;
+  }
+
+  // Fold 128 bits into 64 bits
+  x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+  x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+  x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, x3), x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  // Barrett reduce down to 32 bits
+  x0 = _mm_load_si128((const __m128i *)poly);
+  x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, x3), x0, 0x10);
+  x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, x3), x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  return _mm_extract_epi32(x1, 1);
+}
+
+static uint32_t crc32_pclmul(uint32_t checksum, const uint8_t * src, size_t len)
+{
+  size_t folded = len & ~(size_t)15;
+
+  if (folded >= 64) {
+    checksum = crc32_pclmul_fold(checksum, src, folded);
+    src += folded;
+    len -= folded;
+  }
+  return crc32_slice_by_8(checksum, src, len);
+}
+
+#endif  // CRC32_PCLMUL
+
+#if CRC32_ARMV8
+
+__attribute__((target("+crc")))
+static uint32_t crc32_armv8(uint32_t checksum, const uint8_t * src, size_t len)
+{
+  uint64_t word;
+
+  while (len >= 8) {
+    memcpy(&word, src, sizeof(word));
+    checksum = __crc32d(checksum, word);
+    src += 8;
+    len -= 8;
+  }
+  while (len-- > 0) {
+    checksum = __crc32b(checksum, *src++);
+  }
+  return checksum;
+}
+
+#endif  // CRC32_ARMV8
+
+static uint32_t crc32_dispatch(uint32_t checksum, const uint8_t * src, size_t len);
+
+static crc32_kernel_fn g_crc32_kernel = crc32_dispatch;
+
+static int g_crc32_state = 0;
+
+// Sets up slicing tables and picks the fastest kernel this CPU supports
+static uint32_t crc32_dispatch(uint32_t checksum, const uint8_t * src, size_t len)
+{
+  size_t i, j;
+  int expected = 0;
+  crc32_kernel_fn kernel = crc32_slice_by_8;
+
+  if (!__atomic_compare_exchange_n(&g_crc32_state, &expected, 1, false,
+                                   __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    // Being set up elsewhere, go byte at a time meanwhile
+    return crc32_bytewise(checksum, src, len);
+  }
+
+  for (i = 0; i < 256; ++i) {
+    g_crc32_slices[0][i] = g_crc32_table[i];
+  }
+  for (i = 0; i < 256; ++i) {
+    for (j = 1; j < 8; ++j) {
+      g_crc32_slices[j][i] = g_crc32_table[g_crc32_slices[j - 1][i] & 0xff] ^
+                             (g_crc32_slices[j - 1][i] >> 8);
+    }
+  }
+#if CRC32_PCLMUL
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1")) {
+    kernel = crc32_pclmul;
+  }
+#elif CRC32_ARMV8
+  if (getauxval(AT_HWCAP) & HWCAP_CRC32) {
+    kernel = crc32_armv8;
+  }
+#endif
+  __atomic_store_n(&g_crc32_kernel, kernel, __ATOMIC_RELEASE);
+  return kernel(checksum, src, len);
+}
+
+uint32_t crc32_update(uint32_t checksum, const uint8_t * src, size_t len)
+{
+  crc32_kernel_fn kernel = __atomic_load_n(&g_crc32_kernel, __ATOMIC_ACQUIRE);
+  return kernel(checksum, src, len);
+}
+
+uint32_t crc32(const uint8_t * src, size_t len)
+{
+  return crc32_update(0, src, len);
+}
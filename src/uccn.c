@@ -2,11 +2,36 @@
 
 #include <assert.h>
 
+#include <limits.h>
+#include <sched.h>
+#include <stdlib.h>
+
 #include <sys/time.h>
+#if CONFIG_UCCN_EPOLL
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#else
 #include <sys/select.h>
+#endif
 #include <sys/socket.h>
 #include <unistd.h>
 
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+#include <linux/filter.h>
+#include <poll.h>
+#endif
+
+#if CONFIG_UCCN_SHM_TRANSPORT
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "uccn/utilities/shm_ring.h"
+#endif
+
 #include "uccn/common/crc32.h"
 #include "uccn/common/logging.h"
 
@@ -20,26 +45,363 @@ static const struct timespec g_uccn_liveliness_assert_timeout = {
   .tv_nsec = 1000000L * (CONFIG_UCCN_LIVELINESS_ASSERT_TIMEOUT_MS % 1000)
 };
 
-static const struct timespec g_uccn_peer_discovery_period = {
-  .tv_sec = CONFIG_UCCN_PEER_DISCOVERY_PERIOD_MS / 1000,
-  .tv_nsec = 1000000L * (CONFIG_UCCN_PEER_DISCOVERY_PERIOD_MS % 1000),
+#if CONFIG_UCCN_FRAGMENTATION
+static const struct timespec g_uccn_reassembly_timeout = {
+  .tv_sec = CONFIG_UCCN_REASSEMBLY_TIMEOUT_MS / 1000,
+  .tv_nsec = 1000000L * (CONFIG_UCCN_REASSEMBLY_TIMEOUT_MS % 1000)
 };
+#endif
 
-static const struct timespec g_uccn_endpoint_probe_timeout = {
-  .tv_sec = CONFIG_UCCN_ENDPOINT_PROBE_TIMEOUT_MS / 1000,
-  .tv_nsec = 1000000L * (CONFIG_UCCN_ENDPOINT_PROBE_TIMEOUT_MS % 1000)
-};
+#if CONFIG_UCCN_MULTITHREADED
+// Unlocks the node whether asserts are compiled in or not
+static inline void uccn_unlock_node(struct uccn_node_s * node)
+{
+  int ret = pthread_mutex_unlock(&node->mutex);
+  assert(ret == 0);
+  (void)ret;
+}
+#endif
+
+// Returns the period shortened by a random amount, within jitter bounds
+static struct timespec uccn_jitter_discovery_period(struct uccn_node_s * node, uint32_t period_ms)
+{
+  struct timespec period;
+  uint64_t period_ns = 1000000ULL * period_ms;
+  uint32_t x = node->timers.discovery_jitter_state;
+
+  // xorshift32, good enough to scatter nodes
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  node->timers.discovery_jitter_state = x;
+
+  period_ns -= ((period_ns * CONFIG_UCCN_PEER_DISCOVERY_JITTER_PERCENT / 100) * x) >> 32;
+  period.tv_sec = period_ns / 1000000000ULL;
+  period.tv_nsec = period_ns % 1000000000ULL;
+  return period;
+}
+
+static void uccn_schedule_discovery(struct uccn_node_s * node,
+                                    const struct timespec * current_time,
+                                    bool backoff)
+{
+  static const struct timespec burst_period = {
+    .tv_sec = CONFIG_UCCN_PEER_DISCOVERY_BURST_PERIOD_MS / 1000,
+    .tv_nsec = 1000000L * (CONFIG_UCCN_PEER_DISCOVERY_BURST_PERIOD_MS % 1000)
+  };
+  struct timespec period;
+
+  if (node->timers.discovery_burst > 0) {
+    --node->timers.discovery_burst;
+    period = burst_period;
+  } else {
+    period = uccn_jitter_discovery_period(node, node->timers.discovery_period_ms);
+    if (backoff) {
+      node->timers.discovery_period_ms *= 2;
+      if (node->timers.discovery_period_ms > CONFIG_UCCN_MAX_PEER_DISCOVERY_PERIOD_MS) {
+        node->timers.discovery_period_ms = CONFIG_UCCN_MAX_PEER_DISCOVERY_PERIOD_MS;
+      }
+    }
+  }
+  node->timers.next_discovery_time = *current_time;
+  timespec_add(&node->timers.next_discovery_time, &period);
+  upoll_wheel_schedule(&node->timers.wheel, &node->timers.discovery_timer,
+                       &node->timers.next_discovery_time);
+}
+
+// Brings discovery back to its initial period, right away and in a burst
+// if asked to. Callers must hold the node lock.
+static void uccn_reset_discovery(struct uccn_node_s * node,
+                                 const struct timespec * current_time,
+                                 bool burst)
+{
+  struct timespec next_discovery_time;
+
+  node->timers.discovery_period_ms = CONFIG_UCCN_PEER_DISCOVERY_PERIOD_MS;
+  if (burst) {
+    node->timers.discovery_burst = CONFIG_UCCN_PEER_DISCOVERY_BURST;
+    node->timers.next_discovery_time = *current_time;
+  } else {
+    next_discovery_time = uccn_jitter_discovery_period(node, CONFIG_UCCN_PEER_DISCOVERY_PERIOD_MS);
+    timespec_add(&next_discovery_time, current_time);
+    if (timespec_cmp(&node->timers.next_discovery_time, &next_discovery_time) <= 0) {
+      return;
+    }
+    node->timers.next_discovery_time = next_discovery_time;
+  }
+  upoll_wheel_schedule(&node->timers.wheel, &node->timers.discovery_timer,
+                       &node->timers.next_discovery_time);
+}
+
+#if CONFIG_UCCN_DYNAMIC_CAPACITY
+
+#define UCCN_ARENA_ALIGNMENT _Alignof(max_align_t)
+
+static void * uccn_arena_take(char * arena, size_t * offset, size_t size)
+{
+  void * chunk = NULL;
+
+  *offset = (*offset + UCCN_ARENA_ALIGNMENT - 1) & ~(UCCN_ARENA_ALIGNMENT - 1);
+  if (arena != NULL) {
+    chunk = arena + *offset;
+  }
+  *offset += size;
+  return chunk;
+}
+
+// Carves node storage out of the arena, or just sizes it if there is none
+static size_t uccn_layout_node_storage(struct uccn_node_s * node,
+                                       const struct uccn_node_capacity_s * capacity,
+                                       char * arena)
+{
+  size_t i, offset = 0;
+  size_t num_hashes = capacity->max_num_resources;
+  size_t num_links = capacity->max_num_peers;
+  size_t tracker_index_capacity = hash_index_capacity(capacity->max_num_trackers);
+  size_t provider_index_capacity = hash_index_capacity(capacity->max_num_providers);
+
+  struct uccn_peer_s * peers;
+  uint32_t * peer_hashes;
+  struct uccn_content_tracker_s * trackers;
+  struct uccn_link_s * tracker_links;
+  struct hash_index_entry_s * tracker_entries;
+  struct uccn_content_provider_s * providers;
+  struct uccn_link_s * provider_links;
+  struct hash_index_entry_s * provider_entries;
+  uint32_t * link_hashes;
+
+  peers = uccn_arena_take(arena, &offset, capacity->max_num_peers * sizeof(*peers));
+  peer_hashes = uccn_arena_take(
+      arena, &offset, capacity->max_num_peers * 2 * num_hashes * sizeof(*peer_hashes));
+  trackers = uccn_arena_take(
+      arena, &offset, capacity->max_num_trackers * sizeof(*trackers));
+  tracker_links = uccn_arena_take(
+      arena, &offset, capacity->max_num_trackers * num_links * sizeof(*tracker_links));
+  tracker_entries = uccn_arena_take(
+      arena, &offset, tracker_index_capacity * sizeof(*tracker_entries));
+  providers = uccn_arena_take(
+      arena, &offset, capacity->max_num_providers * sizeof(*providers));
+  provider_links = uccn_arena_take(
+      arena, &offset, capacity->max_num_providers * num_links * sizeof(*provider_links));
+  provider_entries = uccn_arena_take(
+      arena, &offset, provider_index_capacity * sizeof(*provider_entries));
+  link_hashes = uccn_arena_take(
+      arena, &offset, (3 * num_hashes + UCCN_MAX_NUM_CAPABILITY_HASHES) * sizeof(*link_hashes));
+
+  if (arena == NULL) {
+    return offset;
+  }
+
+  memset(peers, 0, capacity->max_num_peers * sizeof(*peers));
+  for (i = 0; i < capacity->max_num_peers; ++i) {
+    peers[i].provided_content.hashes = &peer_hashes[2 * i * num_hashes];
+    peers[i].tracked_content.hashes = &peer_hashes[(2 * i + 1) * num_hashes];
+  }
+  memset(trackers, 0, capacity->max_num_trackers * sizeof(*trackers));
+  for (i = 0; i < capacity->max_num_trackers; ++i) {
+    trackers[i].endpoint.peers = &tracker_links[i * num_links];
+  }
+  memset(providers, 0, capacity->max_num_providers * sizeof(*providers));
+  for (i = 0; i < capacity->max_num_providers; ++i) {
+    providers[i].endpoint.peers = &provider_links[i * num_links];
+  }
+
+  node->peers = peers;
+  node->trackers = trackers;
+  hash_index_init(&node->tracker_index, tracker_entries, tracker_index_capacity);
+  node->providers = providers;
+  hash_index_init(&node->provider_index, provider_entries, provider_index_capacity);
+  // Advertised hashes may come along with capabilities
+  node->link_sets.advertised.hashes = &link_hashes[0];
+  node->link_sets.tracked.hashes = &link_hashes[num_hashes + UCCN_MAX_NUM_CAPABILITY_HASHES];
+  node->link_sets.provided.hashes = &link_hashes[2 * num_hashes + UCCN_MAX_NUM_CAPABILITY_HASHES];
+  return offset;
+}
+
+size_t uccn_node_arena_size(const struct uccn_node_capacity_s * capacity)
+{
+  assert(capacity != NULL);
+  return uccn_layout_node_storage(NULL, capacity, NULL);
+}
+
+#else
+
+static void uccn_layout_node_storage(struct uccn_node_s * node)
+{
+  size_t i;
+
+  node->peers = node->default_storage.peers;
+  memset(node->peers, 0, sizeof(node->default_storage.peers));
+  for (i = 0; i < node->capacity.max_num_peers; ++i) {
+    node->peers[i].provided_content.hashes =
+        &node->peers[i].default_storage[0];
+    node->peers[i].tracked_content.hashes =
+        &node->peers[i].default_storage[CONFIG_UCCN_MAX_NUM_RESOURCES];
+  }
+  node->trackers = node->default_storage.trackers;
+  memset(node->trackers, 0, sizeof(node->default_storage.trackers));
+  for (i = 0; i < CONFIG_UCCN_MAX_NUM_TRACKERS; ++i) {
+    node->trackers[i].endpoint.peers = node->trackers[i].endpoint.default_storage;
+  }
+  node->providers = node->default_storage.providers;
+  memset(node->providers, 0, sizeof(node->default_storage.providers));
+  for (i = 0; i < CONFIG_UCCN_MAX_NUM_PROVIDERS; ++i) {
+    node->providers[i].endpoint.peers = node->providers[i].endpoint.default_storage;
+  }
+  hash_index_init(&node->tracker_index, node->default_storage.tracker_index,
+                  HASH_INDEX_CAPACITY(CONFIG_UCCN_MAX_NUM_TRACKERS));
+  hash_index_init(&node->provider_index, node->default_storage.provider_index,
+                  HASH_INDEX_CAPACITY(CONFIG_UCCN_MAX_NUM_PROVIDERS));
+  // Advertised hashes may come along with capabilities
+  node->link_sets.advertised.hashes = &node->default_storage.link_sets[0];
+  node->link_sets.tracked.hashes = &node->default_storage.link_sets[
+      CONFIG_UCCN_MAX_NUM_RESOURCES + UCCN_MAX_NUM_CAPABILITY_HASHES];
+  node->link_sets.provided.hashes = &node->default_storage.link_sets[
+      2 * CONFIG_UCCN_MAX_NUM_RESOURCES + UCCN_MAX_NUM_CAPABILITY_HASHES];
+}
+
+#endif
+
+static void uccn_init_node_storage(struct uccn_node_s * node)
+{
+  size_t i;
+
+  for (i = 0; i < node->capacity.max_num_peers; ++i) {
+    node->peers[i].generation = 1;
+    node->peers[i].next_free = i + 1;
+    upoll_timer_init(&node->peers[i].liveliness.remote_timer, &node->peers[i]);
+    upoll_timer_init(&node->peers[i].liveliness.local_timer, &node->peers[i]);
+  }
+  node->peers[node->capacity.max_num_peers - 1].next_free = UCCN_NO_FREE_PEERS;
+  node->free_peers = 0;
+  node->num_peers = node->num_providers = node->num_trackers = 0;
+#if CONFIG_UCCN_FRAGMENTATION
+  memset(node->reassemblies, 0, sizeof(node->reassemblies));
+#endif
+}
+
+size_t uccn_node_footprint(const struct uccn_node_s * node)
+{
+  assert(node != NULL);
+#if CONFIG_UCCN_DYNAMIC_CAPACITY
+  return sizeof(*node) + node->arena_size;
+#else
+  return sizeof(*node);
+#endif
+}
+
+#if CONFIG_UCCN_MULTICAST_CONTENT
+static void uccn_content_group(uint32_t hash, struct sockaddr_in * group)
+{
+  memset(group, 0, sizeof(*group));
+  group->sin_family = AF_INET;
+  group->sin_port = htons(CONFIG_UCCN_PORT);
+  group->sin_addr.s_addr = htonl(
+      CONFIG_UCCN_CONTENT_GROUP_PREFIX | (hash & ((1u << CONFIG_UCCN_CONTENT_GROUP_BITS) - 1)));
+}
+#endif
+
+#if CONFIG_UCCN_SHM_TRANSPORT
+// Abstract addresses start with a NUL byte, and are not NUL terminated
+static socklen_t uccn_shm_address(const struct sockaddr_in * address,
+                                  struct sockaddr_un * shm_address)
+{
+  int length;
+  char location[INET_ADDRSTRLEN];
+
+  memset(shm_address, 0, sizeof(*shm_address));
+  shm_address->sun_family = AF_UNIX;
+  inet_ntop(AF_INET, &address->sin_addr, location, sizeof(location));
+  length = snprintf(&shm_address->sun_path[1], sizeof(shm_address->sun_path) - 1,
+                    "uccn/%s:%d", location, ntohs(address->sin_port));
+  return offsetof(struct sockaddr_un, sun_path) + 1 + length;
+}
+#endif
 
+#if CONFIG_UCCN_DYNAMIC_CAPACITY
+int uccn_node_init(struct uccn_node_s * node, const struct uccn_network_s * network,
+                   const char * name, const struct uccn_node_capacity_s * capacity,
+                   void * arena, size_t arena_size)
+#else
 int uccn_node_init(struct uccn_node_s * node, const struct uccn_network_s * network, const char * name)
+#endif
 {
   int ret, opt = 1;
+  size_t i;
   struct sockaddr_in address;
   socklen_t address_size;
+#if CONFIG_UCCN_EPOLL
+  int fds[5 + CONFIG_UCCN_SHM_TRANSPORT];
+  struct itimerspec spec;
+  struct epoll_event event;
+#endif
+#if CONFIG_UCCN_MULTICAST_DISCOVERY
+  struct ip_mreq membership;
+#endif
+#if CONFIG_UCCN_SHM_TRANSPORT
+  struct sockaddr_un shm_address;
+#endif
 
   assert(node != NULL);
   assert(name != NULL);
 
   node->socket = node->broadcast_socket = -1;
+#if CONFIG_UCCN_EPOLL
+  node->epoll_fd = node->timer_fd = -1;
+#endif
+#if CONFIG_UCCN_SHM_TRANSPORT
+  node->shm_socket = -1;
+  for (i = 0; i < CONFIG_UCCN_MAX_NUM_SHM_CHANNELS; ++i) {
+    node->shm_channels[i].ring = NULL;
+    node->shm_channels[i].attached = false;
+    node->shm_channels[i].refs = 0;
+  }
+#endif
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+  for (i = 0; i < CONFIG_UCCN_NUM_RECEIVE_WORKERS; ++i) {
+    node->receive_workers[i].socket = -1;
+    node->receive_workers[i].running = false;
+  }
+  node->deferring_worker = NULL;
+#endif
+#if CONFIG_UCCN_EXECUTOR
+  node->executor.num_threads = 0;
+#endif
+
+#if CONFIG_UCCN_DYNAMIC_CAPACITY
+  assert(capacity != NULL);
+  if (capacity->max_num_peers == 0 || capacity->max_num_peers >= UCCN_NO_FREE_PEERS) {
+    uccnerr(RUNTIME_ERR("Cannot hold %zu peers", capacity->max_num_peers));
+    return -1;
+  }
+  if (capacity->max_num_trackers > capacity->max_num_resources ||
+      capacity->max_num_providers > capacity->max_num_resources) {
+    uccnerr(RUNTIME_ERR("Cannot have more endpoints than resources"));
+    return -1;
+  }
+  node->capacity = *capacity;
+  node->arena_size = uccn_node_arena_size(capacity);
+  node->owns_arena = (arena == NULL);
+  if (node->owns_arena) {
+    arena = malloc(node->arena_size);
+    if (arena == NULL) {
+      uccnerr(RUNTIME_ERR("Failed to allocate %zu bytes for node arena", node->arena_size));
+      return -1;
+    }
+  } else if (arena_size < node->arena_size) {
+    uccnerr(RUNTIME_ERR("Node arena too small, need %zu bytes", node->arena_size));
+    return -1;
+  } else if ((uintptr_t)arena % UCCN_ARENA_ALIGNMENT != 0) {
+    uccnerr(RUNTIME_ERR("Node arena must be %zu bytes aligned",
+                        (size_t)UCCN_ARENA_ALIGNMENT));
+    return -1;
+  }
+  node->arena = arena;
+  uccn_layout_node_storage(node, capacity, arena);
+#else
+  node->capacity = (struct uccn_node_capacity_s)UCCN_NODE_CAPACITY_DEFAULT;
+  uccn_layout_node_storage(node);
+#endif
 
   node->socket = socket(PF_INET, SOCK_DGRAM, 0);
   if (node->socket < 0) {
@@ -52,6 +414,15 @@ int uccn_node_init(struct uccn_node_s * node, const struct uccn_network_s * netw
   address.sin_port = 0;
   address.sin_addr = network->inetaddr;
 
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+  // Receive workers bind their own sockets to the same port later on
+  ret = setsockopt(node->socket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to reuse port for socket"));
+    goto fail;
+  }
+#endif
+
   ret = bind(node->socket, (struct sockaddr *)&address, sizeof(address));
   if (ret < 0) {
     uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to bind node socket"));
@@ -66,6 +437,41 @@ int uccn_node_init(struct uccn_node_s * node, const struct uccn_network_s * netw
   }
 #endif
 
+#if CONFIG_UCCN_MULTICAST_CONTENT || CONFIG_UCCN_MULTICAST_DISCOVERY
+  // Multicast goes out the network interface, and back to nodes on this
+  // same host
+  ret = setsockopt(node->socket, IPPROTO_IP, IP_MULTICAST_IF,
+                   &network->inetaddr, sizeof(network->inetaddr));
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to set multicast interface for socket"));
+    goto fail;
+  }
+#if CONFIG_UCCN_MULTICAST_DISCOVERY
+  opt = CONFIG_UCCN_DISCOVERY_TTL;
+#else
+  opt = CONFIG_UCCN_CONTENT_GROUP_TTL;
+#endif
+  ret = setsockopt(node->socket, IPPROTO_IP, IP_MULTICAST_TTL, &opt, sizeof(opt));
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to set multicast TTL for socket"));
+    goto fail;
+  }
+  opt = 1;
+  ret = setsockopt(node->socket, IPPROTO_IP, IP_MULTICAST_LOOP, &opt, sizeof(opt));
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to loop multicast back for socket"));
+    goto fail;
+  }
+#endif
+
+#if CONFIG_UCCN_FRAGMENTATION && CONFIG_UCCN_SOCKET_RECV_BUFFER_SIZE > 0
+  opt = CONFIG_UCCN_SOCKET_RECV_BUFFER_SIZE;
+  if (setsockopt(node->socket, SOL_SOCKET, SO_RCVBUF, &opt, sizeof(opt)) < 0) {
+    uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to resize socket receive buffer"));
+  }
+  opt = 1;
+#endif
+
   address_size = sizeof(node->address);
   if ((ret = getsockname(node->socket, (struct sockaddr *)&node->address, &address_size)) < 0) {
     uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get socket address"));
@@ -104,10 +510,63 @@ int uccn_node_init(struct uccn_node_s * node, const struct uccn_network_s * netw
   }
 #endif
 
+#if CONFIG_UCCN_MULTICAST_DISCOVERY
+  membership.imr_multiaddr.s_addr = htonl(CONFIG_UCCN_DISCOVERY_GROUP);
+  membership.imr_interface = network->inetaddr;
+  ret = setsockopt(node->broadcast_socket, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+                   &membership, sizeof(membership));
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to join discovery group"));
+    goto fail;
+  }
+#endif
+
+#if (CONFIG_UCCN_MULTICAST_CONTENT || CONFIG_UCCN_MULTICAST_DISCOVERY) && \
+    defined(IP_MULTICAST_ALL)
+  // Only take multicast for groups this node joined, not those of every
+  // other node on the host
+  opt = 0;
+  ret = setsockopt(node->broadcast_socket, IPPROTO_IP, IP_MULTICAST_ALL, &opt, sizeof(opt));
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to filter multicast for socket"));
+    goto fail;
+  }
+  opt = 1;
+#endif
+
   node->broadcast_address.sin_family = AF_INET;
   node->broadcast_address.sin_port = htons(CONFIG_UCCN_PORT);
+#if CONFIG_UCCN_MULTICAST_DISCOVERY
+  node->broadcast_address.sin_addr.s_addr = htonl(CONFIG_UCCN_DISCOVERY_GROUP);
+#else
   node->broadcast_address.sin_addr.s_addr =
       network->inetaddr.s_addr | ~(network->netmask.s_addr);
+#endif
+
+#if CONFIG_UCCN_SHM_TRANSPORT
+  node->shm_socket = socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (node->shm_socket < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to create node ring socket"));
+    ret = node->shm_socket;
+    goto fail;
+  }
+
+  // Named after the node address, for peers to find it
+  ret = bind(node->shm_socket, (struct sockaddr *)&shm_address,
+             uccn_shm_address(&node->address, &shm_address));
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to bind node ring socket"));
+    goto fail;
+  }
+
+  // Offers come with their sender credentials, to turn strangers down
+  opt = 1;
+  ret = setsockopt(node->shm_socket, SOL_SOCKET, SO_PASSCRED, &opt, sizeof(opt));
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to ask for ring offer credentials"));
+    goto fail;
+  }
+#endif
 
   strncpy(node->name, name, CONFIG_UCCN_MAX_NODE_NAME_SIZE);
 
@@ -117,14 +576,25 @@ int uccn_node_init(struct uccn_node_s * node, const struct uccn_network_s * netw
            sizeof(node->location) - strlen(node->location),
            ":%d", ntohs(address.sin_port));
 
-  stack_buffer_init(&node->incoming_buffer, default_storage);
+  for (i = 0; i < CONFIG_UCCN_RECV_BATCH_SIZE; ++i) {
+    stack_buffer_init(&node->incoming_buffers[i], default_storage);
+  }
   stack_buffer_init(&node->outgoing_buffer, default_storage);
-  stack_buffer_init(&node->content_buffer, default_storage);
+  for (i = 0; i < CONFIG_UCCN_NUM_POST_BUFFERS; ++i) {
+    stack_buffer_init(&node->post_buffers[i], default_storage);
+  }
+  node->post_buffers_in_use = 0;
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  node->num_checksum_mismatches = 0;
+#endif
+#if CONFIG_UCCN_NUM_LOAN_BUFFERS > 0
+  for (i = 0; i < CONFIG_UCCN_NUM_LOAN_BUFFERS; ++i) {
+    stack_buffer_init(&node->loan_buffers[i], default_storage);
+  }
+  node->loan_buffers_in_use = 0;
+#endif
 
-  memset(node->peers, 0, sizeof(node->peers));
-  memset(node->trackers, 0, sizeof(node->trackers));
-  memset(node->providers, 0, sizeof(node->providers));
-  node->num_peers = node->num_providers = node->num_trackers = 0;
+  uccn_init_node_storage(node);
 
 #if CONFIG_UCCN_MULTITHREADED
   ret = pthread_mutex_init(&node->mutex, NULL);
@@ -132,22 +602,156 @@ int uccn_node_init(struct uccn_node_s * node, const struct uccn_network_s * netw
     uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to initialize node mutex"));
     goto fail;
   }
+  node->num_post_waiters = 0;
+  if ((ret = pthread_mutex_init(&node->post_buffers_mutex, NULL)) != 0 ||
+      (ret = pthread_cond_init(&node->post_buffer_released, NULL)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to initialize node post buffers"));
+    ret = -1;
+    goto fail;
+  }
+#if CONFIG_UCCN_SHM_TRANSPORT
+  for (i = 0; i < CONFIG_UCCN_MAX_NUM_SHM_CHANNELS; ++i) {
+    if ((ret = pthread_mutex_init(&node->shm_channels[i].producer_mutex, NULL)) != 0) {
+      errno = ret;
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to initialize node ring mutex"));
+      ret = -1;
+      goto fail;
+    }
+  }
+#endif
 #endif
 
   ret = eventfd_init(&node->stop_event);
   if (ret < 0) {
-    uccndbg(BACKTRACE_FROM(__LINE__ - 2));
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to initialize node stop event"));
+    goto fail;
+  }
+
+  ret = eventfd_init(&node->wakeup_event);
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to initialize node wakeup event"));
+    goto fail;
+  }
+
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+  ret = eventfd_init(&node->workers_stop_event);
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to initialize node workers stop event"));
+    goto fail;
+  }
+#endif
+
+  memset(node->watches, 0, sizeof(node->watches));
+  node->num_watches = 0;
+
+  if ((ret = clock_gettime(CLOCK_MONOTONIC, &node->timers.next_discovery_time)) != 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
+    goto fail;
+  }
+  upoll_wheel_init(&node->timers.wheel, &node->timers.next_discovery_time,
+                   1000000L * CONFIG_UCCN_TIMER_RESOLUTION_MS);
+  upoll_timer_init(&node->timers.discovery_timer, node);
+  upoll_wheel_schedule(&node->timers.wheel, &node->timers.discovery_timer,
+                       &node->timers.next_discovery_time);
+  node->timers.discovery_period_ms = CONFIG_UCCN_PEER_DISCOVERY_PERIOD_MS;
+  node->timers.discovery_burst = CONFIG_UCCN_PEER_DISCOVERY_BURST;
+  // Seeded apart for nodes sharing a host or started at once
+  node->timers.discovery_jitter_state =
+      (ntohl(node->address.sin_addr.s_addr) ^ ((uint32_t)ntohs(node->address.sin_port) << 16) ^
+       (uint32_t)node->timers.next_discovery_time.tv_nsec) | 1;
+
+#if CONFIG_UCCN_EPOLL
+  node->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (node->epoll_fd < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to create node epoll instance"));
+    ret = node->epoll_fd;
+    goto fail;
+  }
+
+  node->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (node->timer_fd < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to create node timer"));
+    ret = node->timer_fd;
+    goto fail;
+  }
+  // Arm the timer right away so that the node reports work to do before
+  // its first spin, even when it is being watched from another loop
+  TIMESPEC_ZERO_INIT(&spec.it_interval);
+  spec.it_value = node->timers.next_discovery_time;
+  ret = timerfd_settime(node->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to arm node timer"));
+    goto fail;
+  }
+  node->timer_deadline = spec.it_value;
+
+  fds[0] = node->socket;
+  fds[1] = node->broadcast_socket;
+  fds[2] = eventfd_fileno(&node->stop_event);
+  fds[3] = eventfd_fileno(&node->wakeup_event);
+  fds[4] = node->timer_fd;
+#if CONFIG_UCCN_SHM_TRANSPORT
+  fds[5] = node->shm_socket;
+#endif
+  for (i = 0; i < sizeof(fds) / sizeof(fds[0]); ++i) {
+    event.events = EPOLLIN;
+    event.data.fd = fds[i];
+    ret = epoll_ctl(node->epoll_fd, EPOLL_CTL_ADD, fds[i], &event);
+    if (ret < 0) {
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to register node file descriptor"));
+      goto fail;
+    }
+  }
+#endif
+
+#if CONFIG_UCCN_EXECUTOR
+  if ((ret = uccn_start_executor(node)) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    goto fail;
+  }
+#endif
+
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+  if ((ret = uccn_start_receive_workers(node)) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
     goto fail;
   }
+#endif
 
+  uccndbg("Node '%s' takes up %zu bytes", node->name, uccn_node_footprint(node));
   return 0;
 fail:
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+  uccn_stop_receive_workers(node);
+#endif
+#if CONFIG_UCCN_EXECUTOR
+  uccn_stop_executor(node);
+#endif
+#if CONFIG_UCCN_EPOLL
+  if (node->epoll_fd >= 0 && close(node->epoll_fd) < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to close node epoll instance"));
+  }
+  if (node->timer_fd >= 0 && close(node->timer_fd) < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to close node timer"));
+  }
+#endif
   if (node->socket >= 0 && close(node->socket) < 0) {
     uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to close node socket"));
   }
   if (node->broadcast_socket >= 0 && close(node->broadcast_socket) < 0) {
     uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to close node broadcast socket"));
   }
+#if CONFIG_UCCN_SHM_TRANSPORT
+  if (node->shm_socket >= 0 && close(node->shm_socket) < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to close node ring socket"));
+  }
+#endif
+#if CONFIG_UCCN_DYNAMIC_CAPACITY
+  if (node->owns_arena) {
+    free(node->arena);
+  }
+#endif
   return ret;
 }
 
@@ -157,7 +761,12 @@ uccn_track(struct uccn_node_s * node,
            const uccn_content_track_fn track, void * arg)
 {
   size_t i;
+#if CONFIG_UCCN_MULTICAST_CONTENT
+  struct sockaddr_in group;
+  struct ip_mreq membership;
+#endif
 
+  struct timespec current_time;
   struct uccn_content_endpoint_s * endpoint;
   struct uccn_content_tracker_s * tracker;
 
@@ -167,8 +776,8 @@ uccn_track(struct uccn_node_s * node,
     return NULL;
   }
 #endif
-  for (i = 0; i < node->num_trackers; ++i) {
-    tracker = &node->trackers[i];
+  tracker = hash_index_find(&node->tracker_index, resource->hash);
+  if (tracker != NULL) {
     endpoint = (struct uccn_content_endpoint_s *)tracker;
     if (endpoint->resource == resource) {
       uccndbg("Updating existing tracker for '%s' resource", resource->path);
@@ -176,23 +785,93 @@ uccn_track(struct uccn_node_s * node,
       tracker->arg = arg;
       goto leave_uccn_track;
     }
-    if (endpoint->resource->hash == resource->hash) {
-      uccnerr(RUNTIME_ERR("'%s' resource hash collides with '%s's",
-                          resource->path, endpoint->resource->path));
-      tracker = NULL;
-      goto leave;
-    }
+    uccnerr(RUNTIME_ERR("'%s' resource hash collides with '%s's",
+                        resource->path, endpoint->resource->path));
+    tracker = NULL;
+    goto leave_uccn_track;
+  }
+  if (node->num_trackers >= node->capacity.max_num_trackers) {
+    uccnerr(RUNTIME_ERR("Too many trackers, cannot track '%s'", resource->path));
+    goto leave_uccn_track;
   }
   tracker = &node->trackers[node->num_trackers++];
   endpoint = (struct uccn_content_endpoint_s *)tracker;
   endpoint->node = node;
   endpoint->resource = resource;
   endpoint->num_peers = 0;
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  endpoint->num_checked_peers = 0;
+#endif
   tracker->track = track;
   tracker->arg = arg;
+#if CONFIG_UCCN_EXECUTOR
+  if (uccn_init_content_queue(&tracker->queue) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    --node->num_trackers;
+    tracker = NULL;
+    goto leave_uccn_track;
+  }
+#endif
+  if (uccn_init_content_pool(&tracker->pool, resource->content_size) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+#if CONFIG_UCCN_EXECUTOR
+    uccn_fini_content_queue(&tracker->queue);
+#endif
+    --node->num_trackers;
+    tracker = NULL;
+    goto leave_uccn_track;
+  }
+#if CONFIG_UCCN_MULTICAST_CONTENT
+  uccn_content_group(resource->hash, &group);
+  membership.imr_multiaddr = group.sin_addr;
+  membership.imr_interface = node->address.sin_addr;
+  // Resources may share a group, which is then joined already
+  if (setsockopt(node->broadcast_socket, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+                 &membership, sizeof(membership)) < 0 && errno != EADDRINUSE) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to join '%s' resource group",
+                            resource->path));
+#if CONFIG_UCCN_EXECUTOR
+    uccn_fini_content_queue(&tracker->queue);
+#endif
+    uccn_fini_content_pool(&tracker->pool);
+    --node->num_trackers;
+    tracker = NULL;
+    goto leave_uccn_track;
+  }
+#endif
+  if (hash_index_insert(&node->tracker_index,
+                        resource->hash, tracker) < 0) {
+    uccnerr(RUNTIME_ERR("Failed to index '%s' tracker", resource->path));
+#if CONFIG_UCCN_EXECUTOR
+    uccn_fini_content_queue(&tracker->queue);
+#endif
+    uccn_fini_content_pool(&tracker->pool);
+    --node->num_trackers;
+    tracker = NULL;
+    goto leave_uccn_track;
+  }
+  // Link to peers already known to provide this resource
+  for (i = 0; i < node->capacity.max_num_peers; ++i) {
+    if (node->peers[i].in_use &&
+        uccn_hash_set_contains(&node->peers[i].provided_content, resource->hash)) {
+      if (uccn_link(endpoint, &node->peers[i]) < 0) {
+        uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+        break;
+      }
+    }
+  }
+  // Look for providers right away, even if the node is idle waiting
+  if (clock_gettime(CLOCK_MONOTONIC, &current_time) < 0) {
+    uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
+  } else {
+    uccn_reset_discovery(node, &current_time, true);
+    if (uccn_wakeup(node) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    }
+  }
  leave_uccn_track:
 #if CONFIG_UCCN_MULTITHREADED
-  assert(pthread_mutex_unlock(&node->mutex) == 0);
+  uccn_unlock_node(node);
 #endif
   return tracker;
 }
@@ -210,116 +889,698 @@ uccn_advertise(struct uccn_node_s * node, const struct uccn_resource_s * resourc
     return NULL;
   }
 #endif
-  for (i = 0; i < node->num_providers; ++i) {
-    provider = &node->providers[i];
+  provider = hash_index_find(&node->provider_index, resource->hash);
+  if (provider != NULL) {
     endpoint = (struct uccn_content_endpoint_s *)provider;
-
     if (endpoint->resource == resource) {
       uccndbg("Provider for '%s' resource already registered", resource->path);
       goto leave_uccn_advertise;
     }
-    if (endpoint->resource->hash == resource->hash) {
-      uccnerr(RUNTIME_ERR("'%s' resource hash collides with '%s's",
-                          resource->path, endpoint->resource->path));
-      return NULL;
-    }
+    uccnerr(RUNTIME_ERR("'%s' resource hash collides with '%s's",
+                        resource->path, endpoint->resource->path));
+    provider = NULL;
+    goto leave_uccn_advertise;
+  }
+  if (node->num_providers >= node->capacity.max_num_providers) {
+    uccnerr(RUNTIME_ERR("Too many providers, cannot advertise '%s'", resource->path));
+    goto leave_uccn_advertise;
   }
   provider = &node->providers[node->num_providers++];
   endpoint = (struct uccn_content_endpoint_s *)provider;
   endpoint->node = node;
   endpoint->resource = resource;
   endpoint->num_peers = 0;
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  endpoint->num_checked_peers = 0;
+#endif
+  provider->last_post_time = 0;
+  if (uccn_init_content_pool(&provider->pool, resource->content_size) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    --node->num_providers;
+    provider = NULL;
+    goto leave_uccn_advertise;
+  }
+  if (hash_index_insert(&node->provider_index,
+                        resource->hash, provider) < 0) {
+    uccnerr(RUNTIME_ERR("Failed to index '%s' provider", resource->path));
+    uccn_fini_content_pool(&provider->pool);
+    --node->num_providers;
+    provider = NULL;
+    goto leave_uccn_advertise;
+  }
+  // Link to peers already known to track this resource
+  for (i = 0; i < node->capacity.max_num_peers; ++i) {
+    if (node->peers[i].in_use &&
+        uccn_hash_set_contains(&node->peers[i].tracked_content, resource->hash)) {
+      if (uccn_link(endpoint, &node->peers[i]) < 0) {
+        uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+        break;
+      }
+    }
+  }
  leave_uccn_advertise:
 #if CONFIG_UCCN_MULTITHREADED
-  assert(pthread_mutex_unlock(&node->mutex) == 0);
+  uccn_unlock_node(node);
 #endif
   return provider;
 }
 
-int uccn_post(struct uccn_content_provider_s * provider, const void * content)
+static size_t uccn_write_content_group_header(char * header, uint32_t hash)
 {
-  int ret;
-  size_t i;
-  ssize_t nbytes;
+  // {UCCN_CONTENT_GROUP: {hash: ...}}, using fixed width encodings
+  mpack_store_u8(&header[0], 0x81);  // fixmap, 1 entry
+  mpack_store_u8(&header[1], 0xcc);  // uint 8
+  mpack_store_u8(&header[2], UCCN_CONTENT_GROUP);
+  mpack_store_u8(&header[3], 0x81);  // fixmap, 1 entry
+  mpack_store_u8(&header[4], 0xce);  // uint 32
+  mpack_store_u32(&header[5], hash);
+  return 9;
+}
 
-  struct buffer_head_s * blob;
-  struct buffer_head_s * packet;
+size_t uccn_write_content_header(char * header, uint32_t hash,
+                                 const uint32_t * checksum,
+                                 uint32_t length)
+{
+  size_t offset = uccn_write_content_group_header(header, hash);
+
+  if (checksum != NULL) {
+    // [checksum, content] instead of content alone
+    mpack_store_u8(&header[offset], 0x92);  // fixarray, 2 entries
+    mpack_store_u8(&header[offset + 1], 0xce);  // uint 32
+    mpack_store_u32(&header[offset + 2], *checksum);
+    offset += 6;
+  }
+  mpack_store_u8(&header[offset], 0xc6);  // bin 32
+  mpack_store_u32(&header[offset + 1], length);
+  assert(offset + 5 == (checksum != NULL ?
+                        UCCN_CHECKED_CONTENT_HEADER_SIZE :
+                        UCCN_CONTENT_HEADER_SIZE));
+  return offset + 5;
+}
 
-  mpack_error_t err;
-  mpack_writer_t writer;
+#if CONFIG_UCCN_FRAGMENTATION
+size_t uccn_write_fragment_header(char * header, uint32_t hash,
+                                  uint32_t sequence, uint16_t index,
+                                  uint16_t num_fragments,
+                                  uint32_t total_length,
+                                  const uint32_t * checksum,
+                                  uint32_t length)
+{
+  size_t num_fields = UCCN_NUM_FRAGMENT_FIELDS;
+  size_t offset = uccn_write_content_group_header(header, hash);
 
-  struct uccn_peer_s * peer;
+  if (checksum != NULL) {
+    // Goes right before the fragment itself
+    ++num_fields;
+  }
+  mpack_store_u8(&header[offset], 0x90 | num_fields);  // fixarray
+  mpack_store_u8(&header[offset + 1], 0xce);  // uint 32
+  mpack_store_u32(&header[offset + 2], sequence);
+  mpack_store_u8(&header[offset + 6], 0xcd);  // uint 16
+  mpack_store_u16(&header[offset + 7], index);
+  mpack_store_u8(&header[offset + 9], 0xcd);  // uint 16
+  mpack_store_u16(&header[offset + 10], num_fragments);
+  mpack_store_u8(&header[offset + 12], 0xce);  // uint 32
+  mpack_store_u32(&header[offset + 13], total_length);
+  if (checksum != NULL) {
+    mpack_store_u8(&header[offset + 17], 0xce);  // uint 32
+    mpack_store_u32(&header[offset + 18], *checksum);
+    offset += 5;
+  }
+  mpack_store_u8(&header[offset + 17], 0xc6);  // bin 32
+  mpack_store_u32(&header[offset + 18], length);
+  assert(offset + 22 == (checksum != NULL ?
+                         UCCN_CHECKED_FRAGMENT_HEADER_SIZE :
+                         UCCN_FRAGMENT_HEADER_SIZE));
+  return offset + 22;
+}
+#endif
+
+int uccn_fanout(struct uccn_node_s * node,
+                const struct iovec * iov,
+                size_t iovcnt,
+                const struct sockaddr_in * addresses,
+                size_t num_addresses)
+{
+  size_t i;
+  size_t num_sent = 0;
+  char location[INET_ADDRSTRLEN];
+#if CONFIG_UCCN_BATCHED_IO
+  int ret;
+  struct mmsghdr msgs[CONFIG_UCCN_SEND_BATCH_SIZE];
+#else
+  ssize_t nbytes;
+  struct msghdr msg;
+#endif
+
+  assert(node != NULL);
+  assert(iov != NULL);
+  assert(num_addresses <= CONFIG_UCCN_SEND_BATCH_SIZE);
+
+#if CONFIG_UCCN_BATCHED_IO
+  for (i = 0; i < num_addresses; ++i) {
+    memset(&msgs[i], 0, sizeof(msgs[i]));
+    msgs[i].msg_hdr.msg_name = (struct sockaddr_in *)&addresses[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+    msgs[i].msg_hdr.msg_iov = (struct iovec *)iov;
+    msgs[i].msg_hdr.msg_iovlen = iovcnt;
+  }
+
+  // sendmmsg() stops at the first failing message, so skip it and resume
+  for (i = 0; i < num_addresses; ) {
+    ret = sendmmsg(node->socket, &msgs[i], num_addresses - i, 0);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      inet_ntop(AF_INET, &addresses[i].sin_addr, location, sizeof(location));
+      uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 6, "Failed to send packet to %s:%d",
+                               location, ntohs(addresses[i].sin_port)));
+      ++i;
+      continue;
+    }
+    num_sent += ret;
+    i += ret;
+  }
+#else
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = (struct iovec *)iov;
+  msg.msg_iovlen = iovcnt;
+  for (i = 0; i < num_addresses; ++i) {
+    msg.msg_name = (struct sockaddr_in *)&addresses[i];
+    msg.msg_namelen = sizeof(addresses[i]);
+    nbytes = sendmsg(node->socket, &msg, 0);
+    if (nbytes < 0) {
+      inet_ntop(AF_INET, &addresses[i].sin_addr, location, sizeof(location));
+      uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to send packet to %s:%d",
+                               location, ntohs(addresses[i].sin_port)));
+      continue;
+    }
+    ++num_sent;
+  }
+#endif
+
+  return num_sent;
+}
+
+int uccn_fanout_endpoint(struct uccn_content_endpoint_s * endpoint,
+                         const struct iovec * iov,
+                         const struct iovec * checked_iov,
+                         size_t iovcnt)
+{
+  int ret;
+  size_t i, offset, num_peers, num_links, num_addresses, num_checked, num_sent;
+#if CONFIG_UCCN_MULTICAST_CONTENT
+  size_t num_grouped = 0;
+  struct sockaddr_in group;
+#endif
+  struct uccn_link_s links[CONFIG_UCCN_SEND_BATCH_SIZE];
+  struct sockaddr_in addresses[CONFIG_UCCN_SEND_BATCH_SIZE];
+  struct sockaddr_in checked_addresses[CONFIG_UCCN_SEND_BATCH_SIZE];
+
+  // Fan out in batches, peer capacity may be well above a batch
+  offset = num_sent = 0;
+  do {
+    num_links = uccn_read_links(endpoint, offset, links,
+                                CONFIG_UCCN_SEND_BATCH_SIZE, &num_peers);
+    if (num_links == 0) {
+      break;
+    }
+    offset += num_links;
+    num_addresses = num_checked = 0;
+    for (i = 0; i < num_links; ++i) {
+#if CONFIG_UCCN_SHM_TRANSPORT
+      // Peers on the same host take the ring if it has room, UDP otherwise
+      if (links[i].channel != NULL &&
+          uccn_shm_send(links[i].channel, links[i].handle,
+                        endpoint->resource->hash, iov, iovcnt) > 0) {
+        ++num_sent;
+        continue;
+      }
+#endif
+#if CONFIG_UCCN_MULTICAST_CONTENT
+      if (links[i].multicast) {
+        ++num_grouped;
+        continue;
+      }
+#endif
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+      if (checked_iov != NULL && links[i].checksums) {
+        checked_addresses[num_checked++] = links[i].address;
+        continue;
+      }
+#endif
+      addresses[num_addresses++] = links[i].address;
+    }
+    if (num_checked > 0) {
+      ret = uccn_fanout(endpoint->node, checked_iov, iovcnt,
+                        checked_addresses, num_checked);
+      if (ret < 0) {
+        uccndbg(BACKTRACE_FROM(__LINE__ - 2));
+        return ret;
+      }
+      num_sent += ret;
+    }
+    if (num_addresses > 0) {
+      if ((ret = uccn_fanout(endpoint->node, iov, iovcnt, addresses, num_addresses)) < 0) {
+        uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+        return ret;
+      }
+      num_sent += ret;
+    }
+  } while (offset < num_peers);
+
+#if CONFIG_UCCN_MULTICAST_CONTENT
+  if (num_grouped > 0) {
+    // Content goes to groups unchecked, as not every member may check it
+    uccn_content_group(endpoint->resource->hash, &group);
+    if ((ret = uccn_fanout(endpoint->node, iov, iovcnt, &group, 1)) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+      return ret;
+    }
+    if (ret > 0) {
+      num_sent += num_grouped;
+    }
+  }
+#endif
+  return num_sent;
+}
+
+#if CONFIG_UCCN_FRAGMENTATION
+int uccn_post_fragments(struct uccn_content_provider_s * provider,
+                        struct buffer_head_s * blob)
+{
+  int ret = 0;
+  uint32_t sequence;
+  size_t index, num_fragments;
+  size_t offset, length, fragment_size;
+
+  struct iovec iov[2];
+  char header[UCCN_FRAGMENT_HEADER_SIZE];
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  uint32_t checksum;
+  struct iovec checked_iov[2];
+  char checked_header[UCCN_CHECKED_FRAGMENT_HEADER_SIZE];
+#endif
+  const struct iovec * checked = NULL;
 
   struct uccn_content_endpoint_s * endpoint =
       (struct uccn_content_endpoint_s *)provider;
-  struct uccn_node_s * node = endpoint->node;
   const struct uccn_resource_s * resource = endpoint->resource;
 
-  ret = 0;
-  if (endpoint->num_peers > 0) {
-#if CONFIG_UCCN_MULTITHREADED
-    ret = pthread_mutex_lock(&node->mutex);
-    if (ret < 0) {
-      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node mutex"));
+  num_fragments = (blob->length + CONFIG_UCCN_MAX_FRAGMENT_SIZE - 1) / CONFIG_UCCN_MAX_FRAGMENT_SIZE;
+  if (num_fragments > UINT16_MAX || blob->length > CONFIG_UCCN_MAX_REASSEMBLY_SIZE) {
+    uccnerr(RUNTIME_ERR("Content for '%s' resource is too large (%zu bytes)",
+                        resource->path, blob->length));
+    return -1;
+  }
+  // Spread content evenly, so that peers can infer offsets from indices
+  fragment_size = (blob->length + num_fragments - 1) / num_fragments;
+  sequence = __atomic_fetch_add(&provider->sequence, 1, __ATOMIC_RELAXED);
+
+  // Fragments are gathered straight from content, only headers are built
+  iov[0].iov_base = header;
+  for (index = 0; index < num_fragments; ++index) {
+    offset = index * fragment_size;
+    length = blob->length - offset;
+    if (length > fragment_size) {
+      length = fragment_size;
+    }
+    iov[0].iov_len = uccn_write_fragment_header(
+        header, resource->hash, sequence, index,
+        num_fragments, blob->length, NULL, length);
+    iov[1].iov_base = (char *)blob->data + offset;
+    iov[1].iov_len = length;
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+    if (__atomic_load_n(&endpoint->num_checked_peers, __ATOMIC_RELAXED) > 0) {
+      checksum = crc32(iov[1].iov_base, length);
+      checked_iov[0].iov_base = checked_header;
+      checked_iov[0].iov_len = uccn_write_fragment_header(
+          checked_header, resource->hash, sequence, index,
+          num_fragments, blob->length, &checksum, length);
+      checked_iov[1] = iov[1];
+      checked = checked_iov;
+    }
+#endif
+
+    if ((ret = uccn_fanout_endpoint(endpoint, iov, checked, 2)) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
       return ret;
     }
+  }
+  return ret;
+}
 #endif
-    packet = (struct buffer_head_s *)&node->outgoing_buffer;
-    mpack_writer_init(&writer, packet->data, packet->size);
-    {
-      mpack_start_map(&writer, 1);
-      {
-        mpack_write_u8(&writer, UCCN_CONTENT_GROUP);
-        mpack_start_map(&writer, 1);
-        {
-          mpack_write_u32(&writer, resource->hash);
-          blob = (struct buffer_head_s *)&node->content_buffer;
-          if ((ret = resource->pack(resource, content, &blob)) < 0) {
-            uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+
+int uccn_init_content_pool(struct uccn_content_pool_s * pool, size_t content_size)
+{
+  memset(pool, 0, sizeof(*pool));
+  if (content_size == 0) {
+    return 0;
+  }
+  pool->stride = (content_size + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+  pool->objects = calloc(CONFIG_UCCN_CONTENT_POOL_SIZE, pool->stride);
+  if (pool->objects == NULL) {
+    uccnerr(RUNTIME_ERR("Failed to allocate %zu bytes for content pool",
+                        CONFIG_UCCN_CONTENT_POOL_SIZE * pool->stride));
+    return -1;
+  }
+  return 0;
+}
+
+void uccn_fini_content_pool(struct uccn_content_pool_s * pool)
+{
+  free(pool->objects);
+  memset(pool, 0, sizeof(*pool));
+}
+
+// Claims one out of n slots tracked in a bitmask, returns -1 if none is free
+static int uccn_claim_slot(unsigned int * in_use, size_t n)
+{
+  size_t i;
+  unsigned int bit;
+
+  for (i = 0; i < n; ++i) {
+    bit = 1u << i;
+    if (!(__atomic_fetch_or(in_use, bit, __ATOMIC_ACQUIRE) & bit)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void uccn_free_slot(unsigned int * in_use, size_t i)
+{
+  __atomic_fetch_and(in_use, ~(1u << i), __ATOMIC_RELEASE);
+}
+
+static void * uccn_lend_content(struct uccn_content_pool_s * pool)
+{
+  int i = uccn_claim_slot(&pool->in_use, CONFIG_UCCN_CONTENT_POOL_SIZE);
+  return i < 0 ? NULL : pool->objects + i * pool->stride;
+}
+
+static size_t uccn_content_index(struct uccn_content_pool_s * pool, void * content)
+{
+  size_t i = ((char *)content - pool->objects) / pool->stride;
+
+  assert(pool->objects != NULL);
+  assert((char *)content >= pool->objects && i < CONFIG_UCCN_CONTENT_POOL_SIZE);
+  return i;
+}
+
+void uccn_keep_content(struct uccn_content_tracker_s * tracker, void * content)
+{
+  struct uccn_content_pool_s * pool = &tracker->pool;
+  __atomic_fetch_or(&pool->kept, 1u << uccn_content_index(pool, content), __ATOMIC_RELAXED);
+}
+
+static void uccn_give_back_content(struct uccn_content_pool_s * pool, void * content)
+{
+  uccn_free_slot(&pool->in_use, uccn_content_index(pool, content));
+}
+
+void uccn_return_content(struct uccn_content_tracker_s * tracker, void * content)
+{
+  uccn_give_back_content(&tracker->pool, content);
+}
+
+// Returns -1 if there is none to take, which only happens when posts
+// are nested in single threaded builds
+static int uccn_acquire_post_buffer(struct uccn_node_s * node)
+{
+  int i;
 #if CONFIG_UCCN_MULTITHREADED
-            assert(pthread_mutex_unlock(&node->mutex) == 0);
+  int ret;
 #endif
-            return ret;
-          }
-          mpack_write_bin(&writer, blob->data, blob->length);
-        }
-        mpack_finish_map(&writer);
-      }
-      mpack_finish_map(&writer);
-    }
-    packet->length = mpack_writer_buffer_used(&writer);
-    if ((err = mpack_writer_destroy(&writer)) != mpack_ok) {
-      uccnerr(RUNTIME_ERR("Failed to build '%s' content packet: %s",
-                          resource->path, mpack_error_to_string(err)));
+
+  if ((i = uccn_claim_slot(&node->post_buffers_in_use, CONFIG_UCCN_NUM_POST_BUFFERS)) >= 0) {
+    return i;
+  }
 #if CONFIG_UCCN_MULTITHREADED
-      assert(pthread_mutex_unlock(&node->mutex) == 0);
+  // Busy buffers are only held for a send, wait for one to be released
+  if ((ret = pthread_mutex_lock(&node->post_buffers_mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node post buffers mutex"));
+    return -1;
+  }
+  __atomic_fetch_add(&node->num_post_waiters, 1, __ATOMIC_RELAXED);
+  // Pairs with the one on release, so that either sees the other
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  while ((i = uccn_claim_slot(&node->post_buffers_in_use, CONFIG_UCCN_NUM_POST_BUFFERS)) < 0) {
+    pthread_cond_wait(&node->post_buffer_released, &node->post_buffers_mutex);
+  }
+  __atomic_fetch_sub(&node->num_post_waiters, 1, __ATOMIC_RELAXED);
+  if ((ret = pthread_mutex_unlock(&node->post_buffers_mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to unlock node post buffers mutex"));
+  }
+#else
+  uccnerr(RUNTIME_ERR("No post buffer left, cannot post from within a post"));
 #endif
-      return -1;
-    }
+  return i;
+}
 
-    for (ret = 0, i = 0; i < endpoint->num_peers; ++i) {
-      peer = endpoint->peers[i];
+static void uccn_release_post_buffer(struct uccn_node_s * node, size_t i)
+{
+#if CONFIG_UCCN_MULTITHREADED
+  int ret;
+#endif
 
-      nbytes = sendto(node->socket, packet->data, packet->length, 0,
-                      (struct sockaddr *)&peer->address,
-                      sizeof(peer->address));
-      assert(nbytes < 0 || (size_t)nbytes == packet->length);
-      if (nbytes < 0) {
-        uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to send '%s' content", resource->path));
-        continue;
-      }
-      if ((ret = clock_gettime(CLOCK_MONOTONIC, &peer->liveliness.next_local_deadline)) != 0) {
-        uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
-        return ret;
-      }
-      timespec_add(&peer->liveliness.next_local_deadline, &g_uccn_liveliness_assert_timeout);
-      ++ret;
-    }
+  uccn_free_slot(&node->post_buffers_in_use, i);
 #if CONFIG_UCCN_MULTITHREADED
-    assert(pthread_mutex_unlock(&node->mutex) == 0);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&node->num_post_waiters, __ATOMIC_RELAXED) == 0) {
+    return;
+  }
+  if ((ret = pthread_mutex_lock(&node->post_buffers_mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node post buffers mutex"));
+    return;
+  }
+  pthread_cond_signal(&node->post_buffer_released);
+  if ((ret = pthread_mutex_unlock(&node->post_buffers_mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to unlock node post buffers mutex"));
+  }
+#endif
+}
+
+// Sends packed content out to linked peers. Content packed in place comes
+// with room for the content header right before it.
+static int uccn_send_content(struct uccn_content_provider_s * provider,
+                             struct buffer_head_s * blob, bool inplace)
+{
+  int ret;
+  size_t iovcnt;
+  struct iovec iov[2];
+  struct timespec current_time;
+  char header[UCCN_CONTENT_HEADER_SIZE];
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  uint32_t checksum;
+  struct iovec checked_iov[2];
+  char checked_header[UCCN_CHECKED_CONTENT_HEADER_SIZE];
+#endif
+  const struct iovec * checked = NULL;
+
+  struct uccn_content_endpoint_s * endpoint =
+      (struct uccn_content_endpoint_s *)provider;
+  const struct uccn_resource_s * resource = endpoint->resource;
+
+#if CONFIG_UCCN_FRAGMENTATION
+  if (!inplace && blob->length > CONFIG_UCCN_MAX_FRAGMENT_SIZE) {
+    if ((ret = uccn_post_fragments(provider, blob)) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+      return ret;
+    }
+    goto note_uccn_send_content;
+  }
+#endif
+  if (blob->length + UCCN_CONTENT_HEADER_ROOM > CONFIG_UCCN_OUTGOING_BUFFER_SIZE) {
+    uccnerr(RUNTIME_ERR("Content for '%s' resource does not fit a packet (%zu bytes)",
+                        resource->path, blob->length));
+    return -1;
+  }
+
+  if (inplace) {
+    iov[0].iov_base = (char *)blob->data - UCCN_CONTENT_HEADER_SIZE;
+    iov[0].iov_len = uccn_write_content_header(iov[0].iov_base, resource->hash,
+                                               NULL, blob->length);
+    iov[0].iov_len += blob->length;
+    iovcnt = 1;
+  } else {
+    iov[0].iov_base = header;
+    iov[0].iov_len = uccn_write_content_header(header, resource->hash, NULL, blob->length);
+    iov[1].iov_base = blob->data;
+    iov[1].iov_len = blob->length;
+    iovcnt = 2;
+  }
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  if (__atomic_load_n(&endpoint->num_checked_peers, __ATOMIC_RELAXED) > 0) {
+    checksum = crc32(blob->data, blob->length);
+    if (inplace) {
+      // The longer header overlaps the plain one, so the latter goes out on its own
+      checked_iov[0].iov_base = (char *)blob->data - UCCN_CHECKED_CONTENT_HEADER_SIZE;
+      checked_iov[0].iov_len = UCCN_CHECKED_CONTENT_HEADER_SIZE;
+      iov[0].iov_base = header;
+      iov[0].iov_len = uccn_write_content_header(header, resource->hash, NULL, blob->length);
+      iov[1].iov_base = blob->data;
+      iov[1].iov_len = blob->length;
+      iovcnt = 2;
+    } else {
+      checked_iov[0].iov_base = checked_header;
+      checked_iov[0].iov_len = UCCN_CHECKED_CONTENT_HEADER_SIZE;
+    }
+    uccn_write_content_header(checked_iov[0].iov_base, resource->hash, &checksum, blob->length);
+    checked_iov[1] = iov[1];
+    checked = checked_iov;
+  }
+#endif
+
+  if ((ret = uccn_fanout_endpoint(endpoint, iov, checked, iovcnt)) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    return ret;
+  }
+#if CONFIG_UCCN_FRAGMENTATION
+ note_uccn_send_content:
+#endif
+  // Let the node know, keepalives to these peers can be skipped meanwhile
+  if (clock_gettime(CLOCK_MONOTONIC, &current_time) == 0) {
+    __atomic_store_n(&provider->last_post_time,
+                     (uint64_t)current_time.tv_sec * 1000000000ULL + current_time.tv_nsec,
+                     __ATOMIC_RELEASE);
+  }
+  return ret;
+}
+
+int uccn_post(struct uccn_content_provider_s * provider, const void * content)
+{
+  int ret;
+
+  int slot;
+  struct buffer_head_s * blob;
+  struct buffer_head_s * buffer;
+#if UCCN_IN_PLACE_CONTENT
+  struct buffer_head_s window;
+#endif
+
+  struct uccn_content_endpoint_s * endpoint =
+      (struct uccn_content_endpoint_s *)provider;
+  struct uccn_node_s * node = endpoint->node;
+  const struct uccn_resource_s * resource = endpoint->resource;
+
+  if (__atomic_load_n(&endpoint->num_peers, __ATOMIC_RELAXED) == 0) {
+    return 0;
+  }
+
+  // Held until content has been sent, sends being synchronous
+  if ((slot = uccn_acquire_post_buffer(node)) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    return -1;
+  }
+  buffer = (struct buffer_head_s *)&node->post_buffers[slot];
+#if UCCN_IN_PLACE_CONTENT
+  // Have content packed right where it goes, after a header to be patched
+  window.data = (char *)buffer->data + UCCN_CONTENT_HEADER_ROOM;
+  window.size = buffer->size - UCCN_CONTENT_HEADER_ROOM;
+  window.length = 0;
+  blob = &window;
+#else
+  buffer->length = 0;
+  blob = buffer;
+#endif
+  if ((ret = resource->pack(resource, content, &blob)) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    goto leave_uccn_post;
+  }
+  // Content may also have been packed elsewhere, e.g. in user buffers
+#if UCCN_IN_PLACE_CONTENT
+  if ((ret = uccn_send_content(provider, blob, blob == &window)) < 0) {
+#else
+  if ((ret = uccn_send_content(provider, blob, false)) < 0) {
+#endif
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+  }
+ leave_uccn_post:
+  uccn_release_post_buffer(node, slot);
+  return ret;
+}
+
+void * uccn_borrow(struct uccn_content_provider_s * provider)
+{
+#if CONFIG_UCCN_NUM_LOAN_BUFFERS > 0
+  int i;
+  struct buffer_head_s * window;
+#endif
+  struct uccn_content_endpoint_s * endpoint =
+      (struct uccn_content_endpoint_s *)provider;
+  struct uccn_node_s * node = endpoint->node;
+
+  if (provider->pool.objects != NULL) {
+    return uccn_lend_content(&provider->pool);
+  }
+#if CONFIG_UCCN_NUM_LOAN_BUFFERS > 0
+  i = uccn_claim_slot(&node->loan_buffers_in_use, CONFIG_UCCN_NUM_LOAN_BUFFERS);
+  if (i < 0) {
+    return NULL;
+  }
+  // Leave room for the header if it fits, so that content goes out as is
+  window = &node->loan_buffers[i].window;
+  window->data = node->loan_buffers[i].default_storage;
+  window->size = sizeof(node->loan_buffers[i].default_storage);
+#if UCCN_IN_PLACE_CONTENT
+  window->data = (char *)window->data + UCCN_CONTENT_HEADER_ROOM;
+  window->size -= UCCN_CONTENT_HEADER_ROOM;
+#endif
+  window->length = 0;
+  return window;
+#else
+  (void)node;
+  return NULL;
+#endif
+}
+
+void uccn_discard(struct uccn_content_provider_s * provider, void * loan)
+{
+#if CONFIG_UCCN_NUM_LOAN_BUFFERS > 0
+  size_t i;
+  struct uccn_node_s * node = provider->endpoint.node;
 #endif
+
+  if (provider->pool.objects != NULL) {
+    uccn_give_back_content(&provider->pool, loan);
+    return;
   }
+#if CONFIG_UCCN_NUM_LOAN_BUFFERS > 0
+  i = ((char *)loan - (char *)&node->loan_buffers[0].window) / sizeof(node->loan_buffers[0]);
+  assert(i < CONFIG_UCCN_NUM_LOAN_BUFFERS && loan == &node->loan_buffers[i].window);
+  uccn_free_slot(&node->loan_buffers_in_use, i);
+#else
+  assert(false);
+#endif
+}
+
+int uccn_publish(struct uccn_content_provider_s * provider, void * loan)
+{
+  int ret = 0;
+  struct buffer_head_s * window = loan;
+  struct uccn_content_endpoint_s * endpoint =
+      (struct uccn_content_endpoint_s *)provider;
 
+  if (provider->pool.objects != NULL) {
+    // Objects still get serialized, just not copied around beforehand
+    if ((ret = uccn_post(provider, loan)) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    }
+  } else if (__atomic_load_n(&endpoint->num_peers, __ATOMIC_RELAXED) > 0) {
+    if (window->length > window->size) {
+      uccnerr(RUNTIME_ERR("Borrowed buffer overrun for '%s' resource", endpoint->resource->path));
+      ret = -1;
+    } else if ((ret = uccn_send_content(provider, window, UCCN_IN_PLACE_CONTENT)) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    }
+  }
+  uccn_discard(provider, loan);
   return ret;
 }
 
@@ -333,27 +1594,25 @@ uccn_register_peer(struct uccn_node_s * node, struct sockaddr_in * address)
   assert(node != NULL);
   assert(address != NULL);
 
-  if (node->num_peers >= CONFIG_UCCN_MAX_NUM_PEERS) {
-    uccnerr(RUNTIME_ERR("Too many peers, ignoring"));
-    return NULL;
-  }
-
   if (clock_gettime(CLOCK_MONOTONIC, &current_time) < 0) {
     uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
     return NULL;
   }
 
-  for (i = 0; i < node->num_peers; ++i) {
+  for (i = 0; i < node->capacity.max_num_peers; ++i) {
     peer = &node->peers[i];
 
-    if (same_sockaddr_in(&peer->address, address)) {
+    if (peer->in_use && same_sockaddr_in(&peer->address, address)) {
       peer->liveliness.next_remote_deadline = current_time;
       timespec_add(&peer->liveliness.next_remote_deadline, &g_uccn_liveliness_timeout);
       return peer;
     }
   }
 
-  peer = &node->peers[node->num_peers++];
+  if ((peer = uccn_acquire_peer(node)) == NULL) {
+    uccnerr(RUNTIME_ERR("Too many peers, ignoring"));
+    return NULL;
+  }
   peer->address = *address;
 
   strncpy(peer->name, "anon", CONFIG_UCCN_MAX_NODE_NAME_SIZE);
@@ -363,20 +1622,66 @@ uccn_register_peer(struct uccn_node_s * node, struct sockaddr_in * address)
            ":%d", ntohs(address->sin_port));
 
   peer->alive = true;
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  peer->checksums = false;
+#endif
+#if CONFIG_UCCN_MULTICAST_CONTENT
+  peer->multicast = false;
+#endif
   peer->liveliness.next_remote_deadline = current_time;
   timespec_add(&peer->liveliness.next_remote_deadline, &g_uccn_liveliness_timeout);
-  TIMESPEC_ZERO_INIT(&peer->liveliness.next_local_deadline);
-  peer->provided_content_hash = 0;
-  peer->tracked_content_hash = 0;
+  upoll_wheel_schedule(&node->timers.wheel, &peer->liveliness.remote_timer,
+                       &peer->liveliness.next_remote_deadline);
+  // Asserted right away, which also lets go of peers left unlinked
+  peer->liveliness.next_local_deadline = current_time;
+  upoll_wheel_schedule(&node->timers.wheel, &peer->liveliness.local_timer,
+                       &peer->liveliness.next_local_deadline);
+  peer->provided_content.size = 0;
+  peer->tracked_content.size = 0;
   peer->num_links = 0;
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+  // Timers were set behind the back of the thread spinning, if any
+  if (node->deferring_worker != NULL && uccn_wakeup(node) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+  }
+#endif
   uccndbg("Peer %s@%s registered", peer->name, peer->location);
   return peer;
 }
 
-static ssize_t content_passthrough(struct uccn_resource_s * resource,
-                                   struct buffer_head_s * input,
-                                   struct buffer_head_s ** output) {
-  (void)resource;
+struct uccn_peer_s * uccn_acquire_peer(struct uccn_node_s * node)
+{
+  struct uccn_peer_s * peer;
+
+  if (node->free_peers == UCCN_NO_FREE_PEERS) {
+    return NULL;
+  }
+  peer = &node->peers[node->free_peers];
+  node->free_peers = peer->next_free;
+  peer->in_use = true;
+  ++node->num_peers;
+  return peer;
+}
+
+void uccn_release_peer(struct uccn_node_s * node, struct uccn_peer_s * peer)
+{
+  assert(peer->in_use);
+  peer->in_use = false;
+  upoll_wheel_cancel(&node->timers.wheel, &peer->liveliness.remote_timer);
+  upoll_wheel_cancel(&node->timers.wheel, &peer->liveliness.local_timer);
+  // Invalidate all outstanding handles to this slot
+  if (++peer->generation == 0) {
+    peer->generation = 1;
+  }
+  peer->next_free = node->free_peers;
+  node->free_peers = peer - node->peers;
+  --node->num_peers;
+}
+
+static ssize_t content_passthrough(struct uccn_resource_s * resource,
+                                   struct buffer_head_s * input,
+                                   struct buffer_head_s ** output) {
+  (void)resource;
   assert(input != NULL);
   assert(output != NULL);
 
@@ -390,10 +1695,18 @@ void uccn_resource_init(struct uccn_resource_s * resource, const char * path)
   assert(path != NULL);
   strncpy(resource->path, path, CONFIG_UCCN_MAX_RESOURCE_PATH_SIZE);
   resource->hash = crc32((const uint8_t *)path, strlen(path));
+  resource->content_size = 0;
   resource->pack = (uccn_content_pack_fn)content_passthrough;
   resource->unpack = (uccn_content_unpack_fn)content_passthrough;
 }
 
+void uccn_raw_data_init(struct uccn_raw_data_s * raw_data, const char * path)
+{
+  assert(raw_data != NULL);
+  // Raw content is sent straight from and delivered as buffer heads
+  uccn_resource_init((struct uccn_resource_s *)raw_data, path);
+}
+
 static ssize_t generic_record_pack(const struct uccn_record_s * record,
                                    const void * content,
                                    struct buffer_head_s ** blob)
@@ -416,27 +1729,82 @@ static ssize_t generic_record_unpack(const struct uccn_record_s * record,
   assert(record != NULL);
   assert(blob != NULL);
   assert(content != NULL);
+  // Trackers lend content objects to unpack into
+  assert(*content != NULL);
 
-  if (*content == NULL) {
-    if ((*content = record->ts->allocate(record->ts)) == NULL) {
-      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
-      return -1;
-    }
-  }
   return record->ts->deserialize(record->ts, blob, *content);
 }
 
+static ssize_t flat_record_pack(const struct uccn_record_s * record,
+                                const void * content,
+                                struct buffer_head_s ** blob)
+{
+  uint8_t * data;
+  const struct uccn_record_typesupport_s * ts = record->ts;
+
+  assert(content != NULL);
+  assert(blob != NULL);
+
+  if (*blob == NULL) {
+    uccnerr(RUNTIME_ERR("Need a blob to pack content into"));
+    return -1;
+  }
+  if ((*blob)->size < UCCN_FLAT_RECORD_HEADER_SIZE + ts->size) {
+    uccnerr(RUNTIME_ERR("Flat '%s' record does not fit a %zu bytes blob",
+                        record->base.path, (*blob)->size));
+    return -1;
+  }
+  data = (*blob)->data;
+  memcpy(data, &ts->schema, UCCN_FLAT_RECORD_HEADER_SIZE);
+  memcpy(&data[UCCN_FLAT_RECORD_HEADER_SIZE], content, ts->size);
+  (*blob)->length = UCCN_FLAT_RECORD_HEADER_SIZE + ts->size;
+  return (*blob)->length;
+}
+
+static ssize_t flat_record_unpack(const struct uccn_record_s * record,
+                                  const struct buffer_head_s * blob,
+                                  void ** content)
+{
+  uint32_t schema;
+  const uint8_t * data = blob->data;
+  const struct uccn_record_typesupport_s * ts = record->ts;
+
+  assert(content != NULL);
+  assert(*content != NULL);
+
+  if (blob->length != UCCN_FLAT_RECORD_HEADER_SIZE + ts->size) {
+    uccnerr(RUNTIME_ERR("Flat '%s' record has a bad size (%zu bytes)",
+                        record->base.path, blob->length));
+    return -1;
+  }
+  memcpy(&schema, data, UCCN_FLAT_RECORD_HEADER_SIZE);
+  if (schema != ts->schema) {
+    uccnerr(RUNTIME_ERR("Flat '%s' record has a mismatching schema (%08x, not %08x)",
+                        record->base.path, schema, ts->schema));
+    return -1;
+  }
+  // Already laid out as it should be, no deserialization needed
+  memcpy(*content, &data[UCCN_FLAT_RECORD_HEADER_SIZE], ts->size);
+  return blob->length;
+}
+
 void uccn_record_init(struct uccn_record_s * record, const char * path,
                       const struct uccn_record_typesupport_s * ts)
 {
   assert(record != NULL);
   assert(path != NULL);
   assert(ts != NULL);
-  assert(ts->serialize != NULL);
-  assert(ts->deserialize != NULL);
+  assert(ts->size > 0);
+  assert((ts->serialize != NULL) == (ts->deserialize != NULL));
   uccn_resource_init((struct uccn_resource_s *)record, path);
-  record->base.pack = (uccn_content_pack_fn)generic_record_pack;
-  record->base.unpack = (uccn_content_unpack_fn)generic_record_unpack;
+  record->base.content_size = ts->size;
+  if (ts->serialize != NULL) {
+    record->base.pack = (uccn_content_pack_fn)generic_record_pack;
+    record->base.unpack = (uccn_content_unpack_fn)generic_record_unpack;
+  } else {
+    record->base.pack = (uccn_content_pack_fn)flat_record_pack;
+    record->base.unpack = (uccn_content_unpack_fn)flat_record_unpack;
+  }
   record->ts = ts;
 }
 
@@ -449,699 +1817,2479 @@ int uccn_prepare_keepalive_packet(struct uccn_node_s * node, struct buffer_head_
   assert(packet != NULL);
   assert(packet->data != NULL);
 
-  mpack_writer_init(&writer, packet->data, packet->size);
-  mpack_write_nil(&writer);
-  packet->length = mpack_writer_buffer_used(&writer);
-  if ((err = mpack_writer_destroy(&writer)) != mpack_ok) {
-    uccnerr(RUNTIME_ERR("Failed to build keepalive packet: %s",
-                        mpack_error_to_string(err)));
-    return -1;
-  }
-  return 0;
+  mpack_writer_init(&writer, packet->data, packet->size);
+  mpack_write_nil(&writer);
+  packet->length = mpack_writer_buffer_used(&writer);
+  if ((err = mpack_writer_destroy(&writer)) != mpack_ok) {
+    uccnerr(RUNTIME_ERR("Failed to build keepalive packet: %s",
+                        mpack_error_to_string(err)));
+    return -1;
+  }
+  return 0;
+}
+
+int uccn_prepare_discovery_packet(struct uccn_node_s * node, struct buffer_head_s * packet)
+{
+  size_t i;
+
+  mpack_error_t err;
+  mpack_writer_t writer;
+
+  struct uccn_content_endpoint_s * endpoint;
+
+  assert(node != NULL);
+  assert(packet != NULL);
+  assert(packet->data != NULL);
+
+  mpack_writer_init(&writer, packet->data, packet->size);
+  mpack_start_map(&writer, 1);
+  {
+    mpack_write_u8(&writer, UCCN_LINK_GROUP);
+    mpack_start_map(&writer, 2);
+    {
+      mpack_write_u8(&writer, UCCN_NODE_NAME);
+      mpack_write_cstr(&writer, node->name);
+    }
+    {
+      mpack_write_u8(&writer, UCCN_TRACKED_ARRAY);
+      // Always advertise the full set, peers diff it against the last one
+      mpack_start_array(&writer, node->num_trackers + UCCN_NUM_CAPABILITY_HASHES);
+      uccn_write_capability_hashes(&writer);
+      for (i = 0; i < node->num_trackers; ++i) {
+        endpoint = (struct uccn_content_endpoint_s *)&node->trackers[i];
+        mpack_write_u32(&writer, endpoint->resource->hash);
+      }
+      mpack_finish_array(&writer);
+    }
+    mpack_finish_map(&writer);
+  }
+  mpack_finish_map(&writer);
+  packet->length = mpack_writer_buffer_used(&writer);
+  if ((err = mpack_writer_destroy(&writer)) != mpack_ok) {
+    uccnerr(RUNTIME_ERR("Failed to build discovery packet: %s",
+                        mpack_error_to_string(err)));
+    return -1;
+  }
+  return 0;
+}
+
+void uccn_account_posts(struct uccn_node_s * node, struct uccn_peer_s * peer)
+{
+  size_t i;
+  uint64_t last_post_time;
+  struct timespec deadline;
+  struct uccn_content_provider_s * provider;
+
+  for (i = 0; i < peer->tracked_content.size; ++i) {
+    provider = hash_index_find(&node->provider_index, peer->tracked_content.hashes[i]);
+    if (provider == NULL) {
+      continue;
+    }
+    last_post_time = __atomic_load_n(&provider->last_post_time, __ATOMIC_ACQUIRE);
+    if (last_post_time == 0) {
+      continue;
+    }
+    deadline.tv_sec = last_post_time / 1000000000ULL;
+    deadline.tv_nsec = last_post_time % 1000000000ULL;
+    timespec_add(&deadline, &g_uccn_liveliness_assert_timeout);
+    if (timespec_cmp(&deadline, &peer->liveliness.next_local_deadline) > 0) {
+      peer->liveliness.next_local_deadline = deadline;
+    }
+  }
+}
+
+int uccn_assert_liveliness(struct uccn_node_s * node,
+                           struct uccn_peer_s * peer,
+                           const struct buffer_head_s * keepalive_packet,
+                           const struct timespec * current_time)
+{
+  ssize_t nbytes;
+
+  // Posts went out without touching the peer, catch up on them first
+  uccn_account_posts(node, peer);
+  if (timespec_cmp(&peer->liveliness.next_local_deadline, current_time) > 0) {
+    upoll_wheel_schedule(&node->timers.wheel, &peer->liveliness.local_timer,
+                         &peer->liveliness.next_local_deadline);
+    return 0;
+  }
+  peer->liveliness.next_local_deadline = *current_time;
+  timespec_add(&peer->liveliness.next_local_deadline, &g_uccn_liveliness_assert_timeout);
+  upoll_wheel_schedule(&node->timers.wheel, &peer->liveliness.local_timer,
+                       &peer->liveliness.next_local_deadline);
+
+  nbytes = sendto(node->socket, keepalive_packet->data, keepalive_packet->length,
+                  0, (struct sockaddr *)&peer->address,
+                  sizeof(peer->address));
+  assert(nbytes < 0 || (size_t)nbytes == keepalive_packet->length);
+  if (nbytes < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to send keepalive packet"));
+    return nbytes;
+  }
+  return 0;
+}
+
+int uccn_discover_peers(struct uccn_node_s * node)
+{
+  int ret = 0;
+  ssize_t nbytes;
+  struct buffer_head_s * outgoing_packet;
+
+  outgoing_packet = (struct buffer_head_s *)&node->outgoing_buffer;
+  if ((ret = uccn_prepare_discovery_packet(node, outgoing_packet)) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    return ret;
+  }
+
+  uccndbg("Attempting to discover peers");
+  nbytes = sendto(node->socket, outgoing_packet->data, outgoing_packet->length,
+                  0, (struct sockaddr *)&node->broadcast_address,
+                  sizeof(node->broadcast_address));
+  assert(nbytes < 0 || (size_t)nbytes == outgoing_packet->length);
+  if (nbytes < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to send discovery packet"));
+    ret = nbytes;
+  }
+
+  return ret;
+}
+
+int uccn_receive_batch(int sockfd, struct uccn_incoming_buffer_s * buffers)
+{
+  int ret;
+  size_t i;
+  struct buffer_head_s * incoming_packet;
+#if CONFIG_UCCN_BATCHED_IO
+  struct iovec iovs[CONFIG_UCCN_RECV_BATCH_SIZE];
+  struct mmsghdr msgs[CONFIG_UCCN_RECV_BATCH_SIZE];
+#else
+  socklen_t address_size;
+#endif
+
+  assert(buffers != NULL);
+
+#if CONFIG_UCCN_BATCHED_IO
+  for (i = 0; i < CONFIG_UCCN_RECV_BATCH_SIZE; ++i) {
+    incoming_packet = (struct buffer_head_s *)&buffers[i];
+    iovs[i].iov_base = incoming_packet->data;
+    iovs[i].iov_len = incoming_packet->size;
+    memset(&msgs[i], 0, sizeof(msgs[i]));
+    msgs[i].msg_hdr.msg_name = &buffers[i].origin;
+    msgs[i].msg_hdr.msg_namelen = sizeof(buffers[i].origin);
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  do {
+    ret = recvmmsg(sockfd, msgs, CONFIG_UCCN_RECV_BATCH_SIZE, MSG_DONTWAIT, NULL);
+  } while (ret < 0 && errno == EINTR);
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to receive packets"));
+    return ret;
+  }
+  for (i = 0; i < (size_t)ret; ++i) {
+    incoming_packet = (struct buffer_head_s *)&buffers[i];
+    incoming_packet->length = msgs[i].msg_len;
+  }
+#else
+  (void)i;
+  incoming_packet = (struct buffer_head_s *)&buffers[0];
+  address_size = sizeof(buffers[0].origin);
+  ret = recvfrom(sockfd, incoming_packet->data, incoming_packet->size, MSG_DONTWAIT,
+                 (struct sockaddr *)&buffers[0].origin, &address_size);
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to receive packet"));
+    return ret;
+  }
+  incoming_packet->length = ret;
+  ret = 1;
+#endif
+  return ret;
+}
+
+int uccn_process_incoming_unicast(struct uccn_node_s * node)
+{
+  int ret, status = 0;
+  size_t i, num_packets;
+  struct sockaddr_in * origin;
+  struct buffer_head_s * incoming_packet;
+
+  assert(node != NULL);
+
+  if ((ret = uccn_receive_batch(node->socket, node->incoming_buffers)) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    return ret;
+  }
+  num_packets = ret;
+
+  // Packets in a batch are off the socket already, one bad packet
+  // must not take the rest down with it
+  for (i = 0; i < num_packets; ++i) {
+    incoming_packet = (struct buffer_head_s *)&node->incoming_buffers[i];
+    origin = &node->incoming_buffers[i].origin;
+
+    if (same_sockaddr_in(origin, &node->address)) {
+      uccnerr(RUNTIME_ERR("Port reuse is not supported"));
+      if (status == 0) {
+        status = -1;
+      }
+      continue;
+    }
+
+    if ((ret = uccn_process_incoming(node, origin, incoming_packet)) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+      if (status == 0) {
+        status = ret;
+      }
+    }
+  }
+  return status;
+}
+
+int uccn_process_incoming_broadcast(struct uccn_node_s * node)
+{
+  int ret, status = 0;
+  size_t i, num_packets;
+  struct sockaddr_in * origin;
+  struct buffer_head_s * incoming_packet;
+
+  assert(node != NULL);
+
+  if ((ret = uccn_receive_batch(node->broadcast_socket, node->incoming_buffers)) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    return ret;
+  }
+  num_packets = ret;
+
+  for (i = 0; i < num_packets; ++i) {
+    incoming_packet = (struct buffer_head_s *)&node->incoming_buffers[i];
+    origin = &node->incoming_buffers[i].origin;
+
+    if (same_sockaddr_in(origin, &node->address)) {
+      // Ignoring broadcast to self
+      continue;
+    }
+
+    // Carry on past bad packets, like unicast does
+    if ((ret = uccn_process_incoming(node, origin, incoming_packet)) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+      if (status == 0) {
+        status = ret;
+      }
+    }
+  }
+  return status;
+}
+
+int uccn_process_incoming(struct uccn_node_s * node,
+                          struct sockaddr_in * origin,
+                          struct buffer_head_s * incoming_packet)
+{
+  int ret;
+  ssize_t nbytes;
+  struct uccn_peer_s * peer;
+  struct buffer_head_s * outgoing_packet;
+
+  if ((peer = uccn_register_peer(node, origin)) == NULL) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    return -1;
+  }
+
+  outgoing_packet = (struct buffer_head_s *)&node->outgoing_buffer;
+  ret = uccn_process_packet(node, peer, incoming_packet, outgoing_packet);
+  if (ret < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 2));
+    return ret;
+  }
+
+  if (outgoing_packet->length > 0) {
+    nbytes = sendto(
+        node->socket, outgoing_packet->data, outgoing_packet->length, 0,
+        (struct sockaddr *)&peer->address, sizeof(peer->address));
+    assert(nbytes < 0 || (size_t)nbytes == outgoing_packet->length);
+    if (nbytes < 0) {
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to send packet"));
+      return nbytes;
+    }
+  }
+
+  return 0;
+}
+
+#if CONFIG_UCCN_EXECUTOR
+
+int uccn_init_content_queue(struct uccn_content_queue_s * queue)
+{
+  size_t i;
+
+  memset(queue, 0, sizeof(*queue));
+  queue->policy = UCCN_DROP_OLDEST;
+  // Buffers are allocated upfront, not to do so with the executor locked
+  for (i = 0; i < CONFIG_UCCN_TRACKER_QUEUE_DEPTH; ++i) {
+    queue->slots[i].buffer = malloc(UCCN_QUEUED_CONTENT_SIZE);
+    if (queue->slots[i].buffer == NULL) {
+      uccnerr(RUNTIME_ERR("Failed to allocate %d bytes for queued content",
+                          UCCN_QUEUED_CONTENT_SIZE));
+      uccn_fini_content_queue(queue);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+void uccn_fini_content_queue(struct uccn_content_queue_s * queue)
+{
+  size_t i;
+
+  for (i = 0; i < CONFIG_UCCN_TRACKER_QUEUE_DEPTH; ++i) {
+    free(queue->slots[i].storage);
+    free(queue->slots[i].buffer);
+  }
+  memset(queue, 0, sizeof(*queue));
+}
+
+static void uccn_schedule_tracker(struct uccn_node_s * node,
+                                  struct uccn_content_tracker_s * tracker)
+{
+  tracker->queue.next = NULL;
+  if (node->executor.last_ready != NULL) {
+    node->executor.last_ready->queue.next = tracker;
+  } else {
+    node->executor.first_ready = tracker;
+  }
+  node->executor.last_ready = tracker;
+  pthread_cond_signal(&node->executor.ready);
+}
+
+int uccn_enqueue_content(struct uccn_node_s * node,
+                         struct uccn_content_tracker_s * tracker,
+                         const struct buffer_head_s * blob,
+                         void * storage)
+{
+  int ret;
+  struct uccn_queued_content_s * slot;
+  struct uccn_content_queue_s * queue = &tracker->queue;
+
+  if (storage == NULL && blob->length > UCCN_QUEUED_CONTENT_SIZE) {
+    uccnerr(RUNTIME_ERR("Content too large to queue (%zu bytes)", blob->length));
+    return -1;
+  }
+  if ((ret = pthread_mutex_lock(&node->executor.mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node executor mutex"));
+    free(storage);
+    return -1;
+  }
+  while (queue->length == CONFIG_UCCN_TRACKER_QUEUE_DEPTH &&
+         queue->policy == UCCN_BLOCK && !node->executor.stopping) {
+    pthread_cond_wait(&node->executor.room, &node->executor.mutex);
+  }
+  if (queue->length == CONFIG_UCCN_TRACKER_QUEUE_DEPTH) {
+    ++queue->num_dropped;
+    if (queue->policy != UCCN_DROP_OLDEST) {
+      goto leave_uccn_enqueue_content;
+    }
+    // Served content is swapped out of its slot, so the head is idle
+    slot = &queue->slots[queue->head];
+    free(slot->storage);
+    slot->storage = NULL;
+    queue->head = (queue->head + 1) % CONFIG_UCCN_TRACKER_QUEUE_DEPTH;
+    --queue->length;
+  }
+
+  slot = &queue->slots[(queue->head + queue->length) % CONFIG_UCCN_TRACKER_QUEUE_DEPTH];
+  if (storage != NULL) {
+    // Take content over along with its storage, there is no copy to make
+    slot->blob = *blob;
+    slot->storage = storage;
+    storage = NULL;
+  } else {
+    memcpy(slot->buffer, blob->data, blob->length);
+    slot->blob.data = slot->buffer;
+    slot->blob.size = UCCN_QUEUED_CONTENT_SIZE;
+    slot->blob.length = blob->length;
+  }
+  ++queue->length;
+
+  if (!queue->scheduled) {
+    queue->scheduled = true;
+    uccn_schedule_tracker(node, tracker);
+  }
+ leave_uccn_enqueue_content:
+  if ((ret = pthread_mutex_unlock(&node->executor.mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to unlock node executor mutex"));
+  }
+  free(storage);
+  return ret != 0 ? -1 : 0;
+}
+
+static void * uccn_executor_main(void * arg)
+{
+  int ret;
+  struct uccn_queued_content_s spare, content, * slot;
+  struct uccn_content_queue_s * queue;
+  struct uccn_content_tracker_s * tracker;
+  struct uccn_node_s * node = arg;
+
+  memset(&spare, 0, sizeof(spare));
+  // Slots get this buffer in return for the content they hold
+  if ((spare.buffer = malloc(UCCN_QUEUED_CONTENT_SIZE)) == NULL) {
+    uccnerr(RUNTIME_ERR("Failed to allocate %d bytes for executor content",
+                        UCCN_QUEUED_CONTENT_SIZE));
+    return NULL;
+  }
+  if ((ret = pthread_mutex_lock(&node->executor.mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node executor mutex"));
+    free(spare.buffer);
+    return NULL;
+  }
+  for (;;) {
+    while (node->executor.first_ready == NULL && !node->executor.stopping) {
+      pthread_cond_wait(&node->executor.ready, &node->executor.mutex);
+    }
+    if (node->executor.stopping) {
+      break;
+    }
+    tracker = node->executor.first_ready;
+    node->executor.first_ready = tracker->queue.next;
+    if (node->executor.first_ready == NULL) {
+      node->executor.last_ready = NULL;
+    }
+
+    // Take content out of its slot, handing a spare buffer in return
+    queue = &tracker->queue;
+    slot = &queue->slots[queue->head];
+    content = *slot;
+    *slot = spare;
+    spare = content;
+    queue->head = (queue->head + 1) % CONFIG_UCCN_TRACKER_QUEUE_DEPTH;
+    --queue->length;
+    if (queue->policy == UCCN_BLOCK) {
+      pthread_cond_broadcast(&node->executor.room);
+    }
+    if ((ret = pthread_mutex_unlock(&node->executor.mutex)) != 0) {
+      errno = ret;
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to unlock node executor mutex"));
+      break;
+    }
+
+    if (uccn_dispatch_content(tracker, &spare.blob) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    }
+    free(spare.storage);
+    spare.storage = NULL;
+
+    if ((ret = pthread_mutex_lock(&node->executor.mutex)) != 0) {
+      errno = ret;
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node executor mutex"));
+      break;
+    }
+    ++queue->num_dispatched;
+    // Go to the back of the line, for trackers not to starve one another
+    if (queue->length > 0) {
+      uccn_schedule_tracker(node, tracker);
+    } else {
+      queue->scheduled = false;
+    }
+  }
+  if (ret == 0 && (ret = pthread_mutex_unlock(&node->executor.mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to unlock node executor mutex"));
+  }
+  free(spare.buffer);
+  return NULL;
+}
+
+int uccn_start_executor(struct uccn_node_s * node)
+{
+  int ret;
+  size_t i;
+
+  node->executor.first_ready = node->executor.last_ready = NULL;
+  node->executor.stopping = false;
+  node->executor.num_threads = 0;
+  if ((ret = pthread_mutex_init(&node->executor.mutex, NULL)) != 0 ||
+      (ret = pthread_cond_init(&node->executor.ready, NULL)) != 0 ||
+      (ret = pthread_cond_init(&node->executor.room, NULL)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 4, "Failed to initialize node executor"));
+    return -1;
+  }
+
+  for (i = 0; i < CONFIG_UCCN_EXECUTOR_NUM_THREADS; ++i) {
+    ret = pthread_create(&node->executor.threads[i], NULL, uccn_executor_main, node);
+    if (ret != 0) {
+      errno = ret;
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to start node executor thread"));
+      return -1;
+    }
+    ++node->executor.num_threads;
+  }
+  return 0;
+}
+
+int uccn_stop_executor(struct uccn_node_s * node)
+{
+  int ret;
+  size_t i;
+
+  if (node->executor.num_threads == 0) {
+    return 0;
+  }
+
+  // Content still queued is dropped, along with queues once the node is done
+  if ((ret = pthread_mutex_lock(&node->executor.mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node executor mutex"));
+    return -1;
+  }
+  node->executor.stopping = true;
+  pthread_cond_broadcast(&node->executor.ready);
+  pthread_cond_broadcast(&node->executor.room);
+  if ((ret = pthread_mutex_unlock(&node->executor.mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to unlock node executor mutex"));
+    return -1;
+  }
+  for (i = 0; i < node->executor.num_threads; ++i) {
+    pthread_join(node->executor.threads[i], NULL);
+  }
+  node->executor.num_threads = 0;
+
+  pthread_cond_destroy(&node->executor.room);
+  pthread_cond_destroy(&node->executor.ready);
+  pthread_mutex_destroy(&node->executor.mutex);
+  return 0;
+}
+
+int uccn_set_overflow_policy(struct uccn_content_tracker_s * tracker,
+                             enum uccn_overflow_policy_e policy)
+{
+  int ret;
+  struct uccn_node_s * node = tracker->endpoint.node;
+
+  if ((ret = pthread_mutex_lock(&node->executor.mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node executor mutex"));
+    return -1;
+  }
+  tracker->queue.policy = policy;
+  // Let blocked content through if no longer blocking
+  pthread_cond_broadcast(&node->executor.room);
+  if ((ret = pthread_mutex_unlock(&node->executor.mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to unlock node executor mutex"));
+    return -1;
+  }
+  return 0;
+}
+
+int uccn_get_tracker_stats(struct uccn_content_tracker_s * tracker,
+                           struct uccn_tracker_stats_s * stats)
+{
+  int ret;
+  struct uccn_node_s * node = tracker->endpoint.node;
+
+  if ((ret = pthread_mutex_lock(&node->executor.mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node executor mutex"));
+    return -1;
+  }
+  stats->queue_depth = tracker->queue.length;
+  stats->num_dropped = tracker->queue.num_dropped;
+  stats->num_dispatched = tracker->queue.num_dispatched;
+  if ((ret = pthread_mutex_unlock(&node->executor.mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to unlock node executor mutex"));
+    return -1;
+  }
+  return 0;
+}
+
+#endif
+
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+
+// Unpacks and dispatches content left aside, in the order it came in
+static void uccn_dispatch_deferred_content(struct uccn_receive_worker_s * worker)
+{
+  size_t i;
+  struct uccn_deferred_content_s * deferred;
+
+  for (i = 0; i < worker->num_deferred; ++i) {
+    deferred = &worker->deferred[i];
+    if (uccn_dispatch_content(deferred->tracker, &deferred->blob) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    }
+    free(deferred->storage);
+  }
+  worker->num_deferred = 0;
+}
+
+int uccn_process_incoming_content(struct uccn_receive_worker_s * worker)
+{
+  int ret, status = 0;
+  size_t i, num_packets;
+  struct sockaddr_in * origin;
+  struct buffer_head_s * incoming_packet;
+  struct uccn_node_s * node = worker->node;
+
+  if ((ret = uccn_receive_batch(worker->socket, worker->incoming_buffers)) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    return ret;
+  }
+  num_packets = ret;
+
+  // Keep node bookkeeping under the node mutex, but leave content aside
+  if ((ret = pthread_mutex_lock(&node->mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node mutex"));
+    return -1;
+  }
+  worker->num_deferred = 0;
+  node->deferring_worker = worker;
+  for (i = 0; i < num_packets; ++i) {
+    incoming_packet = (struct buffer_head_s *)&worker->incoming_buffers[i];
+    origin = &worker->incoming_buffers[i].origin;
+
+    if (UCCN_MAX_NUM_DEFERRED_CONTENT - worker->num_deferred < UCCN_MAX_CONTENT_PER_PACKET) {
+      // Not to run out of room halfway through a packet, hand content
+      // over first, with the node unlocked as always
+      node->deferring_worker = NULL;
+      uccn_unlock_node(node);
+      uccn_dispatch_deferred_content(worker);
+      if ((ret = pthread_mutex_lock(&node->mutex)) != 0) {
+        errno = ret;
+        uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node mutex"));
+        return -1;
+      }
+      node->deferring_worker = worker;
+    }
+
+    // Carry on past bad packets, the rest of the batch is off the socket too
+    if ((ret = uccn_process_incoming(node, origin, incoming_packet)) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+      if (status == 0) {
+        status = ret;
+      }
+    }
+  }
+  node->deferring_worker = NULL;
+  uccn_unlock_node(node);
+
+  // Then unpack and dispatch it in parallel with the rest of the node
+  uccn_dispatch_deferred_content(worker);
+  return status;
+}
+
+static void * uccn_receive_worker_main(void * arg)
+{
+  int ret;
+  struct pollfd fds[2];
+  struct uccn_receive_worker_s * worker = arg;
+
+  fds[0].fd = worker->socket;
+  fds[0].events = POLLIN;
+  fds[1].fd = eventfd_fileno(&worker->node->workers_stop_event);
+  fds[1].events = POLLIN;
+  for (;;) {
+    if ((ret = poll(fds, 2, -1)) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 4, "Failed to poll worker socket"));
+      break;
+    }
+    // Stop event is never cleared, so that all workers see it
+    if (fds[1].revents & POLLIN) {
+      break;
+    }
+    if (fds[0].revents & POLLIN) {
+      if (uccn_process_incoming_content(worker) < 0) {
+        uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+      }
+    }
+  }
+  return NULL;
+}
+
+// Steers content packets to workers by resource hash, everything else to
+// the node socket. Sockets are indexed in the order they joined the port.
+static int uccn_steer_content(struct uccn_node_s * node)
+{
+  struct sock_filter code[] = {
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 0),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0x81, 0, 12),
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 1),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0xcc, 0, 10),
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 2),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, UCCN_CONTENT_GROUP, 0, 8),
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 3),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0x81, 0, 6),
+    BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 4),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0xce, 0, 4),
+    BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 5),
+    BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, CONFIG_UCCN_NUM_RECEIVE_WORKERS),
+    BPF_STMT(BPF_ALU | BPF_ADD | BPF_K, 1),
+    BPF_STMT(BPF_RET | BPF_A, 0),
+    BPF_STMT(BPF_RET | BPF_K, 0),
+  };
+  struct sock_fprog program = {
+    .len = sizeof(code) / sizeof(code[0]),
+    .filter = code,
+  };
+  return setsockopt(node->socket, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+                    &program, sizeof(program));
+}
+
+int uccn_start_receive_workers(struct uccn_node_s * node)
+{
+  int ret, opt = 1;
+  size_t i, j;
+  struct uccn_receive_worker_s * worker;
+
+  for (i = 0; i < CONFIG_UCCN_NUM_RECEIVE_WORKERS; ++i) {
+    worker = &node->receive_workers[i];
+    worker->node = node;
+    worker->num_deferred = 0;
+    for (j = 0; j < CONFIG_UCCN_RECV_BATCH_SIZE; ++j) {
+      stack_buffer_init(&worker->incoming_buffers[j], default_storage);
+    }
+
+    worker->socket = socket(PF_INET, SOCK_DGRAM, 0);
+    if (worker->socket < 0) {
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to create worker socket"));
+      return worker->socket;
+    }
+    ret = setsockopt(worker->socket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
+    if (ret < 0) {
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to reuse port for socket"));
+      return ret;
+    }
+#if CONFIG_UCCN_FRAGMENTATION && CONFIG_UCCN_SOCKET_RECV_BUFFER_SIZE > 0
+    opt = CONFIG_UCCN_SOCKET_RECV_BUFFER_SIZE;
+    if (setsockopt(worker->socket, SOL_SOCKET, SO_RCVBUF, &opt, sizeof(opt)) < 0) {
+      uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to resize socket receive buffer"));
+    }
+    opt = 1;
+#endif
+    ret = bind(worker->socket, (struct sockaddr *)&node->address, sizeof(node->address));
+    if (ret < 0) {
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to bind worker socket"));
+      return ret;
+    }
+  }
+
+  if (uccn_steer_content(node) < 0) {
+    // Port reuse still spreads peers across workers, just not by resource
+    uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to steer content to workers"));
+  }
+
+  for (i = 0; i < CONFIG_UCCN_NUM_RECEIVE_WORKERS; ++i) {
+    worker = &node->receive_workers[i];
+    ret = pthread_create(&worker->thread, NULL, uccn_receive_worker_main, worker);
+    if (ret != 0) {
+      errno = ret;
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to start receive worker"));
+      return -1;
+    }
+    worker->running = true;
+  }
+  return 0;
+}
+
+int uccn_stop_receive_workers(struct uccn_node_s * node)
+{
+  int ret = 0, iret;
+  size_t i;
+  bool running = false;
+  struct uccn_receive_worker_s * worker;
+
+  for (i = 0; i < CONFIG_UCCN_NUM_RECEIVE_WORKERS; ++i) {
+    running = running || node->receive_workers[i].running;
+  }
+  if (running && (iret = eventfd_set(&node->workers_stop_event)) < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to set node workers stop event"));
+    return iret;
+  }
+
+  for (i = 0; i < CONFIG_UCCN_NUM_RECEIVE_WORKERS; ++i) {
+    worker = &node->receive_workers[i];
+    if (worker->running) {
+      pthread_join(worker->thread, NULL);
+      worker->running = false;
+    }
+    if (worker->socket >= 0) {
+      if ((iret = close(worker->socket)) < 0) {
+        uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to close worker socket"));
+        ret = iret;
+      }
+      worker->socket = -1;
+    }
+  }
+  return ret;
+}
+
+#endif
+
+int uccn_spin(struct uccn_node_s * node, const struct timespec * timeout)
+{
+  int ret;
+  struct timespec timeout_time = TIMESPEC_INF;
+  if (timeout) {
+    if ((ret = clock_gettime(CLOCK_MONOTONIC, &timeout_time)) != 0) {
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
+      return ret;
+    }
+    timespec_add(&timeout_time, timeout);
+  }
+  return uccn_spin_until(node, &timeout_time);
+}
+
+int uccn_process_timers(struct uccn_node_s * node, struct timespec * next_deadline)
+{
+  int ret = 0;
+  bool peers_timed_out = false;
+  struct timespec current_time;
+  struct upoll_timer_s * timer;
+  struct uccn_peer_s * peer;
+  struct buffer_head_s * keepalive_packet = NULL;
+
+  assert(node != NULL);
+  assert(next_deadline != NULL);
+
+  if ((ret = clock_gettime(CLOCK_MONOTONIC, &current_time)) != 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
+    return ret;
+  }
+
+  // Only timers that went off are looked at, however many peers there are
+  upoll_wheel_advance(&node->timers.wheel, &current_time);
+  while (ret >= 0 && (timer = upoll_wheel_next_expired(&node->timers.wheel)) != NULL) {
+    if (timer == &node->timers.discovery_timer) {
+      if (uccn_count_active_trackers(node) < node->num_trackers) {
+        uccn_schedule_discovery(node, &current_time, true);
+        // Discovery packets take the outgoing buffer over
+        keepalive_packet = NULL;
+        if ((ret = uccn_discover_peers(node)) < 0) {
+          uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+        }
+      } else {
+        // Nothing to look for, keep the pace
+        uccn_schedule_discovery(node, &current_time, false);
+      }
+      continue;
+    }
+
+    peer = timer->arg;
+    if (timer == &peer->liveliness.remote_timer) {
+      // Deadlines move as peers are heard from, the timer catches up
+      if (timespec_cmp(&peer->liveliness.next_remote_deadline, &current_time) > 0) {
+        upoll_wheel_schedule(&node->timers.wheel, timer,
+                             &peer->liveliness.next_remote_deadline);
+        continue;
+      }
+      peer->alive = false;
+      uccn_release_peer(node, peer);
+      peers_timed_out = true;
+      continue;
+    }
+
+    assert(timer == &peer->liveliness.local_timer);
+    if (peer->num_links == 0) {
+      // Nothing in common, no need to keep in touch
+      uccn_release_peer(node, peer);
+      continue;
+    }
+    if (keepalive_packet == NULL) {
+      keepalive_packet = (struct buffer_head_s *)&node->outgoing_buffer;
+      if ((ret = uccn_prepare_keepalive_packet(node, keepalive_packet)) < 0) {
+        uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+        // Try again on the next pass
+        upoll_wheel_schedule(&node->timers.wheel, timer, &current_time);
+        break;
+      }
+    }
+    if ((ret = uccn_assert_liveliness(node, peer, keepalive_packet, &current_time)) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    }
+  }
+
+  // Links to peers that timed out go away with them, whatever happened
+  if (peers_timed_out && uccn_probe_endpoints(node) > 0) {
+    // Trackers lost their providers, which may be back soon
+    uccn_reset_discovery(node, &current_time, false);
+  }
+  if (ret < 0) {
+    return ret;
+  }
+
+  upoll_wheel_next_deadline(&node->timers.wheel, next_deadline);
+#if CONFIG_UCCN_FRAGMENTATION
+  uccn_expire_reassemblies(node, &current_time, next_deadline);
+#endif
+  assert(TIMESPEC_ISFINITE(next_deadline));
+
+  return 0;
+}
+
+int uccn_dispatch_event(struct uccn_node_s * node, int fd)
+{
+  int ret = 0;
+  size_t i;
+#if CONFIG_UCCN_EPOLL
+  uint64_t expirations;
+#endif
+#if CONFIG_UCCN_SHM_TRANSPORT
+  struct uccn_shm_channel_s * channel;
+#endif
+  struct uccn_watch_s watch;
+
+  if (fd == eventfd_fileno(&node->stop_event)) {
+    if ((ret = eventfd_clear(&node->stop_event)) < 0) {
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to clear node stop event"));
+      return ret;
+    }
+    return 1;
+  }
+
+  if (fd == eventfd_fileno(&node->wakeup_event)) {
+    // Being woken up is enough for the loop to re-evaluate its state
+    if ((ret = eventfd_clear(&node->wakeup_event)) < 0) {
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to clear node wakeup event"));
+    }
+    return ret;
+  }
+
+#if CONFIG_UCCN_EPOLL
+  if (fd == node->timer_fd) {
+    // Expired deadlines are processed on the next pass, just acknowledge them
+    if (read(node->timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN) {
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to read node timer"));
+      return -1;
+    }
+    return 0;
+  }
+#endif
+
+#if CONFIG_UCCN_MULTITHREADED
+  if ((ret = pthread_mutex_lock(&node->mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node mutex"));
+    return -1;
+  }
+#endif
+  watch.callback = NULL;
+  if (fd == node->socket) {
+    if ((ret = uccn_process_incoming_unicast(node)) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    }
+  } else if (fd == node->broadcast_socket) {
+    if ((ret = uccn_process_incoming_broadcast(node)) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    }
+#if CONFIG_UCCN_SHM_TRANSPORT
+  } else if (fd == node->shm_socket) {
+    if ((ret = uccn_accept_shm_channel(node)) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    }
+#endif
+  } else {
+#if CONFIG_UCCN_SHM_TRANSPORT
+    for (i = 0; i < CONFIG_UCCN_MAX_NUM_SHM_CHANNELS; ++i) {
+      channel = &node->shm_channels[i];
+      if (channel->attached && !channel->outgoing && channel->doorbell == fd) {
+        if ((ret = uccn_drain_shm_channel(node, channel)) < 0) {
+          uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+        }
+        break;
+      }
+    }
+#endif
+    for (i = 0; i < node->num_watches; ++i) {
+      if (node->watches[i].fd == fd) {
+        watch = node->watches[i];
+        break;
+      }
+    }
+  }
+#if CONFIG_UCCN_MULTITHREADED
+  uccn_unlock_node(node);
+#endif
+
+  // Watch callbacks run unlocked so that they can use the node API
+  if (watch.callback != NULL) {
+    watch.callback(watch.fd, watch.arg);
+  }
+  return ret;
+}
+
+#if CONFIG_UCCN_EPOLL
+
+int uccn_poll_events(struct uccn_node_s * node,
+                     const struct timespec * next_deadline,
+                     const struct timespec * timeout_time)
+{
+  int i, ret, nevents, timeout_ms;
+  struct itimerspec spec;
+  struct timespec current_time;
+  struct timespec stimeout;
+  struct epoll_event events[CONFIG_UCCN_MAX_NUM_WATCHES + 5];
+
+  // Only touch the timer when the earliest deadline actually moves
+  if (timespec_cmp(&node->timer_deadline, next_deadline) != 0) {
+    TIMESPEC_ZERO_INIT(&spec.it_interval);
+    spec.it_value = *next_deadline;
+    if ((ret = timerfd_settime(node->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL)) < 0) {
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to arm node timer"));
+      return ret;
+    }
+    node->timer_deadline = *next_deadline;
+  }
+
+  do {
+    timeout_ms = -1;
+    if (TIMESPEC_ISFINITE(timeout_time)) {
+      if ((ret = clock_gettime(CLOCK_MONOTONIC, &current_time)) != 0) {
+        uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
+        return ret;
+      }
+      timeout_ms = 0;
+      if (timespec_cmp(timeout_time, &current_time) > 0) {
+        stimeout = *timeout_time;
+        timespec_diff(&stimeout, &current_time);
+        if (stimeout.tv_sec < INT_MAX / 1000 - 1) {
+          timeout_ms = stimeout.tv_sec * 1000 + (stimeout.tv_nsec + 999999L) / 1000000L;
+        } else {
+          timeout_ms = INT_MAX;
+        }
+      }
+    }
+    nevents = epoll_wait(node->epoll_fd, events,
+                         sizeof(events) / sizeof(events[0]),
+                         timeout_ms);
+  } while (nevents < 0 && errno == EINTR);
+
+  if (nevents < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 4, "Failed to poll file descriptors"));
+    return nevents;
+  }
+
+  for (ret = 0, i = 0; i < nevents && ret == 0; ++i) {
+    if ((ret = uccn_dispatch_event(node, events[i].data.fd)) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    }
+  }
+  return ret;
+}
+
+#else
+
+int uccn_poll_events(struct uccn_node_s * node,
+                     const struct timespec * next_deadline,
+                     const struct timespec * timeout_time)
+{
+  int fd, ret, nfds;
+  size_t i;
+  fd_set rfds;
+  struct timespec stimeout;
+  struct timespec deadline;
+  struct timespec current_time;
+
+  deadline = *next_deadline;
+  if (timespec_cmp(&deadline, timeout_time) > 0) {
+    deadline = *timeout_time;
+  }
+
+  do {
+    FD_ZERO(&rfds);
+    FD_SET(node->socket, &rfds);
+    FD_SET(node->broadcast_socket, &rfds);
+    FD_SET(eventfd_fileno(&node->stop_event), &rfds);
+    FD_SET(eventfd_fileno(&node->wakeup_event), &rfds);
+    nfds = eventfd_fileno(&node->stop_event);
+    if (eventfd_fileno(&node->wakeup_event) > nfds) {
+      nfds = eventfd_fileno(&node->wakeup_event);
+    }
+    if (node->broadcast_socket > nfds) {
+      nfds = node->broadcast_socket;
+    }
+    if (node->socket > nfds) {
+      nfds = node->socket;
+    }
+#if CONFIG_UCCN_MULTITHREADED
+    if ((ret = pthread_mutex_lock(&node->mutex)) != 0) {
+      errno = ret;
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node mutex"));
+      return -1;
+    }
+#endif
+    for (i = 0; i < node->num_watches; ++i) {
+      FD_SET(node->watches[i].fd, &rfds);
+      if (node->watches[i].fd > nfds) {
+        nfds = node->watches[i].fd;
+      }
+    }
+#if CONFIG_UCCN_MULTITHREADED
+    uccn_unlock_node(node);
+#endif
+    nfds += 1;
+
+    if ((ret = clock_gettime(CLOCK_MONOTONIC, &current_time)) != 0) {
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
+      return ret;
+    }
+
+    TIMESPEC_ZERO_INIT(&stimeout);
+    if (timespec_cmp(&deadline, &current_time) > 0) {
+      stimeout = deadline;
+      timespec_diff(&stimeout, &current_time);
+    }
+    ret = pselect(nfds, &rfds, NULL, NULL, &stimeout, NULL);
+  } while (ret < 0 && errno == EINTR);
+
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to poll sockets"));
+    return ret;
+  }
+
+  for (ret = 0, fd = 0; fd < nfds && ret == 0; ++fd) {
+    if (FD_ISSET(fd, &rfds)) {
+      if ((ret = uccn_dispatch_event(node, fd)) < 0) {
+        uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+      }
+    }
+  }
+  return ret;
+}
+
+#endif
+
+int uccn_spin_until(struct uccn_node_s * node, const struct timespec * timeout_time)
+{
+  int ret;
+  struct timespec current_time;
+  struct timespec next_deadline;
+
+  assert(node != NULL);
+  assert(timeout_time != NULL);
+
+  do {
+#if CONFIG_UCCN_MULTITHREADED
+    ret = pthread_mutex_lock(&node->mutex);
+    if (ret < 0) {
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node mutex"));
+      break;
+    }
+#endif
+    ret = uccn_process_timers(node, &next_deadline);
+#if CONFIG_UCCN_MULTITHREADED
+    uccn_unlock_node(node);
+#endif
+    if (ret < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 5));
+      break;
+    }
+
+    if ((ret = uccn_poll_events(node, &next_deadline, timeout_time)) != 0) {
+      if (ret < 0) {
+        uccndbg(BACKTRACE_FROM(__LINE__ - 2));
+      }
+      break;
+    }
+
+    if ((ret = clock_gettime(CLOCK_MONOTONIC, &current_time)) != 0) {
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
+      break;
+    }
+  } while (timespec_cmp(&current_time, timeout_time) < 0);
+
+  return ret < 0 ? ret : 0;
 }
 
-int uccn_prepare_discovery_packet(struct uccn_node_s * node, struct buffer_head_s * packet)
+int uccn_watch(struct uccn_node_s * node, int fd, uccn_watch_fn callback, void * arg)
 {
+  int ret = 0;
   size_t i;
+#if CONFIG_UCCN_EPOLL
+  struct epoll_event event;
+#endif
 
-  mpack_error_t err;
-  mpack_writer_t writer;
+  assert(node != NULL);
+  assert(fd >= 0);
+  assert(callback != NULL);
 
-  uint32_t num_hashes = 0;
-  uint32_t hashes[CONFIG_UCCN_MAX_NUM_TRACKERS];
+#if CONFIG_UCCN_MULTITHREADED
+  if ((ret = pthread_mutex_lock(&node->mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node mutex"));
+    return -1;
+  }
+#endif
+  for (i = 0; i < node->num_watches; ++i) {
+    if (node->watches[i].fd == fd) {
+      uccndbg("Updating existing watch for fd %d", fd);
+      break;
+    }
+  }
+  if (i == node->num_watches) {
+    if (node->num_watches >= CONFIG_UCCN_MAX_NUM_WATCHES) {
+      uccnerr(RUNTIME_ERR("Too many watches"));
+      ret = -1;
+      goto leave_uccn_watch;
+    }
+#if CONFIG_UCCN_EPOLL
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if ((ret = epoll_ctl(node->epoll_fd, EPOLL_CTL_ADD, fd, &event)) < 0) {
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to watch fd %d", fd));
+      goto leave_uccn_watch;
+    }
+#endif
+    ++node->num_watches;
+  }
+  node->watches[i].fd = fd;
+  node->watches[i].callback = callback;
+  node->watches[i].arg = arg;
+ leave_uccn_watch:
+#if CONFIG_UCCN_MULTITHREADED
+  uccn_unlock_node(node);
+#endif
+  return ret;
+}
 
-  struct uccn_content_endpoint_s * endpoint;
+int uccn_unwatch(struct uccn_node_s * node, int fd)
+{
+  int ret = 0;
+  size_t i;
 
   assert(node != NULL);
-  assert(packet != NULL);
-  assert(packet->data != NULL);
 
-  mpack_writer_init(&writer, packet->data, packet->size);
-  mpack_start_map(&writer, 1);
-  {
-    mpack_write_u8(&writer, UCCN_LINK_GROUP);
-    mpack_start_map(&writer, 2);
-    {
-      mpack_write_u8(&writer, UCCN_NODE_NAME);
-      mpack_write_cstr(&writer, node->name);
-    }
-    {
-      mpack_write_u8(&writer, UCCN_TRACKED_ARRAY);
-      for (i = 0; i < node->num_trackers; ++i) {
-        endpoint = (struct uccn_content_endpoint_s *)&node->trackers[i];
-        if (endpoint->num_peers == 0) {
-          hashes[num_hashes++] = endpoint->resource->hash;
-        }
-      }
-      mpack_start_array(&writer, num_hashes);
-      {
-        for (i = 0; i < num_hashes; ++i) {
-          mpack_write_u32(&writer, hashes[i]);
-        }
+#if CONFIG_UCCN_MULTITHREADED
+  if ((ret = pthread_mutex_lock(&node->mutex)) != 0) {
+    errno = ret;
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node mutex"));
+    return -1;
+  }
+#endif
+  for (i = 0; i < node->num_watches; ++i) {
+    if (node->watches[i].fd == fd) {
+#if CONFIG_UCCN_EPOLL
+      if ((ret = epoll_ctl(node->epoll_fd, EPOLL_CTL_DEL, fd, NULL)) < 0) {
+        uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to unwatch fd %d", fd));
+        break;
       }
-      mpack_finish_array(&writer);
+#endif
+      node->watches[i] = node->watches[--node->num_watches];
+      ret = 1;
+      break;
     }
-    mpack_finish_map(&writer);
-  }
-  mpack_finish_map(&writer);
-  packet->length = mpack_writer_buffer_used(&writer);
-  if ((err = mpack_writer_destroy(&writer)) != mpack_ok) {
-    uccnerr(RUNTIME_ERR("Failed to build discovery packet: %s",
-                        mpack_error_to_string(err)));
-    return -1;
   }
-  return 0;
+#if CONFIG_UCCN_MULTITHREADED
+  uccn_unlock_node(node);
+#endif
+  return ret;
 }
 
-int uccn_assert_liveliness(struct uccn_node_s * node, struct timespec * next_deadline)
+#if CONFIG_UCCN_EPOLL
+int uccn_fileno(struct uccn_node_s * node)
 {
-  int ret;
+  assert(node != NULL);
+  return node->epoll_fd;
+}
+#endif
+
+void uccn_unlink_dead_peers(struct uccn_content_endpoint_s * endpoint) {
   size_t i;
-  ssize_t nbytes;
-  struct timespec current_time;
   struct uccn_peer_s * peer;
-  struct buffer_head_s * outgoing_packet;
 
-  outgoing_packet = (struct buffer_head_s *)&node->outgoing_buffer;
-  if ((ret = uccn_prepare_keepalive_packet(node, outgoing_packet)) < 0) {
-    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
-    return ret;
-  }
+  assert(endpoint != NULL);
 
-  if ((ret = clock_gettime(CLOCK_MONOTONIC, &current_time)) != 0) {
-    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
-    return ret;
+  i = 0;
+  uccn_begin_links_update(endpoint);
+  while (i < endpoint->num_peers) {
+    peer = uccn_peer_lookup(endpoint->node, endpoint->peers[i].handle);
+    if (peer == NULL || !peer->alive) {
+#if CONFIG_UCCN_SHM_TRANSPORT
+      // Posts check channels are still open before using them
+      if (endpoint->peers[i].channel != NULL) {
+        uccn_close_shm_channel(endpoint->node, endpoint->peers[i].channel);
+      }
+#endif
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+      if (endpoint->peers[i].checksums) {
+        --endpoint->num_checked_peers;
+      }
+#endif
+      endpoint->peers[i] = endpoint->peers[--endpoint->num_peers];
+      continue;
+    }
+    ++i;
   }
+  uccn_end_links_update(endpoint);
+}
 
-  if (next_deadline != NULL) {
-    *next_deadline = current_time;
-    timespec_add(next_deadline, &g_uccn_liveliness_assert_timeout);
-  }
+size_t uccn_probe_endpoints(struct uccn_node_s * node)
+{
+  size_t i, num_orphaned_trackers = 0;
+  struct uccn_content_endpoint_s * endpoint;
 
-  for (i = 0; i < node->num_peers; ++i) {
-    peer = &node->peers[i];
+  assert(node != NULL);
 
-    if (timespec_cmp(&current_time, &peer->liveliness.next_local_deadline) >= 0) {
-      nbytes = sendto(node->socket, outgoing_packet->data, outgoing_packet->length,
-                      0, (struct sockaddr *)&peer->address,
-                      sizeof(peer->address));
-      assert(nbytes < 0 || (size_t)nbytes == outgoing_packet->length);
-      if (nbytes < 0) {
-        uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to send keepalive packet"));
-        ret = nbytes;
-        break;
-      }
-      if (TIMESPEC_ISZERO(&peer->liveliness.next_local_deadline)) {
-        peer->liveliness.next_local_deadline = current_time;
+  for (i = 0; i < node->num_trackers; ++i) {
+    endpoint = (struct uccn_content_endpoint_s *)&node->trackers[i];
+    if (endpoint->num_peers > 0) {
+      uccn_unlink_dead_peers(endpoint);
+      if (endpoint->num_peers == 0) {
+        ++num_orphaned_trackers;
       }
-      timespec_add(&peer->liveliness.next_local_deadline, &g_uccn_liveliness_assert_timeout);
     }
+  }
 
-    if (next_deadline != NULL) {
-      if (timespec_cmp(next_deadline, &peer->liveliness.next_local_deadline) > 0) {
-        *next_deadline = peer->liveliness.next_local_deadline;
-      }
-    }
+  for (i = 0; i < node->num_providers; ++i) {
+    endpoint = (struct uccn_content_endpoint_s *)&node->providers[i];
+    uccn_unlink_dead_peers(endpoint);
   }
 
-  return ret;
+  return num_orphaned_trackers;
 }
 
-
-int uccn_discover_peers(struct uccn_node_s * node)
+size_t uccn_count_active_trackers(struct uccn_node_s * node)
 {
-  int ret = 0;
-  ssize_t nbytes;
-  struct buffer_head_s * outgoing_packet;
+  size_t i, num_active_trackers = 0;
 
-  outgoing_packet = (struct buffer_head_s *)&node->outgoing_buffer;
-  if ((ret = uccn_prepare_discovery_packet(node, outgoing_packet)) < 0) {
-    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
-    return ret;
+  for (i = 0; i < node->num_trackers; ++i) {
+    if (node->trackers[i].endpoint.num_peers > 0) {
+      ++num_active_trackers;
+    }
   }
+  return num_active_trackers;
+}
 
-  uccndbg("Attempting to discover peers");
-  nbytes = sendto(node->socket, outgoing_packet->data, outgoing_packet->length,
-                  0, (struct sockaddr *)&node->broadcast_address,
-                  sizeof(node->broadcast_address));
-  assert(nbytes < 0 || (size_t)nbytes == outgoing_packet->length);
-  if (nbytes < 0) {
-    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to send discovery packet"));
-    ret = nbytes;
+static bool uccn_verify_checksum(struct uccn_node_s * node,
+                                 const struct buffer_head_s * blob,
+                                 uint32_t checksum)
+{
+  if (crc32(blob->data, blob->length) == checksum) {
+    return true;
   }
+  // Counted rather than logged, corrupted links may well flood logs
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  __atomic_fetch_add(&node->num_checksum_mismatches, 1, __ATOMIC_RELAXED);
+#else
+  (void)node;
+#endif
+  return false;
+}
 
-  return ret;
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+unsigned long uccn_get_checksum_mismatches(struct uccn_node_s * node)
+{
+  return __atomic_load_n(&node->num_checksum_mismatches, __ATOMIC_RELAXED);
 }
+#endif
 
-int uccn_process_incoming_unicast(struct uccn_node_s * node)
+int uccn_dispatch_content(struct uccn_content_tracker_s * tracker,
+                          struct buffer_head_s * blob)
 {
   int ret;
-  ssize_t nbytes;
-  struct sockaddr_in address;
-  socklen_t address_size = sizeof(address);
-  struct buffer_head_s * incoming_packet;
-
-  assert(node != NULL);
-
-  incoming_packet = (struct buffer_head_s *)&node->incoming_buffer;
-  nbytes = recvfrom(
-      node->socket, incoming_packet->data, incoming_packet->size,
-      MSG_DONTWAIT, (struct sockaddr *)&address, &address_size);
-  if (nbytes < 0) {
-    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to receive packet"));
-    return nbytes;
-  }
-  incoming_packet->length = nbytes;
+  unsigned int bit;
+  void * content = NULL;
+  struct uccn_content_pool_s * pool = &tracker->pool;
+  struct uccn_content_endpoint_s * endpoint =
+      (struct uccn_content_endpoint_s *)tracker;
 
-  if (same_sockaddr_in(&address, &node->address)) {
-    uccnerr(RUNTIME_ERR("Port reuse is not supported"));
-    return -1;
+  if (pool->objects != NULL) {
+    if ((content = uccn_lend_content(pool)) == NULL) {
+      uccnwarn(RUNTIME_ERR("All '%s' content is kept, dropping new content",
+                           endpoint->resource->path));
+      return 0;
+    }
   }
-
-  if ((ret = uccn_process_incoming(node, &address, incoming_packet)) < 0) {
+  if ((ret = endpoint->resource->unpack(endpoint->resource, blob, &content)) < 0) {
     uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+  } else {
+    tracker->track(tracker, content);
+    ret = 0;
+  }
+  if (pool->objects != NULL) {
+    // Content goes back unless the callback kept it
+    bit = 1u << uccn_content_index(pool, content);
+    if (ret < 0 || !(__atomic_fetch_and(&pool->kept, ~bit, __ATOMIC_ACQ_REL) & bit)) {
+      uccn_give_back_content(pool, content);
+    }
   }
   return ret;
 }
 
-int uccn_process_incoming_broadcast(struct uccn_node_s * node)
+#if !CONFIG_UCCN_EXECUTOR
+static bool uccn_defer_content(struct uccn_node_s * node,
+                               struct uccn_content_tracker_s * tracker,
+                               struct buffer_head_s * blob, void * storage)
 {
-  int ret;
-  ssize_t nbytes;
-  struct sockaddr_in address;
-  socklen_t address_size = sizeof(address);
-  struct buffer_head_s * incoming_packet;
-
-  assert(node != NULL);
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+  struct uccn_deferred_content_s * deferred;
+  struct uccn_receive_worker_s * worker = node->deferring_worker;
 
-  incoming_packet = (struct buffer_head_s *)&node->incoming_buffer;
-  nbytes = recvfrom(
-      node->broadcast_socket, incoming_packet->data, incoming_packet->size,
-      MSG_DONTWAIT, (struct sockaddr *)&address, &address_size);
-  if (nbytes < 0) {
-    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to receive packet"));
-    return nbytes;
+  if (worker == NULL) {
+    return false;
   }
-  incoming_packet->length = nbytes;
+  // Workers make room for a packet full of content before processing it
+  assert(worker->num_deferred < UCCN_MAX_NUM_DEFERRED_CONTENT);
+  deferred = &worker->deferred[worker->num_deferred++];
+  deferred->tracker = tracker;
+  deferred->blob = *blob;
+  deferred->storage = storage;
+  return true;
+#else
+  (void)node;
+  (void)tracker;
+  (void)blob;
+  (void)storage;
+  return false;
+#endif
+}
+#endif
 
-  if (same_sockaddr_in(&address, &node->address)) {
-    // Ignoring broadcast to self
-    return 0;
-  }
+int uccn_process_content_blob(struct uccn_node_s * node, struct uccn_peer_s * peer,
+                              uint32_t hash, struct buffer_head_s * blob, void * storage)
+{
+  int ret = 0;
 
-  if ((ret = uccn_process_incoming(node, &address, incoming_packet)) < 0) {
-    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+  struct uccn_content_tracker_s * tracker;
+  struct uccn_content_endpoint_s * endpoint;
+
+  tracker = hash_index_find(&node->tracker_index, hash);
+  if (tracker != NULL) {
+    endpoint = (struct uccn_content_endpoint_s *)tracker;
+
+#if CONFIG_UCCN_EXECUTOR
+    // Executor threads take it from here, storage included
+    ret = uccn_enqueue_content(node, tracker, blob, storage);
+    storage = NULL;
+    if (ret < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+      return ret;
+    }
+#else
+    // Receive workers unpack and dispatch content once the node is unlocked
+    if (uccn_defer_content(node, tracker, blob, storage)) {
+      storage = NULL;
+    } else if ((ret = uccn_dispatch_content(tracker, blob)) < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+      free(storage);
+      return ret;
+    }
+#endif
+
+    if ((ret = uccn_link(endpoint, peer)) != 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    }
   }
+  // Reassembled content is freed here unless a worker took it over
+  free(storage);
+
   return ret;
 }
 
+#if CONFIG_UCCN_FRAGMENTATION
 
-int uccn_process_incoming(struct uccn_node_s * node,
-                          struct sockaddr_in * origin,
-                          struct buffer_head_s * incoming_packet)
+void uccn_release_reassembly(struct uccn_reassembly_s * reassembly)
 {
-  int ret;
-  ssize_t nbytes;
-  struct uccn_peer_s * peer;
-  struct buffer_head_s * outgoing_packet;
+  free(reassembly->buffer.data);
+  memset(reassembly, 0, sizeof(*reassembly));
+}
 
-  if ((peer = uccn_register_peer(node, origin)) == NULL) {
-    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
-    return -1;
-  }
+void uccn_expire_reassemblies(struct uccn_node_s * node,
+                              const struct timespec * current_time,
+                              struct timespec * next_deadline)
+{
+  size_t i;
+  struct uccn_reassembly_s * reassembly;
 
-  outgoing_packet = (struct buffer_head_s *)&node->outgoing_buffer;
-  ret = uccn_process_packet(node, peer, incoming_packet, outgoing_packet);
-  if (ret < 0) {
-    uccndbg(BACKTRACE_FROM(__LINE__ - 2));
-    return ret;
+  for (i = 0; i < CONFIG_UCCN_MAX_NUM_REASSEMBLIES; ++i) {
+    reassembly = &node->reassemblies[i];
+    if (reassembly->peer == UCCN_NULL_PEER_HANDLE || reassembly->buffer.data == NULL) {
+      continue;
+    }
+    if (timespec_cmp(current_time, &reassembly->deadline) >= 0) {
+      uccnwarn(RUNTIME_ERR("Timed out reassembling content (%hu out of %hu fragments)",
+                           reassembly->num_received, reassembly->num_fragments));
+      // Done with, as if complete, for the rest to be turned away
+      free(reassembly->buffer.data);
+      reassembly->buffer.data = NULL;
+      continue;
+    }
+    if (timespec_cmp(next_deadline, &reassembly->deadline) > 0) {
+      *next_deadline = reassembly->deadline;
+    }
   }
+}
 
-  if (outgoing_packet->length > 0) {
-    nbytes = sendto(
-        node->socket, outgoing_packet->data, outgoing_packet->length, 0,
-        (struct sockaddr *)&peer->address, sizeof(peer->address));
-    assert(nbytes < 0 || (size_t)nbytes == outgoing_packet->length);
-    if (nbytes < 0) {
-      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to send packet"));
-      return nbytes;
+static struct uccn_reassembly_s *
+uccn_find_reassembly(struct uccn_node_s * node, uccn_peer_handle_t peer, uint32_t hash)
+{
+  size_t i;
+  struct uccn_reassembly_s * reassembly;
+  struct uccn_reassembly_s * oldest = NULL;
+
+  for (i = 0; i < CONFIG_UCCN_MAX_NUM_REASSEMBLIES; ++i) {
+    reassembly = &node->reassemblies[i];
+    if (reassembly->peer == peer && reassembly->hash == hash) {
+      return reassembly;
     }
   }
-
-  return 0;
+  // Otherwise, take a free or complete slot, or evict the stalest one
+  for (i = 0; i < CONFIG_UCCN_MAX_NUM_REASSEMBLIES; ++i) {
+    reassembly = &node->reassemblies[i];
+    if (reassembly->peer == UCCN_NULL_PEER_HANDLE || reassembly->buffer.data == NULL) {
+      uccn_release_reassembly(reassembly);
+      return reassembly;
+    }
+    if (oldest == NULL || timespec_cmp(&oldest->deadline, &reassembly->deadline) > 0) {
+      oldest = reassembly;
+    }
+  }
+  uccnwarn(RUNTIME_ERR("Too many reassemblies, dropping oldest"));
+  uccn_release_reassembly(oldest);
+  return oldest;
 }
 
-int uccn_spin(struct uccn_node_s * node, const struct timespec * timeout)
+int uccn_process_content_fragment(struct uccn_node_s * node, struct uccn_peer_s * peer,
+                                  uint32_t hash, mpack_reader_t * reader)
 {
-  int ret;
-  struct timespec timeout_time = TIMESPEC_INF;
-  if (timeout) {
-    if ((ret = clock_gettime(CLOCK_MONOTONIC, &timeout_time)) != 0) {
-      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
-      return ret;
-    }
-    timespec_add(&timeout_time, timeout);
+  int ret = 0;
+  uint32_t sequence, total_length, checksum = 0;
+  uint32_t num_fields;
+  uint16_t index, num_fragments;
+  size_t offset, fragment_size;
+  struct buffer_head_s fragment;
+  struct timespec current_time;
+  uccn_peer_handle_t handle;
+  struct uccn_reassembly_s * reassembly;
+
+  num_fields = mpack_expect_array_range(reader, UCCN_NUM_FRAGMENT_FIELDS,
+                                        UCCN_NUM_FRAGMENT_FIELDS + 1);
+  sequence = mpack_expect_u32(reader);
+  index = mpack_expect_u16(reader);
+  num_fragments = mpack_expect_u16(reader);
+  total_length = mpack_expect_u32(reader);
+  if (num_fields > UCCN_NUM_FRAGMENT_FIELDS) {
+    checksum = mpack_expect_u32(reader);
+  }
+  fragment.length = fragment.size = mpack_expect_bin(reader);
+  fragment.data = (void *)mpack_read_bytes_inplace(reader, fragment.length);
+  mpack_done_array(reader);
+  if (mpack_reader_error(reader) != mpack_ok) {
+    return -1;
+  }
+  if (num_fields > UCCN_NUM_FRAGMENT_FIELDS &&
+      !uccn_verify_checksum(node, &fragment, checksum)) {
+    return 0;
+  }
+
+  if (index >= num_fragments || total_length < num_fragments ||
+      total_length > CONFIG_UCCN_MAX_REASSEMBLY_SIZE) {
+    uccnerr(RUNTIME_ERR("Bad content fragment %hu out of %hu (%u bytes total)",
+                        index, num_fragments, total_length));
+    return -1;
+  }
+  fragment_size = (total_length + num_fragments - 1) / num_fragments;
+  offset = index * fragment_size;
+  if (offset >= total_length || fragment.length !=
+      (total_length - offset < fragment_size ? total_length - offset : fragment_size)) {
+    uccnerr(RUNTIME_ERR("Content fragment %hu out of %hu has a bad size", index, num_fragments));
+    return -1;
+  }
+
+  if (hash_index_find(&node->tracker_index, hash) == NULL) {
+    // Nobody to reassemble content for
+    return 0;
   }
-  return uccn_spin_until(node, &timeout_time);
-}
 
-int uccn_spin_until(struct uccn_node_s * node, const struct timespec * timeout_time)
-{
-  fd_set rfds;
-  int nfds, nret = 0, ret = 0;
-  size_t num_active_trackers;
-  struct timespec stimeout;
-  struct timespec current_time;
-  struct timespec next_deadline;
-  struct timespec next_probe_time;
-  struct timespec next_assert_time;
-  struct timespec next_discovery_time;
+  if (num_fragments == 1) {
+    return uccn_process_content_blob(node, peer, hash, &fragment, NULL);
+  }
 
-  assert(node != NULL);
-  assert(timeout_time != NULL);
+  handle = uccn_peer_handle(node, peer);
+  reassembly = uccn_find_reassembly(node, handle, hash);
+  if (reassembly->peer != UCCN_NULL_PEER_HANDLE) {
+    if ((int32_t)(sequence - reassembly->sequence) < 0 ||
+        (sequence == reassembly->sequence && reassembly->buffer.data == NULL)) {
+      // Late fragment from content that was already superseded or complete
+      return 0;
+    }
+    if (sequence != reassembly->sequence) {
+      if (reassembly->buffer.data != NULL) {
+        uccnwarn(RUNTIME_ERR("Dropping incomplete content from %s (%hu out of %hu fragments)",
+                             peer->location, reassembly->num_received,
+                             reassembly->num_fragments));
+      }
+      uccn_release_reassembly(reassembly);
+    }
+  }
+  if (reassembly->peer == UCCN_NULL_PEER_HANDLE) {
+    // Keep track of received fragments right after the content itself
+    reassembly->buffer.data = malloc(total_length + (num_fragments + 7) / 8);
+    if (reassembly->buffer.data == NULL) {
+      uccnerr(RUNTIME_ERR("Failed to allocate %u bytes for content reassembly", total_length));
+      return -1;
+    }
+    reassembly->buffer.size = reassembly->buffer.length = total_length;
+    reassembly->received = (uint8_t *)reassembly->buffer.data + total_length;
+    memset(reassembly->received, 0, (num_fragments + 7) / 8);
+    reassembly->peer = handle;
+    reassembly->hash = hash;
+    reassembly->sequence = sequence;
+    reassembly->num_fragments = num_fragments;
+    reassembly->num_received = 0;
+  }
+  if (reassembly->num_fragments != num_fragments ||
+      reassembly->buffer.length != total_length) {
+    uccnerr(RUNTIME_ERR("Content fragment %hu does not match the rest", index));
+    uccn_release_reassembly(reassembly);
+    return -1;
+  }
 
   if ((ret = clock_gettime(CLOCK_MONOTONIC, &current_time)) != 0) {
     uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
     return ret;
   }
-  next_assert_time = current_time;
-  next_discovery_time = current_time;
-  next_probe_time = current_time;
+  reassembly->deadline = current_time;
+  timespec_add(&reassembly->deadline, &g_uccn_reassembly_timeout);
 
-  FD_ZERO(&rfds);
-  nfds = eventfd_fileno(&node->stop_event);
-  if (node->broadcast_socket > nfds) {
-    nfds = node->broadcast_socket;
-  }
-  if (node->socket > nfds) {
-    nfds = node->socket;
+  if (reassembly->received[index / 8] & (1u << (index % 8))) {
+    return 0;  // duplicate
   }
-  nfds += 1;
-
-  do {
-#if CONFIG_UCCN_MULTITHREADED
-    ret = pthread_mutex_lock(&node->mutex);
+  memcpy((char *)reassembly->buffer.data + offset, fragment.data, fragment.length);
+  reassembly->received[index / 8] |= (1u << (index % 8));
+
+  if (++reassembly->num_received == reassembly->num_fragments) {
+    // Hand the reassembled buffer over as is, along with its ownership.
+    // The slot stays around, without it, to turn late fragments away.
+    fragment = reassembly->buffer;
+    reassembly->buffer.data = NULL;
+    ret = uccn_process_content_blob(node, peer, hash, &fragment, fragment.data);
     if (ret < 0) {
-      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock node mutex"));
-      break;
+      uccndbg(BACKTRACE_FROM(__LINE__ - 2));
     }
+  }
+  return ret;
+}
+
 #endif
-    if (nret > 0) {
-      if (FD_ISSET(eventfd_fileno(&node->stop_event), &rfds)) {
-        ret = eventfd_clear(&node->stop_event);
-        if (ret < 0) {
-          uccndbg(BACKTRACE_FROM(__LINE__ - 2));
-#if CONFIG_UCCN_MULTITHREADED
-          assert(pthread_mutex_unlock(&node->mutex) == 0);
-#endif
-        }
+
+int uccn_process_content_group(struct uccn_node_s * node, struct uccn_peer_s * peer, mpack_reader_t * reader)
+{
+  int ret = 0;
+  bool checked;
+  mpack_tag_t tag;
+  uint32_t hash, checksum = 0;
+  uint32_t i, group_size;
+  struct buffer_head_s blob;
+
+  assert(node != NULL);
+  assert(peer != NULL);
+  assert(reader != NULL);
+
+  if (mpack_expect_map_or_nil(reader, &group_size)) {
+    for (i = 0; i < group_size; ++i) {
+      hash = mpack_expect_u32(reader);
+      if (hash == 0) {
+        uccnerr(RUNTIME_ERR("Content hash missing"));
+        ret = -1;
         break;
       }
-      if (FD_ISSET(node->socket, &rfds)) {
-        if ((ret = uccn_process_incoming_unicast(node)) < 0) {
-          uccndbg(BACKTRACE_FROM(__LINE__ - 1));
-#if CONFIG_UCCN_MULTITHREADED
-          assert(pthread_mutex_unlock(&node->mutex) == 0);
-#endif
+      tag = mpack_peek_tag(reader);
+      checked = tag.type == mpack_type_array && tag.v.n == 2;
+#if CONFIG_UCCN_FRAGMENTATION
+      if (tag.type == mpack_type_array && !checked) {
+        ret = uccn_process_content_fragment(node, peer, hash, reader);
+        if (ret != 0) {
+          uccndbg(BACKTRACE_FROM(__LINE__ - 2));
           break;
         }
+        continue;
       }
-      if (FD_ISSET(node->broadcast_socket, &rfds)) {
-        if ((ret = uccn_process_incoming_broadcast(node)) < 0) {
-          uccndbg(BACKTRACE_FROM(__LINE__ - 1));
-#if CONFIG_UCCN_MULTITHREADED
-          assert(pthread_mutex_unlock(&node->mutex) == 0);
 #endif
-          break;
+      if (checked) {
+        mpack_expect_array_match(reader, 2);
+        checksum = mpack_expect_u32(reader);
+      }
+      blob.length = blob.size = mpack_expect_bin(reader);
+      if (blob.length == 0) {
+        uccnerr(RUNTIME_ERR("Content blob missing"));
+        ret = -1;
+        break;
+      }
+      blob.data = (void *)mpack_read_bytes_inplace(reader, blob.length);
+      if (blob.data == NULL) {
+        uccnerr(RUNTIME_ERR("Failed to read content blob inplace"));
+        ret = -1;
+        break;
+      }
+      if (checked) {
+        mpack_done_array(reader);
+        if (!uccn_verify_checksum(node, &blob, checksum)) {
+          continue;
         }
       }
+      ret = uccn_process_content_blob(node, peer, hash, &blob, NULL);
+      if (ret != 0) {
+        uccndbg(BACKTRACE_FROM(__LINE__ - 2));
+        break;
+      }
     }
+    mpack_done_map(reader);
+  }
 
-    if ((ret = clock_gettime(CLOCK_MONOTONIC, &current_time)) != 0) {
-      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
-#if CONFIG_UCCN_MULTITHREADED
-      assert(pthread_mutex_unlock(&node->mutex) == 0);
-#endif
-      break;
-    }
+  return ret;
+}
 
-    if (timespec_cmp(&current_time, &next_assert_time) >= 0) {
-      if ((ret = uccn_assert_liveliness(node, &next_assert_time)) < 0) {
-        uccndbg(BACKTRACE_FROM(__LINE__ - 1));
-#if CONFIG_UCCN_MULTITHREADED
-        assert(pthread_mutex_unlock(&node->mutex) == 0);
-#endif
-        break;
+void uccn_begin_links_update(struct uccn_content_endpoint_s * endpoint)
+{
+  __atomic_store_n(&endpoint->sequence, endpoint->sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+void uccn_end_links_update(struct uccn_content_endpoint_s * endpoint)
+{
+  __atomic_store_n(&endpoint->sequence, endpoint->sequence + 1, __ATOMIC_RELEASE);
+}
+
+size_t uccn_read_links(struct uccn_content_endpoint_s * endpoint, size_t offset,
+                       struct uccn_link_s * links, size_t max_num_links,
+                       size_t * num_peers)
+{
+  size_t num_links;
+  unsigned int sequence;
+
+  do {
+    while ((sequence = __atomic_load_n(&endpoint->sequence, __ATOMIC_ACQUIRE)) & 1) {
+      sched_yield();
+    }
+    *num_peers = __atomic_load_n(&endpoint->num_peers, __ATOMIC_RELAXED);
+    num_links = 0;
+    if (offset < *num_peers) {
+      num_links = *num_peers - offset;
+      if (num_links > max_num_links) {
+        num_links = max_num_links;
       }
-      assert(timespec_cmp(&next_assert_time, &current_time) > 0);
+      memcpy(links, &endpoint->peers[offset], num_links * sizeof(*links));
     }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while (__atomic_load_n(&endpoint->sequence, __ATOMIC_RELAXED) != sequence);
+  return num_links;
+}
 
-    if (timespec_cmp(&current_time, &next_probe_time) >= 0) {
-      if ((ret = uccn_probe_endpoints(node, &num_active_trackers,
-                                      NULL, &next_probe_time)) < 0) {
-        uccndbg(BACKTRACE_FROM(__LINE__ - 2));
-#if CONFIG_UCCN_MULTITHREADED
-        assert(pthread_mutex_unlock(&node->mutex) == 0);
+int uccn_link(struct uccn_content_endpoint_s * endpoint, struct uccn_peer_s * peer)
+{
+  size_t i;
+  uccn_peer_handle_t handle = uccn_peer_handle(endpoint->node, peer);
+
+  for (i = 0; i < endpoint->num_peers; ++i) {
+    if (endpoint->peers[i].handle == handle) {
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+      if (endpoint->peers[i].checksums != peer->checksums) {
+        // Peers only tell once they are linked
+        uccn_begin_links_update(endpoint);
+        endpoint->peers[i].checksums = peer->checksums;
+        endpoint->num_checked_peers += peer->checksums ? 1 : -1;
+        uccn_end_links_update(endpoint);
+      }
 #endif
-        break;
+#if CONFIG_UCCN_MULTICAST_CONTENT
+      if (endpoint->peers[i].multicast != peer->multicast) {
+        uccn_begin_links_update(endpoint);
+        endpoint->peers[i].multicast = peer->multicast;
+        uccn_end_links_update(endpoint);
       }
-      assert(timespec_cmp(&next_probe_time, &current_time) > 0);
+#endif
+      return 0;
     }
+  }
 
-    if (timespec_cmp(&current_time, &next_discovery_time) >= 0) {
-      if (num_active_trackers < node->num_trackers) {
-        if ((ret = uccn_discover_peers(node)) < 0) {
-          uccndbg(BACKTRACE_FROM(__LINE__ - 1));
-#if CONFIG_UCCN_MULTITHREADED
-          assert(pthread_mutex_unlock(&node->mutex) == 0);
+  if (endpoint->num_peers >= endpoint->node->capacity.max_num_peers) {
+    uccnerr(RUNTIME_ERR("Too many peers"));
+    return -1;
+  }
+
+  uccn_begin_links_update(endpoint);
+  endpoint->peers[endpoint->num_peers].handle = handle;
+  endpoint->peers[endpoint->num_peers].address = peer->address;
+#if CONFIG_UCCN_MULTICAST_CONTENT
+  endpoint->peers[endpoint->num_peers].multicast = peer->multicast;
 #endif
-          break;
-        }
+#if CONFIG_UCCN_SHM_TRANSPORT
+  endpoint->peers[endpoint->num_peers].channel = NULL;
+#endif
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  endpoint->peers[endpoint->num_peers].checksums = peer->checksums;
+  if (peer->checksums) {
+    ++endpoint->num_checked_peers;
+  }
+#endif
+  ++endpoint->num_peers;
+  uccn_end_links_update(endpoint);
+  ++peer->num_links;
+  return 1;
+}
+
+int uccn_unlink(struct uccn_content_endpoint_s * endpoint, struct uccn_peer_s * peer)
+{
+  size_t i;
+  uccn_peer_handle_t handle = uccn_peer_handle(endpoint->node, peer);
+
+  for (i = 0; i < endpoint->num_peers; ++i) {
+    if (endpoint->peers[i].handle == handle) {
+#if CONFIG_UCCN_SHM_TRANSPORT
+      if (endpoint->peers[i].channel != NULL) {
+        uccn_close_shm_channel(endpoint->node, endpoint->peers[i].channel);
+      }
+#endif
+      // Link order carries no meaning, fill the gap with the last one
+      uccn_begin_links_update(endpoint);
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+      if (endpoint->peers[i].checksums) {
+        --endpoint->num_checked_peers;
       }
-      timespec_add(&next_discovery_time, &g_uccn_peer_discovery_period);
-      assert(timespec_cmp(&next_discovery_time, &current_time) > 0);
+#endif
+      endpoint->peers[i] = endpoint->peers[--endpoint->num_peers];
+      uccn_end_links_update(endpoint);
+      --peer->num_links;
+      return 1;
     }
+  }
+  return 0;
+}
 
-#if CONFIG_UCCN_MULTITHREADED
-    assert(pthread_mutex_unlock(&node->mutex) == 0);
-#endif
+#if CONFIG_UCCN_SHM_TRANSPORT
 
-    if ((ret = clock_gettime(CLOCK_MONOTONIC, &current_time)) != 0) {
-      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
-      break;
-    }
+static bool uccn_is_local_peer(const struct uccn_node_s * node,
+                               const struct uccn_peer_s * peer)
+{
+  return peer->address.sin_addr.s_addr == node->address.sin_addr.s_addr ||
+      (ntohl(peer->address.sin_addr.s_addr) >> IN_CLASSA_NSHIFT) == IN_LOOPBACKNET;
+}
 
-    if (timespec_cmp(&current_time, timeout_time) >= 0) {
-      break;
-    }
-    next_deadline = *timeout_time;
-    if (timespec_cmp(&next_deadline, &next_assert_time) > 0) {
-      next_deadline = next_assert_time;
-    }
-    if (timespec_cmp(&next_deadline, &next_probe_time) > 0) {
-      next_deadline = next_probe_time;
-    }
-    if (timespec_cmp(&next_deadline, &next_discovery_time) > 0) {
-      next_deadline = next_discovery_time;
-    }
-    assert(TIMESPEC_ISFINITE(&next_deadline));
+static int uccn_parse_shm_address(const struct sockaddr_un * shm_address,
+                                  socklen_t shm_address_size,
+                                  struct sockaddr_in * address)
+{
+  unsigned short port;
+  char name[sizeof(shm_address->sun_path)];
+  char location[INET_ADDRSTRLEN];
+  size_t length = shm_address_size - offsetof(struct sockaddr_un, sun_path);
 
-    do {
-      FD_ZERO(&rfds);
-      FD_SET(node->socket, &rfds);
-      FD_SET(node->broadcast_socket, &rfds);
-      FD_SET(eventfd_fileno(&node->stop_event), &rfds);
+  if (shm_address_size <= offsetof(struct sockaddr_un, sun_path) + 1 ||
+      shm_address->sun_path[0] != '\0' || length > sizeof(name)) {
+    return -1;
+  }
+  memcpy(name, &shm_address->sun_path[1], length - 1);
+  name[length - 1] = '\0';
+  if (sscanf(name, "uccn/%15[0-9.]:%hu", location, &port) != 2) {
+    return -1;
+  }
+  memset(address, 0, sizeof(*address));
+  address->sin_family = AF_INET;
+  address->sin_port = htons(port);
+  return inet_pton(AF_INET, location, &address->sin_addr) == 1 ? 0 : -1;
+}
 
-      if ((ret = clock_gettime(CLOCK_MONOTONIC, &current_time)) != 0) {
-        uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
-        break;
-      }
+static struct uccn_shm_channel_s * uccn_claim_shm_channel(struct uccn_node_s * node)
+{
+  size_t i;
 
-      stimeout = next_deadline;
-      timespec_diff(&stimeout, &current_time);
-      ret = nret = pselect(nfds, &rfds, NULL, NULL, &stimeout, NULL);
-    } while (ret < 0 && errno == EINTR);
+  // Rings still in use by posts are unmapped once they are done with them
+  for (i = 0; i < CONFIG_UCCN_MAX_NUM_SHM_CHANNELS; ++i) {
+    if (__atomic_load_n(&node->shm_channels[i].ring, __ATOMIC_ACQUIRE) == NULL) {
+      return &node->shm_channels[i];
+    }
+  }
+  return NULL;
+}
 
-    if (ret < 0) {
-      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 3, "Failed to poll sockets"));
+// Hands a claimed channel over to posts, holding it on behalf of the node
+static void uccn_attach_shm_channel(struct uccn_shm_channel_s * channel)
+{
+  channel->attached = true;
+  __atomic_store_n(&channel->refs, 1, __ATOMIC_RELEASE);
+}
+
+// Fails if the channel is already on its way out
+static bool uccn_hold_shm_channel(struct uccn_shm_channel_s * channel)
+{
+  unsigned int refs = __atomic_load_n(&channel->refs, __ATOMIC_RELAXED);
+
+  do {
+    if (refs == 0) {
+      return false;
     }
-  } while (ret >= 0);
+  } while (!__atomic_compare_exchange_n(&channel->refs, &refs, refs + 1, true,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+  return true;
+}
 
-  return ret;
+static void uccn_release_shm_channel(struct uccn_shm_channel_s * channel)
+{
+  if (__atomic_sub_fetch(&channel->refs, 1, __ATOMIC_ACQ_REL) > 0) {
+    return;
+  }
+  if (close(channel->doorbell) < 0) {
+    uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to close ring doorbell"));
+  }
+  if (munmap(channel->ring, shm_ring_footprint(channel->capacity)) < 0) {
+    uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to unmap ring memory"));
+  }
+  // Only now may the node claim it again
+  __atomic_store_n(&channel->ring, NULL, __ATOMIC_RELEASE);
 }
 
-void uccn_unlink_dead_peers(struct uccn_content_endpoint_s * endpoint) {
-  size_t i, j;
+static struct uccn_peer_s *
+uccn_find_peer(struct uccn_node_s * node, const struct sockaddr_in * address)
+{
+  size_t i;
 
-  assert(endpoint != NULL);
+  for (i = 0; i < node->capacity.max_num_peers; ++i) {
+    if (node->peers[i].in_use && same_sockaddr_in(&node->peers[i].address, address)) {
+      return &node->peers[i];
+    }
+  }
+  return NULL;
+}
+
+static struct uccn_link_s *
+uccn_find_link(struct uccn_content_endpoint_s * endpoint, uccn_peer_handle_t handle)
+{
+  size_t i;
 
   for (i = 0; i < endpoint->num_peers; ++i) {
-    if (!endpoint->peers[i]->alive) {
-      for (j = i; j < endpoint->num_peers - 1; ++j) {
-        endpoint->peers[j] = endpoint->peers[j + 1];
-      }
-      --endpoint->num_peers, --i;
+    if (endpoint->peers[i].handle == handle) {
+      return &endpoint->peers[i];
     }
   }
+  return NULL;
 }
 
-int uccn_probe_endpoints(struct uccn_node_s * node,
-                         size_t * num_active_trackers,
-                         size_t * num_active_providers,
-                         struct timespec * next_probe_time)
+static void uccn_set_link_channel(struct uccn_content_endpoint_s * endpoint,
+                                  struct uccn_link_s * link,
+                                  struct uccn_shm_channel_s * channel)
 {
-  int ret;
-  size_t i, j;
-  struct timespec current_time;
+  struct uccn_shm_channel_s * previous_channel = link->channel;
 
-  struct uccn_peer_s * peer;
-  struct uccn_content_endpoint_s * endpoint;
-  struct timespec * peer_liveliness_deadline;
+  uccn_begin_links_update(endpoint);
+  link->channel = channel;
+  uccn_end_links_update(endpoint);
+  if (previous_channel != NULL) {
+    uccn_close_shm_channel(endpoint->node, previous_channel);
+  }
+}
 
-  assert(node != NULL);
+int uccn_offer_shm_channel(struct uccn_node_s * node, struct uccn_peer_s * peer, uint32_t hash)
+{
+  int ret, memfd = -1, doorbell = -1;
+  size_t footprint;
+  ssize_t nbytes;
+  void * ring = MAP_FAILED;
+  struct iovec iov;
+  struct msghdr msg;
+  struct cmsghdr * cmsg;
+  union {
+    struct cmsghdr header;
+    char data[CMSG_SPACE(2 * sizeof(int))];
+  } control;
+  struct epoll_event event;
+  struct sockaddr_un shm_address;
+  struct uccn_shm_offer_s offer;
+  struct uccn_shm_channel_s * channel;
+  struct uccn_content_tracker_s * tracker;
+  struct uccn_link_s * link;
+  uccn_peer_handle_t handle = uccn_peer_handle(node, peer);
 
-  if (num_active_trackers != NULL) {
-    *num_active_trackers = 0;
+  if (!uccn_is_local_peer(node, peer)) {
+    return 0;
+  }
+#if CONFIG_UCCN_MULTICAST_CONTENT
+  if (peer->multicast) {
+    // Content from resource groups comes back to this host regardless
+    return 0;
+  }
+#endif
+  if ((tracker = hash_index_find(&node->tracker_index, hash)) == NULL) {
+    return 0;
+  }
+  if ((link = uccn_find_link(&tracker->endpoint, handle)) == NULL || link->channel != NULL) {
+    return 0;
   }
-  if (num_active_providers != NULL) {
-    *num_active_providers = 0;
+  if ((channel = uccn_claim_shm_channel(node)) == NULL) {
+    uccndbg("No room for a ring from %s@%s, using UDP", peer->name, peer->location);
+    return 0;
   }
 
-  if ((ret = clock_gettime(CLOCK_MONOTONIC, &current_time)) != 0) {
-    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
-    return ret;
+  footprint = shm_ring_footprint(CONFIG_UCCN_SHM_RING_SIZE);
+  if ((memfd = memfd_create("uccn", MFD_CLOEXEC | MFD_ALLOW_SEALING)) < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to create ring memory"));
+    ret = memfd;
+    goto fail;
+  }
+  if ((ret = ftruncate(memfd, footprint)) < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to size ring memory"));
+    goto fail;
+  }
+  // Neither end may pull memory from under the other
+  if ((ret = fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)) < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to seal ring memory"));
+    goto fail;
+  }
+  ring = mmap(NULL, footprint, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+  if (ring == MAP_FAILED) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to map ring memory"));
+    ret = -1;
+    goto fail;
   }
+  shm_ring_init(ring, CONFIG_UCCN_SHM_RING_SIZE);
 
-  for (i = 0; i < node->num_peers; ++i) {
-    peer = &node->peers[i];
+  if ((doorbell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to create ring doorbell"));
+    ret = doorbell;
+    goto fail;
+  }
 
-    peer_liveliness_deadline = &peer->liveliness.next_remote_deadline;
-    peer->alive = (timespec_cmp(peer_liveliness_deadline, &current_time) >= 0);
+  offer.magic = UCCN_SHM_OFFER_MAGIC;
+  offer.hash = hash;
+  offer.capacity = CONFIG_UCCN_SHM_RING_SIZE;
+  iov.iov_base = &offer;
+  iov.iov_len = sizeof(offer);
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_name = &shm_address;
+  msg.msg_namelen = uccn_shm_address(&peer->address, &shm_address);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.data;
+  msg.msg_controllen = sizeof(control.data);
+  cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &memfd, sizeof(int));
+  memcpy(CMSG_DATA(cmsg) + sizeof(int), &doorbell, sizeof(int));
+  if ((nbytes = sendmsg(node->shm_socket, &msg, 0)) < 0) {
+    // Peers that cannot take rings, e.g. built without them, get UDP
+    uccndbg("Peer %s@%s takes no rings (%s), using UDP",
+            peer->name, peer->location, strerror(errno));
+    ret = 0;
+    goto fail;
   }
+  // The peer holds its own reference to the memory from now on
+  if (close(memfd) < 0) {
+    uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to close ring memory"));
+  }
+  memfd = -1;
 
-  for (i = 0; i < node->num_trackers; ++i) {
-    endpoint = (struct uccn_content_endpoint_s *)&node->trackers[i];
+  event.events = EPOLLIN;
+  event.data.fd = doorbell;
+  if ((ret = epoll_ctl(node->epoll_fd, EPOLL_CTL_ADD, doorbell, &event)) < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to register ring doorbell"));
+    goto fail;
+  }
 
-    uccn_unlink_dead_peers(endpoint);
+  channel->peer = handle;
+  channel->hash = hash;
+  channel->outgoing = false;
+  channel->ring = ring;
+  channel->capacity = CONFIG_UCCN_SHM_RING_SIZE;
+  channel->doorbell = doorbell;
+  uccn_attach_shm_channel(channel);
+  uccn_set_link_channel(&tracker->endpoint, link, channel);
+  uccndbg("Offered a ring to %s@%s", peer->name, peer->location);
+  return 1;
+fail:
+  if (doorbell >= 0 && close(doorbell) < 0) {
+    uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to close ring doorbell"));
+  }
+  if (ring != MAP_FAILED && munmap(ring, footprint) < 0) {
+    uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to unmap ring memory"));
+  }
+  if (memfd >= 0 && close(memfd) < 0) {
+    uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to close ring memory"));
+  }
+  return ret;
+}
 
-    if (num_active_trackers != NULL) {
-      if (endpoint->num_peers > 0) {
-        *num_active_trackers += 1;
-      }
+int uccn_accept_shm_channel(struct uccn_node_s * node)
+{
+  int ret = 0, seals, fds[2] = {-1, -1};
+  size_t footprint = 0;
+  ssize_t nbytes;
+  void * ring = MAP_FAILED;
+  bool authentic = false;
+  struct ucred credentials;
+  struct stat info;
+  struct iovec iov;
+  struct msghdr msg;
+  struct cmsghdr * cmsg;
+  union {
+    struct cmsghdr header;
+    char data[CMSG_SPACE(2 * sizeof(int)) + CMSG_SPACE(sizeof(struct ucred))];
+  } control;
+  struct sockaddr_un shm_address;
+  struct sockaddr_in address;
+  struct uccn_shm_offer_s offer;
+  struct uccn_shm_channel_s * channel;
+  struct uccn_content_provider_s * provider;
+  struct uccn_peer_s * peer;
+  struct uccn_link_s * link;
+
+  iov.iov_base = &offer;
+  iov.iov_len = sizeof(offer);
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_name = &shm_address;
+  msg.msg_namelen = sizeof(shm_address);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.data;
+  msg.msg_controllen = sizeof(control.data);
+  if ((nbytes = recvmsg(node->shm_socket, &msg, MSG_CMSG_CLOEXEC)) < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return 0;
     }
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 4, "Failed to receive ring offer"));
+    return -1;
   }
-
-  for (i = 0; i < node->num_providers; ++i) {
-    endpoint = (struct uccn_content_endpoint_s *)&node->providers[i];
-
-    uccn_unlink_dead_peers(endpoint);
-
-    if (num_active_providers != NULL) {
-      if (endpoint->num_peers > 0) {
-        *num_active_providers += 1;
-      }
+  for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET) {
+      continue;
+    }
+    if (cmsg->cmsg_type == SCM_RIGHTS && cmsg->cmsg_len == CMSG_LEN(2 * sizeof(int))) {
+      memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    } else if (cmsg->cmsg_type == SCM_CREDENTIALS &&
+               cmsg->cmsg_len == CMSG_LEN(sizeof(credentials))) {
+      // Vouched for by the kernel, senders cannot make these up
+      memcpy(&credentials, CMSG_DATA(cmsg), sizeof(credentials));
+      authentic = credentials.uid == geteuid();
     }
   }
 
-  if (next_probe_time != NULL) {
-    *next_probe_time = current_time;
-    timespec_add(next_probe_time, &g_uccn_endpoint_probe_timeout);
+  // Offers are a courtesy, turning them down only means UDP
+  if ((size_t)nbytes != sizeof(offer) || (msg.msg_flags & MSG_CTRUNC) ||
+      fds[0] < 0 || fds[1] < 0 || offer.magic != UCCN_SHM_OFFER_MAGIC ||
+      offer.capacity < 2 * CONFIG_UCCN_OUTGOING_BUFFER_SIZE ||
+      (offer.capacity & (offer.capacity - 1)) != 0) {
+    uccnwarn(RUNTIME_ERR("Ignoring malformed ring offer"));
+    goto out;
+  }
+  if (!authentic) {
+    uccnwarn(RUNTIME_ERR("Ignoring ring offer from another user"));
+    goto out;
+  }
+  if (uccn_parse_shm_address(&shm_address, msg.msg_namelen, &address) < 0) {
+    uccnwarn(RUNTIME_ERR("Ignoring ring offer from an unknown address"));
+    goto out;
+  }
+  if ((provider = hash_index_find(&node->provider_index, offer.hash)) == NULL) {
+    uccndbg("Ignoring ring offer for content not provided");
+    goto out;
+  }
+  // Rings only ever replace UDP for peers already tracking the content
+  if ((peer = uccn_find_peer(node, &address)) == NULL ||
+      (link = uccn_find_link(&provider->endpoint, uccn_peer_handle(node, peer))) == NULL) {
+    uccndbg("Ignoring ring offer from a peer not tracking content");
+    goto out;
   }
 
-  for (i = 0; i < node->num_peers; ++i) {
-    peer = &node->peers[i];
-
-    if (!peer->alive || peer->num_links == 0) {
-      for (j = i; j < node->num_peers - 1; ++j) {
-        node->peers[j] = node->peers[j + 1];
-      }
-      --node->num_peers, --i;
-      continue;
-    }
+  footprint = shm_ring_footprint(offer.capacity);
+  seals = fcntl(fds[0], F_GET_SEALS);
+  if (seals < 0 || (seals & (F_SEAL_SHRINK | F_SEAL_GROW)) != (F_SEAL_SHRINK | F_SEAL_GROW)) {
+    uccnwarn(RUNTIME_ERR("Ignoring ring offer of unsealed memory"));
+    goto out;
+  }
+  if (fstat(fds[0], &info) < 0 || (size_t)info.st_size < footprint) {
+    uccnwarn(RUNTIME_ERR("Ignoring ring offer short of memory"));
+    goto out;
+  }
+  ring = mmap(NULL, footprint, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+  if (ring == MAP_FAILED) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to map ring memory"));
+    ret = -1;
+    goto out;
+  }
 
-    peer_liveliness_deadline = &peer->liveliness.next_remote_deadline;
-    if (next_probe_time != NULL) {
-      if (timespec_cmp(next_probe_time, peer_liveliness_deadline) > 0) {
-        *next_probe_time = *peer_liveliness_deadline;
-      }
-    }
+  if (link->channel != NULL) {
+    // The peer must have started over, the old ring is of no use anymore
+    uccn_set_link_channel(&provider->endpoint, link, NULL);
+  }
+  if ((channel = uccn_claim_shm_channel(node)) == NULL) {
+    uccndbg("No room for a ring to %s@%s, using UDP", peer->name, peer->location);
+    goto out;
   }
 
+  channel->peer = link->handle;
+  channel->hash = offer.hash;
+  channel->outgoing = true;
+  channel->ring = ring;
+  channel->capacity = offer.capacity;
+  channel->doorbell = fds[1];
+  uccn_attach_shm_channel(channel);
+  uccn_set_link_channel(&provider->endpoint, link, channel);
+  uccndbg("Took a ring from %s@%s", peer->name, peer->location);
+  ring = MAP_FAILED;
+  fds[1] = -1;
+out:
+  if (ring != MAP_FAILED && munmap(ring, footprint) < 0) {
+    uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to unmap ring memory"));
+  }
+  if (fds[0] >= 0 && close(fds[0]) < 0) {
+    uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to close ring memory"));
+  }
+  if (fds[1] >= 0 && close(fds[1]) < 0) {
+    uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to close ring doorbell"));
+  }
   return ret;
 }
 
-int uccn_process_content_blob(struct uccn_node_s * node, struct uccn_peer_s * peer,
-                              uint32_t hash, struct buffer_head_s * blob)
+int uccn_drain_shm_channel(struct uccn_node_s * node, struct uccn_shm_channel_s * channel)
 {
   int ret = 0;
-
-  size_t i;
-  void * content;
+  ssize_t length;
+  uint64_t value;
+  void * data;
+  struct timespec current_time;
+  struct buffer_head_s packet;
+  struct buffer_head_s * outgoing_packet;
+  struct uccn_peer_s * peer;
   struct uccn_content_tracker_s * tracker;
-  struct uccn_content_endpoint_s * endpoint;
+  struct uccn_link_s * link;
 
-  for (i = 0; i < node->num_trackers; ++i) {
-    tracker = &node->trackers[i];
-    endpoint = (struct uccn_content_endpoint_s *)tracker;
-
-    if (endpoint->resource->hash == hash) {
-      content = NULL;
-      if ((ret = endpoint->resource->unpack(endpoint->resource, blob, &content)) < 0) {
-        uccndbg(BACKTRACE_FROM(__LINE__ - 1));
-        break;
-      }
+  // Clear before draining, so that entries pushed meanwhile ring again
+  if (read(channel->doorbell, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to clear ring doorbell"));
+    return -1;
+  }
+  if ((peer = uccn_peer_lookup(node, channel->peer)) == NULL) {
+    // Closed along with its link soon enough
+    return 0;
+  }
 
-      tracker->track(tracker, content);
+  // Posts through the ring assert liveliness just like those over UDP
+  if (clock_gettime(CLOCK_MONOTONIC, &current_time) < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
+    return -1;
+  }
+  peer->liveliness.next_remote_deadline = current_time;
+  timespec_add(&peer->liveliness.next_remote_deadline, &g_uccn_liveliness_timeout);
 
-      if ((ret = uccn_link(endpoint, peer)) != 0) {
-        uccndbg(BACKTRACE_FROM(__LINE__ - 1));
-      }
-      break;
+  // Content is processed right off the ring, and calls for no reply
+  outgoing_packet = (struct buffer_head_s *)&node->outgoing_buffer;
+  while ((length = shm_ring_peek(channel->ring, channel->capacity, &data)) >= 0) {
+    packet.data = data;
+    packet.length = packet.size = length;
+    ret = uccn_process_packet(node, peer, &packet, outgoing_packet);
+    shm_ring_pop(channel->ring, length);
+    if (ret < 0) {
+      uccndbg(BACKTRACE_FROM(__LINE__ - 3));
+      return ret;
     }
   }
 
-  return ret;
+  if (length == -2) {
+    uccnerr(RUNTIME_ERR("Ring from %s@%s is corrupt, using UDP", peer->name, peer->location));
+    tracker = hash_index_find(&node->tracker_index, channel->hash);
+    if (tracker != NULL && (link = uccn_find_link(&tracker->endpoint, channel->peer)) != NULL &&
+        link->channel == channel) {
+      uccn_set_link_channel(&tracker->endpoint, link, NULL);
+    }
+    return -1;
+  }
+  return 0;
 }
 
-int uccn_process_content_group(struct uccn_node_s * node, struct uccn_peer_s * peer, mpack_reader_t * reader)
+int uccn_shm_send(struct uccn_shm_channel_s * channel,
+                  uccn_peer_handle_t peer, uint32_t hash,
+                  const struct iovec * iov, size_t iovcnt)
 {
   int ret = 0;
-  uint32_t hash;
-  uint32_t i, group_size;
-  struct buffer_head_s blob;
-
-  assert(node != NULL);
-  assert(peer != NULL);
-  assert(reader != NULL);
+#if CONFIG_UCCN_MULTITHREADED
+  int err;
+#endif
+  uint64_t value = 1;
 
-  if (mpack_expect_map_or_nil(reader, &group_size)) {
-    for (i = 0; i < group_size; ++i) {
-      hash = mpack_expect_u32(reader);
-      if (hash == 0) {
-        uccnerr(RUNTIME_ERR("Content hash missing"));
-        ret = -1;
-        break;
-      }
-      blob.length = blob.size = mpack_expect_bin(reader);
-      if (blob.length == 0) {
-        uccnerr(RUNTIME_ERR("Content blob missing"));
-        ret = -1;
-        break;
-      }
-      blob.data = (void *)mpack_read_bytes_inplace(reader, blob.length);
-      if (blob.data == NULL) {
-        uccnerr(RUNTIME_ERR("Failed to read content blob inplace"));
-        ret = -1;
-        break;
-      }
-      ret = uccn_process_content_blob(node, peer, hash, &blob);
-      if (ret != 0) {
-        uccndbg(BACKTRACE_FROM(__LINE__ - 2));
-        break;
+  // Holding the channel keeps it mapped, and the node from reusing it
+  if (!uccn_hold_shm_channel(channel)) {
+    return 0;
+  }
+  if (__atomic_load_n(&channel->attached, __ATOMIC_ACQUIRE) &&
+      channel->peer == peer && channel->hash == hash) {
+#if CONFIG_UCCN_MULTITHREADED
+    if ((err = pthread_mutex_lock(&channel->producer_mutex)) != 0) {
+      errno = err;
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to lock ring"));
+      uccn_release_shm_channel(channel);
+      return 0;
+    }
+#endif
+    ret = shm_ring_push(channel->ring, channel->capacity, iov, iovcnt);
+#if CONFIG_UCCN_MULTITHREADED
+    if ((err = pthread_mutex_unlock(&channel->producer_mutex)) != 0) {
+      errno = err;
+      uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to unlock ring"));
+    }
+#endif
+    if (ret > 0) {
+      // A saturated counter still wakes the consumer up
+      if (write(channel->doorbell, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+        uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to ring doorbell"));
       }
     }
-    mpack_done_map(reader);
+    ret = (ret >= 0);
   }
-
+  uccn_release_shm_channel(channel);
   return ret;
 }
 
-int uccn_link(struct uccn_content_endpoint_s * endpoint, struct uccn_peer_s * peer)
+void uccn_close_shm_channel(struct uccn_node_s * node, struct uccn_shm_channel_s * channel)
 {
-  size_t i;
-
-  if (endpoint->num_peers >= CONFIG_UCCN_MAX_NUM_PEERS) {
-    uccnerr(RUNTIME_ERR("Too many peers"));
-    return -1;
+  __atomic_store_n(&channel->attached, false, __ATOMIC_RELEASE);
+  if (!channel->outgoing &&
+      epoll_ctl(node->epoll_fd, EPOLL_CTL_DEL, channel->doorbell, NULL) < 0) {
+    uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to unregister ring doorbell"));
   }
+  // Posts still using it unmap it when done, rather than being waited for
+  uccn_release_shm_channel(channel);
+}
 
-  for (i = 0; i < endpoint->num_peers; ++i) {
-    if (endpoint->peers[i] == peer) {
-      return 0;
-    }
-  }
-  endpoint->peers[endpoint->num_peers++] = peer;
-  ++peer->num_links;
-  return 1;
+#endif
+
+static int uccn_hash_cmp(const void * a, const void * b)
+{
+  uint32_t ha = *(const uint32_t *)a;
+  uint32_t hb = *(const uint32_t *)b;
+  return (ha > hb) - (ha < hb);
 }
 
-int uccn_unlink(struct uccn_content_endpoint_s * endpoint, struct uccn_peer_s * peer)
+int uccn_read_hash_set(mpack_reader_t * reader, struct uccn_hash_set_s * set,
+                       size_t capacity)
 {
-  size_t i, j;
+  uint32_t i, j, array_size;
+
+  set->size = 0;
+  if (mpack_expect_array_max_or_nil(reader, capacity, &array_size)) {
+    for (i = 0; i < array_size; ++i) {
+      set->hashes[i] = mpack_expect_u32(reader);
+      if (set->hashes[i] == 0) {
+        uccnerr(RUNTIME_ERR("Missing resource hash"));
+        return -1;
+      }
+    }
+    mpack_done_array(reader);
+    if (mpack_reader_error(reader) != mpack_ok) {
+      return -1;
+    }
 
-  for (i = 0; i < endpoint->num_peers; ++i) {
-    if (endpoint->peers[i] == peer) {
-      for (j = i; j < endpoint->num_peers - 1; ++j) {
-        endpoint->peers[j] = endpoint->peers[j + 1];
+    qsort(set->hashes, array_size, sizeof(uint32_t), uccn_hash_cmp);
+    for (i = 0, j = 0; i < array_size; ++i) {
+      if (j == 0 || set->hashes[j - 1] != set->hashes[i]) {
+        set->hashes[j++] = set->hashes[i];
       }
-      --endpoint->num_peers;
-      --peer->num_links;
-      return 1;
     }
+    set->size = j;
   }
   return 0;
 }
 
-int uccn_link_trackers(struct uccn_node_s * node, struct uccn_peer_s * peer, uint32_t hash)
+bool uccn_hash_set_contains(const struct uccn_hash_set_s * set, uint32_t hash)
 {
-  int ret, num_links = 0;
+  return bsearch(&hash, set->hashes, set->size, sizeof(uint32_t), uccn_hash_cmp) != NULL;
+}
 
-  size_t i;
-  struct uccn_content_endpoint_s * endpoint;
-  for (i = 0; i < node->num_trackers; ++i) {
-    endpoint = (struct uccn_content_endpoint_s *)&node->trackers[i];
-    if (endpoint->resource->hash == hash) {
-      if ((ret = uccn_link(endpoint, peer)) < 0) {
-        uccndbg(BACKTRACE_FROM(__LINE__ - 1));
-        return ret;
-      }
-      num_links += ret;
-    }
+void uccn_write_capability_hashes(mpack_writer_t * writer)
+{
+  (void)writer;
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  mpack_write_u32(writer, UCCN_CHECKSUMS_HASH);
+#endif
+#if CONFIG_UCCN_MULTICAST_CONTENT
+  mpack_write_u32(writer, UCCN_MULTICAST_HASH);
+#endif
+}
+
+void uccn_read_capability_hashes(struct uccn_peer_s * peer, struct uccn_hash_set_s * set)
+{
+  size_t num_capabilities = 0;
+  bool checksums = false, multicast = false;
+
+  // Sets are sorted, capabilities come first
+  while (num_capabilities < set->size &&
+         set->hashes[num_capabilities] <= UCCN_MAX_CAPABILITY_HASH) {
+    checksums |= set->hashes[num_capabilities] == UCCN_CHECKSUMS_HASH;
+    multicast |= set->hashes[num_capabilities] == UCCN_MULTICAST_HASH;
+    ++num_capabilities;
   }
-  return num_links;
+  (void)peer;
+  (void)checksums;
+  (void)multicast;
+#if CONFIG_UCCN_CONTENT_CHECKSUMS
+  // Checked content is only sent to peers that ask for it
+  peer->checksums = checksums;
+#endif
+#if CONFIG_UCCN_MULTICAST_CONTENT
+  // Content only goes to groups if both ends agree to it
+  peer->multicast = multicast;
+#endif
+  set->size -= num_capabilities;
+  memmove(set->hashes, &set->hashes[num_capabilities], set->size * sizeof(uint32_t));
 }
 
-int uccn_link_providers(struct uccn_node_s * node, struct uccn_peer_s * peer, uint32_t hash)
+int uccn_relink(struct uccn_peer_s * peer,
+                struct hash_index_s * index,
+                struct uccn_hash_set_s * linked_set,
+                const struct uccn_hash_set_s * advertised_set,
+                struct uccn_hash_set_s * matched_set,
+                size_t * num_first_links)
 {
   int ret, num_links = 0;
-
-  size_t i;
+  bool failed = false;
+  bool first_link;
+  size_t i = 0, j = 0;
+  uint32_t hash;
   struct uccn_content_endpoint_s * endpoint;
-  for (i = 0; i < node->num_providers; ++i) {
-    endpoint = (struct uccn_content_endpoint_s *)&node->providers[i];
-    if (endpoint->resource->hash == hash) {
+
+  matched_set->size = 0;
+  // Walk both sorted sets at once, touching only what changed
+  while (i < linked_set->size || j < advertised_set->size) {
+    if (j >= advertised_set->size ||
+        (i < linked_set->size && linked_set->hashes[i] < advertised_set->hashes[j])) {
+      hash = linked_set->hashes[i++];
+      if ((endpoint = hash_index_find(index, hash)) != NULL) {
+        uccn_unlink(endpoint, peer);
+      }
+      continue;
+    }
+    hash = advertised_set->hashes[j++];
+    if (i < linked_set->size && linked_set->hashes[i] == hash) {
+      ++i;
+    }
+    if ((endpoint = hash_index_find(index, hash)) != NULL) {
+      first_link = endpoint->num_peers == 0;
+      // Linking is idempotent, so this also repairs links lost meanwhile
       if ((ret = uccn_link(endpoint, peer)) < 0) {
         uccndbg(BACKTRACE_FROM(__LINE__ - 1));
-        return ret;
+        // Carry on, for links made or withdrawn to be accounted for
+        failed = true;
+        continue;
       }
       num_links += ret;
+      if (first_link && ret > 0 && num_first_links != NULL) {
+        ++*num_first_links;
+      }
+      matched_set->hashes[matched_set->size++] = hash;
     }
   }
-  return num_links;
-}
-
-int uccn_unlink_providers(struct uccn_node_s * node, struct uccn_peer_s * peer)
-{
-  size_t i;
-  int num_unlinks = 0;
-  struct uccn_content_endpoint_s * endpoint;
-  for (i = 0; i < node->num_providers; ++i) {
-    endpoint = (struct uccn_content_endpoint_s *)&node->providers[i];
-    num_unlinks += uccn_unlink(endpoint, peer);
-  }
-  return num_unlinks;
-}
-
-int uccn_unlink_trackers(struct uccn_node_s * node, struct uccn_peer_s * peer)
-{
-  size_t i;
-  int num_unlinks = 0;
-  struct uccn_content_endpoint_s * endpoint;
-  for (i = 0; i < node->num_trackers; ++i) {
-    endpoint = (struct uccn_content_endpoint_s *)&node->trackers[i];
-    num_unlinks += uccn_unlink(endpoint, peer);
-  }
-  return num_unlinks;
+  // Failed links are retried when the peer advertises them again
+  memcpy(linked_set->hashes, advertised_set->hashes,
+         advertised_set->size * sizeof(uint32_t));
+  linked_set->size = advertised_set->size;
+  return failed ? -1 : num_links;
 }
 
 int uccn_process_link_group(struct uccn_node_s * node, struct uccn_peer_s * peer,
@@ -1149,26 +4297,26 @@ int uccn_process_link_group(struct uccn_node_s * node, struct uccn_peer_s * peer
 {
   int ret = 0;
 
-  uint32_t i, j;
-
-  uint32_t hash;
+  uint32_t i;
   uint8_t  data_code;
-  uint32_t group_size, array_size;
-
-  uint32_t hashes[CONFIG_UCCN_MAX_NUM_RESOURCES];
-  uint32_t num_hashes = 0;
-
-  uint32_t provided_hashes[CONFIG_UCCN_MAX_NUM_RESOURCES];
-  uint32_t num_provided_hashes = 0;
+  uint32_t group_size;
+  size_t num_matched_trackers;
+  struct timespec current_time;
+#if CONFIG_UCCN_SHM_TRANSPORT
+  size_t j;
+#endif
 
-  uint32_t tracked_hashes[CONFIG_UCCN_MAX_NUM_RESOURCES];
-  uint32_t num_tracked_hashes = 0;
+  struct uccn_hash_set_s * advertised_set = &node->link_sets.advertised;
+  struct uccn_hash_set_s * provided_set = &node->link_sets.provided;
+  struct uccn_hash_set_s * tracked_set = &node->link_sets.tracked;
 
   assert(node != NULL);
   assert(peer != NULL);
   assert(reader != NULL);
   assert(writer != NULL);
 
+  provided_set->size = 0;
+  tracked_set->size = 0;
   if (mpack_expect_map_max_or_nil(reader, UCCN_MAX_NUM_LINK_DATA, &group_size)) {
     for (i = 0; i < group_size; ++i) {
       data_code = mpack_expect_u8(reader);
@@ -1177,67 +4325,63 @@ int uccn_process_link_group(struct uccn_node_s * node, struct uccn_peer_s * peer
           mpack_expect_cstr(reader, peer->name, CONFIG_UCCN_MAX_NODE_NAME_SIZE);
           break;
         case UCCN_PROVIDED_ARRAY:
-          if (mpack_expect_array_max_or_nil(reader, CONFIG_UCCN_MAX_NUM_RESOURCES, &array_size)) {
-            for (j = 0; j < array_size; ++j) {
-              hash = mpack_expect_u32(reader);
-              if (hash == 0) {
-                uccnerr(RUNTIME_ERR("Missing resource hash"));
-                return -1;
-              }
-              hashes[num_hashes++] = hash;
+          if ((ret = uccn_read_hash_set(reader, advertised_set,
+                                        node->capacity.max_num_resources +
+                                        UCCN_MAX_NUM_CAPABILITY_HASHES)) < 0) {
+            uccndbg(BACKTRACE_FROM(__LINE__ - 3));
+            return ret;
+          }
+          uccn_read_capability_hashes(peer, advertised_set);
+          num_matched_trackers = 0;
+          ret = uccn_relink(peer, &node->tracker_index, &peer->provided_content,
+                            advertised_set, tracked_set, &num_matched_trackers);
+          if (ret < 0) {
+            uccndbg(BACKTRACE_FROM(__LINE__ - 3));
+            return ret;
+          }
+          if (num_matched_trackers > 0) {
+            // Providers showing up hint at others doing so too
+            if (clock_gettime(CLOCK_MONOTONIC, &current_time) < 0) {
+              uccnwarn(SYSTEM_ERR_FROM(__LINE__ - 1, "Failed to get current time"));
+            } else {
+              uccn_reset_discovery(node, &current_time, false);
+            }
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+            // Discovery was brought forward behind the back of the thread spinning
+            if (node->deferring_worker != NULL && uccn_wakeup(node) < 0) {
+              uccndbg(BACKTRACE_FROM(__LINE__ - 1));
             }
-            mpack_done_array(reader);
-
-            hash = crc32((const uint8_t *)hashes, sizeof(uint32_t) * num_hashes);
-            if (peer->provided_content_hash != hash) {
-              // TODO(hidmic): do better than re-linking all endpoints
-              if ((ret = uccn_unlink_trackers(node, peer)) < 0) {
-                uccndbg(BACKTRACE_FROM(__LINE__ - 1));
-                return ret;
-              }
-              for (j = 0; j < num_hashes; ++j) {
-                if ((ret = uccn_link_trackers(node, peer, hashes[j])) < 0) {
-                  uccndbg(BACKTRACE_FROM(__LINE__ -1));
-                  return ret;
-                }
-                if (ret > 0) {
-                  tracked_hashes[num_tracked_hashes++] = hashes[j];
-                }
-              }
-              peer->provided_content_hash = hash;
+#endif
+          }
+          if (ret == 0) {
+            // Nothing new to tell the peer about
+            tracked_set->size = 0;
+          }
+#if CONFIG_UCCN_SHM_TRANSPORT
+          for (j = 0; j < tracked_set->size; ++j) {
+            if (uccn_offer_shm_channel(node, peer, tracked_set->hashes[j]) < 0) {
+              uccndbg(BACKTRACE_FROM(__LINE__ - 1));
             }
           }
+#endif
           break;
         case UCCN_TRACKED_ARRAY:
-          if (mpack_expect_array_max_or_nil(reader, CONFIG_UCCN_MAX_NUM_RESOURCES, &array_size)) {
-            for (j = 0; j < array_size; ++j) {
-              hash = mpack_expect_u32(reader);
-              if (hash == 0) {
-                uccnerr(RUNTIME_ERR("Missing resource hash"));
-                return -1;
-              }
-              hashes[num_hashes++] = hash;
-            }
-            mpack_done_array(reader);
-
-            hash = crc32((const uint8_t *)hashes, sizeof(uint32_t) * num_hashes);
-            if (peer->tracked_content_hash != hash) {
-              // TODO(hidmic): do better than re-linking all endpoints
-              if ((ret = uccn_unlink_providers(node, peer)) < 0) {
-                uccndbg(BACKTRACE_FROM(__LINE__ - 1));
-                return ret;
-              }
-              for (j = 0; j < array_size; ++j) {
-                if ((ret = uccn_link_providers(node, peer, hashes[j])) < 0) {
-                  uccndbg(BACKTRACE_FROM(__LINE__ -1));
-                  return ret;
-                }
-                if (ret > 0) {
-                  provided_hashes[num_provided_hashes++] = hashes[j];
-                }
-              }
-              peer->tracked_content_hash = hash;
-            }
+          if ((ret = uccn_read_hash_set(reader, advertised_set,
+                                        node->capacity.max_num_resources +
+                                        UCCN_MAX_NUM_CAPABILITY_HASHES)) < 0) {
+            uccndbg(BACKTRACE_FROM(__LINE__ - 3));
+            return ret;
+          }
+          uccn_read_capability_hashes(peer, advertised_set);
+          ret = uccn_relink(peer, &node->provider_index, &peer->tracked_content,
+                            advertised_set, provided_set, NULL);
+          if (ret < 0) {
+            uccndbg(BACKTRACE_FROM(__LINE__ - 3));
+            return ret;
+          }
+          if (ret == 0) {
+            // Nothing new to tell the peer about
+            provided_set->size = 0;
           }
           break;
         default:
@@ -1247,11 +4391,12 @@ int uccn_process_link_group(struct uccn_node_s * node, struct uccn_peer_s * peer
     }
     mpack_done_map(reader);
   }
+  ret = 0;
   group_size = 0;
-  if (num_tracked_hashes > 0) {
+  if (tracked_set->size > 0) {
     group_size += 1;
   }
-  if (num_provided_hashes > 0) {
+  if (provided_set->size > 0) {
     group_size += 1;
   }
   if (group_size > 0) {
@@ -1262,19 +4407,21 @@ int uccn_process_link_group(struct uccn_node_s * node, struct uccn_peer_s * peer
       {
         mpack_write_u8(writer, UCCN_NODE_NAME);
         mpack_write_cstr(writer, node->name);
-        if (num_tracked_hashes > 0) {
+        if (tracked_set->size > 0) {
           mpack_write_u8(writer, UCCN_TRACKED_ARRAY);
-          mpack_start_array(writer, num_tracked_hashes);
-          while (num_tracked_hashes > 0) {
-            mpack_write_u32(writer, tracked_hashes[--num_tracked_hashes]);
+          mpack_start_array(writer, tracked_set->size + UCCN_NUM_CAPABILITY_HASHES);
+          uccn_write_capability_hashes(writer);
+          for (i = 0; i < tracked_set->size; ++i) {
+            mpack_write_u32(writer, tracked_set->hashes[i]);
           }
           mpack_finish_array(writer);
         }
-        if (num_provided_hashes > 0) {
+        if (provided_set->size > 0) {
           mpack_write_u8(writer, UCCN_PROVIDED_ARRAY);
-          mpack_start_array(writer, num_provided_hashes);
-          while (num_provided_hashes > 0) {
-            mpack_write_u32(writer, provided_hashes[--num_provided_hashes]);
+          mpack_start_array(writer, provided_set->size + UCCN_NUM_CAPABILITY_HASHES);
+          uccn_write_capability_hashes(writer);
+          for (i = 0; i < provided_set->size; ++i) {
+            mpack_write_u32(writer, provided_set->hashes[i]);
           }
           mpack_finish_array(writer);
         }
@@ -1299,6 +4446,7 @@ int uccn_process_packet(struct uccn_node_s * node,
   uint32_t i, group_count;
   uint8_t group_code;
 
+  outgoing_packet->length = 0;
   mpack_reader_init_data(&reader, incoming_packet->data, incoming_packet->length);
 
   if (mpack_expect_map_max_or_nil(&reader, UCCN_MAX_NUM_GROUPS, &group_count)) {
@@ -1339,16 +4487,72 @@ int uccn_process_packet(struct uccn_node_s * node,
   return ret;
 }
 
+int uccn_wakeup(struct uccn_node_s * node) {
+  int ret = eventfd_set(&node->wakeup_event);
+  if (ret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to set node wakeup event"));
+  }
+  return ret;
+}
+
 int uccn_stop(struct uccn_node_s * node) {
   int ret = eventfd_set(&node->stop_event);
   if (ret < 0) {
-    uccndbg(BACKTRACE_FROM(__LINE__ - 2));
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to set node stop event"));
   }
   return ret;
 }
 
 int uccn_node_fini(struct uccn_node_s * node) {
   int ret = 0, iret;
+  size_t i;
+
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+  // Workers use the node all the way until they are joined
+  if ((iret = uccn_stop_receive_workers(node)) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    ret = iret;
+  }
+#endif
+#if CONFIG_UCCN_EXECUTOR
+  // Only once nothing else may queue content
+  if ((iret = uccn_stop_executor(node)) < 0) {
+    uccndbg(BACKTRACE_FROM(__LINE__ - 1));
+    ret = iret;
+  }
+#endif
+#if CONFIG_UCCN_FRAGMENTATION
+  for (i = 0; i < CONFIG_UCCN_MAX_NUM_REASSEMBLIES; ++i) {
+    uccn_release_reassembly(&node->reassemblies[i]);
+  }
+#endif
+
+  // Content still kept or borrowed by then is gone with its endpoint
+  for (i = 0; i < node->num_trackers; ++i) {
+#if CONFIG_UCCN_EXECUTOR
+    uccn_fini_content_queue(&node->trackers[i].queue);
+#endif
+    uccn_fini_content_pool(&node->trackers[i].pool);
+  }
+  for (i = 0; i < node->num_providers; ++i) {
+    uccn_fini_content_pool(&node->providers[i].pool);
+  }
+
+#if CONFIG_UCCN_SHM_TRANSPORT
+  for (i = 0; i < CONFIG_UCCN_MAX_NUM_SHM_CHANNELS; ++i) {
+    if (node->shm_channels[i].attached) {
+      uccn_close_shm_channel(node, &node->shm_channels[i]);
+    }
+#if CONFIG_UCCN_MULTITHREADED
+    pthread_mutex_destroy(&node->shm_channels[i].producer_mutex);
+#endif
+  }
+  iret = close(node->shm_socket);
+  if (iret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to close node ring socket"));
+    ret = iret;
+  }
+#endif
 
   iret = close(node->socket);
   if (iret < 0) {
@@ -1366,11 +4570,42 @@ int uccn_node_fini(struct uccn_node_s * node) {
     uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to destroy node mutex"));
     ret = iret;
   }
+  pthread_cond_destroy(&node->post_buffer_released);
+  pthread_mutex_destroy(&node->post_buffers_mutex);
 #endif
   iret = eventfd_fini(&node->stop_event);
   if (iret < 0) {
-    uccndbg(BACKTRACE_FROM(__LINE__ - 2));
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to finalize node stop event"));
     ret = iret;
   }
+  iret = eventfd_fini(&node->wakeup_event);
+  if (iret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to finalize node wakeup event"));
+    ret = iret;
+  }
+#if CONFIG_UCCN_NUM_RECEIVE_WORKERS > 0
+  iret = eventfd_fini(&node->workers_stop_event);
+  if (iret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to finalize node workers stop event"));
+    ret = iret;
+  }
+#endif
+#if CONFIG_UCCN_EPOLL
+  iret = close(node->timer_fd);
+  if (iret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to close node timer"));
+    ret = iret;
+  }
+  iret = close(node->epoll_fd);
+  if (iret < 0) {
+    uccnerr(SYSTEM_ERR_FROM(__LINE__ - 2, "Failed to close node epoll instance"));
+    ret = iret;
+  }
+#endif
+#if CONFIG_UCCN_DYNAMIC_CAPACITY
+  if (node->owns_arena) {
+    free(node->arena);
+  }
+#endif
   return ret;
 }
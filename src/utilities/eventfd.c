@@ -1,31 +1,95 @@
 #include "uccn/utilities/eventfd.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <stdint.h>
 #include <unistd.h>
+#if EVENTFD_NATIVE
+#include <sys/eventfd.h>
+#endif
+
+#if EVENTFD_NATIVE
+
+int eventfd_init(struct eventfd_s * ev) {
+  if ((ev->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0) {
+    return ev->fd;
+  }
+  return 0;
+}
+
+int eventfd_set(struct eventfd_s * ev)
+{
+  uint64_t value = 1;
+  if (write(ev->fd, &value, sizeof(value)) < 0) {
+    // Counter saturation still leaves the event set
+    return errno == EAGAIN ? 0 : -1;
+  }
+  return 0;
+}
+
+int eventfd_clear(struct eventfd_s * ev)
+{
+  uint64_t value;
+  if (read(ev->fd, &value, sizeof(value)) < 0) {
+    return errno == EAGAIN ? 0 : -1;
+  }
+  return 0;
+}
+
+int eventfd_fini(struct eventfd_s * ev)
+{
+  return close(ev->fd);
+}
+
+#else
+
+static int eventfd_setfl(int fd) {
+  int ret;
+  if ((ret = fcntl(fd, F_GETFL, 0)) < 0) {
+    return ret;
+  }
+  if ((ret = fcntl(fd, F_SETFL, ret | O_NONBLOCK)) < 0) {
+    return ret;
+  }
+  return fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
 
 int eventfd_init(struct eventfd_s * ev) {
   int ret;
   if ((ret = pipe(ev->fd)) < 0) {
     return ret;
   }
-  if ((ret = fcntl(ev->fd[1], F_GETFL, 0)) < 0) {
+  if ((ret = eventfd_setfl(ev->fd[0])) < 0 ||
+      (ret = eventfd_setfl(ev->fd[1])) < 0) {
+    close(ev->fd[0]);
+    close(ev->fd[1]);
     return ret;
   }
-  return fcntl(ev->fd[1], F_SETFL, ret | O_NONBLOCK);
+  return 0;
 }
 
 int eventfd_set(struct eventfd_s * ev)
 {
-  return write(ev->fd[1], "\n", 1);
+  if (write(ev->fd[1], "\n", 1) < 0) {
+    // A full pipe still leaves the event set
+    return errno == EAGAIN ? 0 : -1;
+  }
+  return 0;
 }
 
 int eventfd_clear(struct eventfd_s * ev)
 {
-  char tmp;
-  return read(ev->fd[0], &tmp, 1);
+  ssize_t nbytes;
+  char tmp[64];
+  do {
+    nbytes = read(ev->fd[0], tmp, sizeof(tmp));
+  } while (nbytes > 0);
+  return (nbytes < 0 && errno != EAGAIN) ? -1 : 0;
 }
 
 int eventfd_fini(struct eventfd_s * ev)
 {
   return close(ev->fd[0]) | close(ev->fd[1]);
 }
+
+#endif
@@ -0,0 +1,107 @@
+#include "uccn/utilities/shm_ring.h"
+
+#include <string.h>
+
+// Entries are a length and its content, 8 bytes aligned
+#define SHM_RING_ENTRY_HEADER_SIZE 8
+#define SHM_RING_ENTRY_SIZE(length) \
+  (SHM_RING_ENTRY_HEADER_SIZE + (((length) + 7) & ~(size_t)7))
+
+// Length of the filler left when an entry does not fit before the end
+#define SHM_RING_WRAP UINT32_MAX
+
+size_t shm_ring_footprint(size_t capacity)
+{
+  return sizeof(struct shm_ring_s) + capacity;
+}
+
+void shm_ring_init(struct shm_ring_s * ring, size_t capacity)
+{
+  memset(ring, 0, sizeof(*ring));
+  ring->capacity = capacity;
+}
+
+int shm_ring_push(struct shm_ring_s * ring, size_t capacity,
+                  const struct iovec * iov, size_t iovcnt)
+{
+  size_t i, length, size, offset, contiguous, needed;
+  uint64_t head, start, tail;
+  uint32_t marker;
+  char * entry;
+
+  for (length = 0, i = 0; i < iovcnt; ++i) {
+    length += iov[i].iov_len;
+  }
+  size = SHM_RING_ENTRY_SIZE(length);
+
+  start = head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+  tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  if (head - tail > capacity) {
+    return -1;
+  }
+  offset = head & (capacity - 1);
+  contiguous = capacity - offset;
+  needed = size > contiguous ? size + contiguous : size;
+  if (length >= SHM_RING_WRAP || needed > capacity - (head - tail)) {
+    return -1;
+  }
+  if (size > contiguous) {
+    // Skip what is left up to the end, there is always room for a marker
+    marker = SHM_RING_WRAP;
+    memcpy(&ring->data[offset], &marker, sizeof(marker));
+    head += contiguous;
+    offset = 0;
+  }
+
+  entry = &ring->data[offset];
+  marker = length;
+  memcpy(entry, &marker, sizeof(marker));
+  entry += SHM_RING_ENTRY_HEADER_SIZE;
+  for (i = 0; i < iovcnt; ++i) {
+    memcpy(entry, iov[i].iov_base, iov[i].iov_len);
+    entry += iov[i].iov_len;
+  }
+  __atomic_store_n(&ring->head, head + size, __ATOMIC_RELEASE);
+
+  // Pairs with the consumer storing its tail before looking at the head
+  // once more, so that either it sees this entry or this sees it idle
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  return __atomic_load_n(&ring->tail, __ATOMIC_RELAXED) == start;
+}
+
+ssize_t shm_ring_peek(struct shm_ring_s * ring, size_t capacity, void ** data)
+{
+  size_t offset, contiguous;
+  uint64_t head, tail;
+  uint32_t length;
+
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+  head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  while (head != tail) {
+    if (head - tail > capacity) {
+      return -2;
+    }
+    offset = tail & (capacity - 1);
+    contiguous = capacity - offset;
+    memcpy(&length, &ring->data[offset], sizeof(length));
+    if (length == SHM_RING_WRAP) {
+      tail += contiguous;
+      __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+      continue;
+    }
+    if (SHM_RING_ENTRY_SIZE((size_t)length) > contiguous ||
+        SHM_RING_ENTRY_SIZE((size_t)length) > head - tail) {
+      return -2;
+    }
+    *data = &ring->data[offset + SHM_RING_ENTRY_HEADER_SIZE];
+    return length;
+  }
+  return -1;
+}
+
+void shm_ring_pop(struct shm_ring_s * ring, size_t length)
+{
+  uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+  __atomic_store_n(&ring->tail, tail + SHM_RING_ENTRY_SIZE(length), __ATOMIC_RELEASE);
+}
@@ -1,6 +1,7 @@
 #include "uccn/utilities/upoll.h"
 
 #include <assert.h>
+#include <string.h>
 
 #include "uccn/common/time.h"
 
@@ -34,3 +35,235 @@ int upoll(struct upoll_s * upolls, size_t npolls, struct timespec * next_poll_ti
 
   return ret;
 }
+
+#define UPOLL_WHEEL_SLOT_MASK ((uint64_t)UPOLL_WHEEL_NUM_SLOTS - 1)
+#define UPOLL_WHEEL_SPAN_BITS (UPOLL_WHEEL_SLOT_BITS * UPOLL_WHEEL_NUM_LEVELS)
+
+static uint64_t upoll_wheel_ticks(const struct upoll_wheel_s * wheel,
+                                  const struct timespec * time,
+                                  bool round_up)
+{
+  uint64_t ns;
+
+  if (timespec_cmp(time, &wheel->origin) <= 0) {
+    return 0;
+  }
+  if (!TIMESPEC_ISFINITE(time)) {
+    return UINT64_MAX;
+  }
+  ns = (uint64_t)(time->tv_sec - wheel->origin.tv_sec) * 1000000000ULL;
+  ns += time->tv_nsec;
+  ns -= wheel->origin.tv_nsec;
+  if (round_up) {
+    ns += wheel->resolution - 1;
+  }
+  return ns / wheel->resolution;
+}
+
+static void upoll_wheel_time(const struct upoll_wheel_s * wheel,
+                             uint64_t ticks, struct timespec * time)
+{
+  uint64_t ns = ticks * wheel->resolution + wheel->origin.tv_nsec;
+
+  time->tv_sec = wheel->origin.tv_sec + ns / 1000000000ULL;
+  time->tv_nsec = ns % 1000000000ULL;
+}
+
+static void upoll_wheel_insert(struct upoll_wheel_s * wheel, struct upoll_timer_s * timer)
+{
+  unsigned int level;
+  uint64_t slot;
+  struct upoll_timer_s ** head;
+
+  if (timer->expiry <= wheel->ticks) {
+    head = &wheel->expired;
+  } else if ((timer->expiry >> UPOLL_WHEEL_SPAN_BITS) !=
+             (wheel->ticks >> UPOLL_WHEEL_SPAN_BITS)) {
+    // Out of reach until the top level wraps around
+    head = &wheel->overflow;
+  } else {
+    // The highest digit that differs from current time's tells the level,
+    // and slots ahead of current time are the only ones in use
+    level = (63 - __builtin_clzll(timer->expiry ^ wheel->ticks)) / UPOLL_WHEEL_SLOT_BITS;
+    slot = (timer->expiry >> (level * UPOLL_WHEEL_SLOT_BITS)) & UPOLL_WHEEL_SLOT_MASK;
+    head = &wheel->slots[level][slot];
+    wheel->occupied[level] |= (uint64_t)1 << slot;
+  }
+  timer->next = *head;
+  if (timer->next != NULL) {
+    timer->next->prev = &timer->next;
+  }
+  timer->prev = head;
+  *head = timer;
+}
+
+static void upoll_wheel_remove(struct upoll_wheel_s * wheel, struct upoll_timer_s * timer)
+{
+  uintptr_t first, last, index;
+
+  *timer->prev = timer->next;
+  if (timer->next != NULL) {
+    timer->next->prev = timer->prev;
+  }
+  // Slots left empty are no longer occupied
+  first = (uintptr_t)&wheel->slots[0][0];
+  last = (uintptr_t)&wheel->slots[UPOLL_WHEEL_NUM_LEVELS - 1][UPOLL_WHEEL_NUM_SLOTS - 1];
+  if ((uintptr_t)timer->prev >= first && (uintptr_t)timer->prev <= last &&
+      *timer->prev == NULL) {
+    index = ((uintptr_t)timer->prev - first) / sizeof(*timer->prev);
+    wheel->occupied[index / UPOLL_WHEEL_NUM_SLOTS] &=
+        ~((uint64_t)1 << (index % UPOLL_WHEEL_NUM_SLOTS));
+  }
+  timer->next = NULL;
+  timer->prev = NULL;
+}
+
+void upoll_wheel_init(struct upoll_wheel_s * wheel,
+                      const struct timespec * origin,
+                      long resolution)
+{
+  assert(wheel != NULL);
+  assert(origin != NULL && TIMESPEC_ISFINITE(origin));
+  assert(resolution > 0);
+
+  memset(wheel, 0, sizeof(*wheel));
+  wheel->origin = *origin;
+  wheel->resolution = resolution;
+}
+
+void upoll_timer_init(struct upoll_timer_s * timer, void * arg)
+{
+  assert(timer != NULL);
+
+  memset(timer, 0, sizeof(*timer));
+  timer->arg = arg;
+}
+
+bool upoll_timer_pending(const struct upoll_timer_s * timer)
+{
+  return timer->prev != NULL;
+}
+
+void upoll_wheel_schedule(struct upoll_wheel_s * wheel,
+                          struct upoll_timer_s * timer,
+                          const struct timespec * deadline)
+{
+  assert(wheel != NULL);
+  assert(timer != NULL);
+  assert(deadline != NULL && TIMESPEC_ISFINITE(deadline));
+
+  if (upoll_timer_pending(timer)) {
+    upoll_wheel_remove(wheel, timer);
+  }
+  timer->expiry = upoll_wheel_ticks(wheel, deadline, true);
+  upoll_wheel_insert(wheel, timer);
+}
+
+void upoll_wheel_cancel(struct upoll_wheel_s * wheel, struct upoll_timer_s * timer)
+{
+  assert(wheel != NULL);
+  assert(timer != NULL);
+
+  if (upoll_timer_pending(timer)) {
+    upoll_wheel_remove(wheel, timer);
+  }
+}
+
+void upoll_wheel_advance(struct upoll_wheel_s * wheel,
+                         const struct timespec * current_time)
+{
+  unsigned int level, shift;
+  uint64_t ticks, elapsed, i, slot;
+  struct upoll_timer_s * timer, * passed = NULL;
+
+  assert(wheel != NULL);
+  assert(current_time != NULL);
+
+  ticks = upoll_wheel_ticks(wheel, current_time, false);
+  if (ticks <= wheel->ticks) {
+    return;
+  }
+
+  // Take timers out of every slot passed over, level by level
+  for (level = 0; level < UPOLL_WHEEL_NUM_LEVELS; ++level) {
+    shift = level * UPOLL_WHEEL_SLOT_BITS;
+    elapsed = (ticks >> shift) - (wheel->ticks >> shift);
+    if (elapsed == 0) {
+      // Levels above did not move either
+      break;
+    }
+    if (elapsed > UPOLL_WHEEL_NUM_SLOTS) {
+      elapsed = UPOLL_WHEEL_NUM_SLOTS;
+    }
+    for (i = 1; i <= elapsed && wheel->occupied[level] != 0; ++i) {
+      slot = ((wheel->ticks >> shift) + i) & UPOLL_WHEEL_SLOT_MASK;
+      if ((wheel->occupied[level] & ((uint64_t)1 << slot)) == 0) {
+        continue;
+      }
+      while ((timer = wheel->slots[level][slot]) != NULL) {
+        upoll_wheel_remove(wheel, timer);
+        timer->next = passed;
+        passed = timer;
+      }
+    }
+  }
+  if ((ticks >> UPOLL_WHEEL_SPAN_BITS) != (wheel->ticks >> UPOLL_WHEEL_SPAN_BITS)) {
+    while ((timer = wheel->overflow) != NULL) {
+      upoll_wheel_remove(wheel, timer);
+      timer->next = passed;
+      passed = timer;
+    }
+  }
+  wheel->ticks = ticks;
+
+  // Then place them again, as expired or further down
+  while ((timer = passed) != NULL) {
+    passed = timer->next;
+    upoll_wheel_insert(wheel, timer);
+  }
+}
+
+struct upoll_timer_s * upoll_wheel_next_expired(struct upoll_wheel_s * wheel)
+{
+  struct upoll_timer_s * timer;
+
+  assert(wheel != NULL);
+
+  if ((timer = wheel->expired) != NULL) {
+    upoll_wheel_remove(wheel, timer);
+  }
+  return timer;
+}
+
+void upoll_wheel_next_deadline(const struct upoll_wheel_s * wheel,
+                               struct timespec * deadline)
+{
+  unsigned int level, shift;
+  uint64_t digit, ahead;
+
+  assert(wheel != NULL);
+  assert(deadline != NULL);
+
+  if (wheel->expired != NULL) {
+    upoll_wheel_time(wheel, wheel->ticks, deadline);
+    return;
+  }
+  // Levels are nested, so the first one with slots ahead holds the
+  // earliest timers
+  for (level = 0; level < UPOLL_WHEEL_NUM_LEVELS; ++level) {
+    shift = level * UPOLL_WHEEL_SLOT_BITS;
+    digit = (wheel->ticks >> shift) & UPOLL_WHEEL_SLOT_MASK;
+    ahead = wheel->occupied[level] & ~((((uint64_t)2) << digit) - 1);
+    if (ahead != 0) {
+      upoll_wheel_time(wheel, (((wheel->ticks >> shift) & ~UPOLL_WHEEL_SLOT_MASK) |
+                               (uint64_t)__builtin_ctzll(ahead)) << shift, deadline);
+      return;
+    }
+  }
+  if (wheel->overflow != NULL) {
+    upoll_wheel_time(wheel, ((wheel->ticks >> UPOLL_WHEEL_SPAN_BITS) + 1) <<
+                     UPOLL_WHEEL_SPAN_BITS, deadline);
+    return;
+  }
+  TIMESPEC_INF_INIT(deadline);
+}
@@ -0,0 +1,80 @@
+// Kernels are static, so they are built right into the test
+#include "../src/common/crc32.c"
+
+#include "test.h"
+
+#define BUFFER_SIZE 4160
+
+static uint8_t g_buffer[BUFFER_SIZE];
+
+// Checks a kernel against the bytewise logic over all sorts of lengths,
+// alignments and checksums to carry on
+static void check_kernel(const char * name, crc32_kernel_fn kernel)
+{
+  size_t length, offset;
+  uint32_t seed, expected, actual;
+  static const uint32_t seeds[] = { 0x00000000, 0xFFFFFFFF, 0x12345678 };
+  static const size_t long_lengths[] = { 511, 512, 513, 1000, 1024, 4095, 4096 };
+
+  for (seed = 0; seed < sizeof(seeds) / sizeof(seeds[0]); ++seed) {
+    for (offset = 0; offset < 16; ++offset) {
+      for (length = 0; length <= 300; ++length) {
+        expected = crc32_bytewise(seeds[seed], &g_buffer[offset], length);
+        actual = kernel(seeds[seed], &g_buffer[offset], length);
+        if (actual != expected) {
+          fprintf(stderr, "%s: %zu bytes at offset %zu, seed %08x: %08x != %08x\n",
+                  name, length, offset, seeds[seed], actual, expected);
+        }
+        CHECK(actual == expected);
+      }
+      for (length = 0; length < sizeof(long_lengths) / sizeof(long_lengths[0]); ++length) {
+        expected = crc32_bytewise(seeds[seed], &g_buffer[offset], long_lengths[length]);
+        actual = kernel(seeds[seed], &g_buffer[offset], long_lengths[length]);
+        if (actual != expected) {
+          fprintf(stderr, "%s: %zu bytes at offset %zu, seed %08x: %08x != %08x\n",
+                  name, long_lengths[length], offset, seeds[seed], actual, expected);
+        }
+        CHECK(actual == expected);
+      }
+    }
+  }
+}
+
+int main(void)
+{
+  size_t i, split;
+  uint32_t state = 0x2545F491;
+  uint32_t checksum;
+
+  for (i = 0; i < BUFFER_SIZE; ++i) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    g_buffer[i] = (uint8_t)state;
+  }
+  // Sets up slicing tables, and the kernel in use
+  crc32_dispatch(0, g_buffer, 0);
+
+  check_kernel("slice-by-8", crc32_slice_by_8);
+#if CRC32_PCLMUL
+  if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1")) {
+    check_kernel("pclmul", crc32_pclmul);
+  } else {
+    fprintf(stderr, "No PCLMUL support, left unchecked\n");
+  }
+#elif CRC32_ARMV8
+  if (getauxval(AT_HWCAP) & HWCAP_CRC32) {
+    check_kernel("armv8", crc32_armv8);
+  } else {
+    fprintf(stderr, "No ARMv8 CRC32 support, left unchecked\n");
+  }
+#endif
+  check_kernel("crc32_update", crc32_update);
+
+  // Chained updates match a single pass
+  for (split = 0; split <= 1024; split += 61) {
+    checksum = crc32_update(crc32(g_buffer, split), &g_buffer[split], 1024 - split);
+    CHECK(checksum == crc32(g_buffer, 1024));
+  }
+  return TEST_EXIT();
+}
@@ -0,0 +1,199 @@
+#include <pthread.h>
+#include <string.h>
+
+#include "uccn/uccn.h"
+#include "uccn/uccn_internal.h"
+
+#include "test.h"
+
+#if CONFIG_UCCN_EXECUTOR
+
+#define DEPTH CONFIG_UCCN_TRACKER_QUEUE_DEPTH
+#define NUM_OVERFLOWING 3
+// The first content holds the callback up while the rest piles up
+#define NUM_POSTED (1 + DEPTH + NUM_OVERFLOWING)
+
+static bool g_gate_open;
+static bool g_held_up;
+static size_t g_num_received;
+static uint8_t g_received[NUM_POSTED];
+
+static void on_content(struct uccn_content_tracker_s * tracker, void * content)
+{
+  size_t i;
+  struct timespec delay;
+  struct buffer_head_s * blob = content;
+  (void)tracker;
+
+  TIMESPEC_MICROSECONDS_INIT(&delay, 1000);
+  i = __atomic_load_n(&g_num_received, __ATOMIC_ACQUIRE);
+  if (i < NUM_POSTED) {
+    g_received[i] = ((uint8_t *)blob->data)[0];
+  }
+  if (i == 0) {
+    __atomic_store_n(&g_held_up, true, __ATOMIC_RELEASE);
+    while (!__atomic_load_n(&g_gate_open, __ATOMIC_ACQUIRE)) {
+      nanosleep(&delay, NULL);
+    }
+  }
+  __atomic_store_n(&g_num_received, i + 1, __ATOMIC_RELEASE);
+}
+
+// Waits a while for a flag to be set, or for a count to be reached
+static bool wait_for(const bool * flag, const size_t * count, size_t expected)
+{
+  size_t i;
+  struct timespec delay;
+
+  TIMESPEC_MICROSECONDS_INIT(&delay, 1000);
+  for (i = 0; i < 1000; ++i) {
+    if (flag != NULL ? __atomic_load_n(flag, __ATOMIC_ACQUIRE) :
+        __atomic_load_n(count, __ATOMIC_ACQUIRE) >= expected) {
+      return true;
+    }
+    nanosleep(&delay, NULL);
+  }
+  return false;
+}
+
+struct feeder_s
+{
+  struct uccn_node_s * node;
+  struct sockaddr_in origin;
+  uint32_t hash;
+  uint8_t first, last;
+  size_t num_fed;
+};
+
+// Feeds the node content as if it came from the given peer address
+static int receive_content(struct feeder_s * feeder, uint8_t sequence)
+{
+  char storage[UCCN_CONTENT_HEADER_SIZE + 1];
+  struct buffer_head_s packet;
+  size_t length;
+
+  length = uccn_write_content_header(storage, feeder->hash, NULL, 1);
+  storage[length] = (char)sequence;
+  packet.data = storage;
+  packet.size = packet.length = length + 1;
+  return uccn_process_incoming(feeder->node, &feeder->origin, &packet);
+}
+
+static void * feeder_main(void * arg)
+{
+  uint8_t i;
+  struct feeder_s * feeder = arg;
+
+  for (i = feeder->first; i <= feeder->last; ++i) {
+    CHECK(receive_content(feeder, i) >= 0);
+    __atomic_add_fetch(&feeder->num_fed, 1, __ATOMIC_RELEASE);
+  }
+  return NULL;
+}
+
+static void test_policy(enum uccn_overflow_policy_e policy)
+{
+  size_t i, num_fed;
+  pthread_t thread;
+  struct timespec delay;
+  struct uccn_node_s node;
+  struct uccn_raw_data_s resource;
+  struct uccn_content_tracker_s * tracker;
+  struct uccn_tracker_stats_s stats;
+  struct feeder_s feeder;
+
+  g_gate_open = g_held_up = false;
+  g_num_received = 0;
+  memset(g_received, 0xFF, sizeof(g_received));
+  if (test_node_init(&node, "tracker") != 0) {
+    fprintf(stderr, "Failed to initialize node\n");
+    ++g_test_failures;
+    return;
+  }
+  uccn_raw_data_init(&resource, "/test/queue");
+  tracker = uccn_track(&node, &resource.base, on_content, NULL);
+  CHECK(tracker != NULL);
+  CHECK(uccn_set_overflow_policy(tracker, policy) == 0);
+
+  memset(&feeder, 0, sizeof(feeder));
+  feeder.node = &node;
+  feeder.hash = resource.base.hash;
+  // Nobody listens there, nothing is sent back for content either way
+  feeder.origin.sin_family = AF_INET;
+  feeder.origin.sin_port = htons(9);
+  inet_aton("127.0.0.1", &feeder.origin.sin_addr);
+
+  // Hold the callback up, then overflow its queue
+  CHECK(receive_content(&feeder, 0) >= 0);
+  CHECK(wait_for(&g_held_up, NULL, 0));
+  feeder.first = 1;
+  feeder.last = NUM_POSTED - 1;
+  CHECK(pthread_create(&thread, NULL, feeder_main, &feeder) == 0);
+  if (policy == UCCN_BLOCK) {
+    // Content past the queue depth waits for room
+    CHECK(wait_for(NULL, &feeder.num_fed, DEPTH));
+    TIMESPEC_MICROSECONDS_INIT(&delay, 50000);
+    nanosleep(&delay, NULL);
+    num_fed = __atomic_load_n(&feeder.num_fed, __ATOMIC_ACQUIRE);
+    CHECK(num_fed == DEPTH);
+  } else {
+    CHECK(pthread_join(thread, NULL) == 0);
+  }
+  CHECK(uccn_get_tracker_stats(tracker, &stats) == 0);
+  CHECK(stats.queue_depth == DEPTH);
+  CHECK(stats.num_dispatched == 0);
+  CHECK(stats.num_dropped == (policy == UCCN_BLOCK ? 0 : NUM_OVERFLOWING));
+
+  __atomic_store_n(&g_gate_open, true, __ATOMIC_RELEASE);
+  if (policy == UCCN_BLOCK) {
+    CHECK(pthread_join(thread, NULL) == 0);
+  }
+  switch (policy) {
+    case UCCN_DROP_OLDEST:
+      CHECK(wait_for(NULL, &g_num_received, 1 + DEPTH));
+      CHECK(g_received[0] == 0);
+      for (i = 1; i <= DEPTH; ++i) {
+        CHECK(g_received[i] == i + NUM_OVERFLOWING);
+      }
+      break;
+    case UCCN_DROP_NEWEST:
+      CHECK(wait_for(NULL, &g_num_received, 1 + DEPTH));
+      for (i = 0; i <= DEPTH; ++i) {
+        CHECK(g_received[i] == i);
+      }
+      break;
+    case UCCN_BLOCK:
+      CHECK(wait_for(NULL, &g_num_received, NUM_POSTED));
+      for (i = 0; i < NUM_POSTED; ++i) {
+        CHECK(g_received[i] == i);
+      }
+      break;
+  }
+  // Nothing else trickles in
+  TIMESPEC_MICROSECONDS_INIT(&delay, 10000);
+  nanosleep(&delay, NULL);
+  CHECK(g_num_received == (policy == UCCN_BLOCK ? NUM_POSTED : 1 + DEPTH));
+  CHECK(uccn_get_tracker_stats(tracker, &stats) == 0);
+  CHECK(stats.queue_depth == 0);
+  CHECK(stats.num_dispatched == g_num_received);
+  CHECK(stats.num_dropped == (policy == UCCN_BLOCK ? 0 : NUM_OVERFLOWING));
+
+  CHECK(uccn_node_fini(&node) == 0);
+}
+
+int main(void)
+{
+  test_policy(UCCN_DROP_OLDEST);
+  test_policy(UCCN_DROP_NEWEST);
+  test_policy(UCCN_BLOCK);
+  return TEST_EXIT();
+}
+
+#else
+
+int main(void)
+{
+  return TEST_SKIPPED;
+}
+
+#endif
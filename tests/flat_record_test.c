@@ -0,0 +1,115 @@
+#include <string.h>
+
+#include "uccn/uccn.h"
+
+#include "test.h"
+
+struct pose_s
+{
+  uint32_t sequence;
+  double position[3];
+  float heading;
+};
+
+#define POSE_SCHEMA  0x7C0FFEE1
+
+static const struct uccn_record_typesupport_s g_pose_typesupport =
+    UCCN_FLAT_TYPESUPPORT(struct pose_s, POSE_SCHEMA);
+
+// Same layout, different schema, e.g. a field renamed or reinterpreted
+static const struct uccn_record_typesupport_s g_other_pose_typesupport =
+    UCCN_FLAT_TYPESUPPORT(struct pose_s, POSE_SCHEMA + 1);
+
+static ssize_t pack(const struct uccn_record_s * record, const void * content,
+                    struct buffer_head_s * blob)
+{
+  return record->base.pack(&record->base, content, &blob);
+}
+
+static ssize_t unpack(const struct uccn_record_s * record,
+                      const struct buffer_head_s * blob, void * content)
+{
+  return record->base.unpack(&record->base, blob, &content);
+}
+
+static void test_round_trip(void)
+{
+  uint32_t schema;
+  char storage[256];
+  struct buffer_head_s blob;
+  struct pose_s sent, received;
+  struct uccn_record_s record;
+
+  uccn_record_init(&record, "/test/pose", &g_pose_typesupport);
+  CHECK(record.base.content_size == sizeof(struct pose_s));
+
+  memset(&sent, 0, sizeof(sent));
+  sent.sequence = 7;
+  sent.position[0] = 1.5;
+  sent.position[1] = -2.25;
+  sent.position[2] = 1e9;
+  sent.heading = 0.125f;
+  blob.data = storage;
+  blob.size = sizeof(storage);
+  blob.length = 0;
+  CHECK(pack(&record, &sent, &blob) == UCCN_FLAT_RECORD_HEADER_SIZE + sizeof(sent));
+  CHECK(blob.length == UCCN_FLAT_RECORD_HEADER_SIZE + sizeof(sent));
+  // Schema hash first, record as laid out in memory right after
+  memcpy(&schema, storage, sizeof(schema));
+  CHECK(schema == POSE_SCHEMA);
+  CHECK(memcmp(&storage[UCCN_FLAT_RECORD_HEADER_SIZE], &sent, sizeof(sent)) == 0);
+
+  memset(&received, 0xFF, sizeof(received));
+  CHECK(unpack(&record, &blob, &received) == (ssize_t)blob.length);
+  CHECK(memcmp(&received, &sent, sizeof(sent)) == 0);
+}
+
+static void test_rejects(void)
+{
+  char storage[256];
+  struct buffer_head_s blob;
+  struct pose_s sent, received, untouched;
+  struct uccn_record_s record, other_record;
+
+  uccn_record_init(&record, "/test/pose", &g_pose_typesupport);
+  uccn_record_init(&other_record, "/test/pose", &g_other_pose_typesupport);
+  memset(&sent, 0, sizeof(sent));
+  sent.sequence = 9;
+  blob.data = storage;
+  blob.size = sizeof(storage);
+  blob.length = 0;
+  CHECK(pack(&record, &sent, &blob) > 0);
+
+  // Records of another schema are turned away, and left alone
+  memset(&received, 0xFF, sizeof(received));
+  untouched = received;
+  CHECK(unpack(&other_record, &blob, &received) < 0);
+  CHECK(memcmp(&received, &untouched, sizeof(received)) == 0);
+  // Both ways
+  CHECK(pack(&other_record, &sent, &blob) > 0);
+  CHECK(unpack(&record, &blob, &received) < 0);
+  CHECK(memcmp(&received, &untouched, sizeof(received)) == 0);
+
+  // So are truncated or padded ones
+  CHECK(pack(&record, &sent, &blob) > 0);
+  --blob.length;
+  CHECK(unpack(&record, &blob, &received) < 0);
+  blob.length += 2;
+  CHECK(unpack(&record, &blob, &received) < 0);
+  blob.length = 0;
+  CHECK(unpack(&record, &blob, &received) < 0);
+  CHECK(memcmp(&received, &untouched, sizeof(received)) == 0);
+
+  // Records that do not fit are not packed
+  blob.size = UCCN_FLAT_RECORD_HEADER_SIZE + sizeof(sent) - 1;
+  CHECK(pack(&record, &sent, &blob) < 0);
+  blob.size = UCCN_FLAT_RECORD_HEADER_SIZE + sizeof(sent);
+  CHECK(pack(&record, &sent, &blob) == (ssize_t)blob.size);
+}
+
+int main(void)
+{
+  test_round_trip();
+  test_rejects();
+  return TEST_EXIT();
+}
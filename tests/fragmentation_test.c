@@ -0,0 +1,167 @@
+#include <string.h>
+
+#include "uccn/uccn.h"
+#include "uccn/uccn_internal.h"
+
+#include "test.h"
+
+#if CONFIG_UCCN_FRAGMENTATION
+
+#define CONTENT_SIZE 1000
+#define NUM_FRAGMENTS 4
+#define FRAGMENT_SIZE (CONTENT_SIZE / NUM_FRAGMENTS)
+
+static char g_content[CONTENT_SIZE];
+static size_t g_num_received;
+static bool g_intact;
+
+static void on_content(struct uccn_content_tracker_s * tracker, void * content)
+{
+  struct buffer_head_s * blob = content;
+  (void)tracker;
+  g_intact = blob->length == CONTENT_SIZE && memcmp(blob->data, g_content, CONTENT_SIZE) == 0;
+  __atomic_add_fetch(&g_num_received, 1, __ATOMIC_RELEASE);
+}
+
+// Content received so far, waiting a while for as much as expected in case
+// it is dispatched by executor threads
+static size_t num_received(size_t expected)
+{
+  size_t i, count = 0;
+  struct timespec delay;
+
+  TIMESPEC_MICROSECONDS_INIT(&delay, 1000);
+  for (i = 0; i < 1000; ++i) {
+    count = __atomic_load_n(&g_num_received, __ATOMIC_ACQUIRE);
+    if (count >= expected) {
+      break;
+    }
+    nanosleep(&delay, NULL);
+  }
+  return count;
+}
+
+// Feeds the node a fragment as if it came from the given peer address
+static int receive_fragment(struct uccn_node_s * node, struct sockaddr_in * origin,
+                            uint32_t hash, uint32_t sequence, uint16_t index)
+{
+  char storage[UCCN_FRAGMENT_HEADER_SIZE + FRAGMENT_SIZE];
+  struct buffer_head_s packet;
+  size_t length;
+
+  length = uccn_write_fragment_header(storage, hash, sequence, index, NUM_FRAGMENTS,
+                                      CONTENT_SIZE, NULL, FRAGMENT_SIZE);
+  memcpy(&storage[length], &g_content[index * FRAGMENT_SIZE], FRAGMENT_SIZE);
+  packet.data = storage;
+  packet.size = packet.length = length + FRAGMENT_SIZE;
+  return uccn_process_incoming(node, origin, &packet);
+}
+
+// Reassemblies still waiting for fragments
+static size_t count_reassemblies(const struct uccn_node_s * node)
+{
+  size_t i, count = 0;
+  for (i = 0; i < CONFIG_UCCN_MAX_NUM_REASSEMBLIES; ++i) {
+    count += node->reassemblies[i].buffer.data != NULL;
+  }
+  return count;
+}
+
+int main(void)
+{
+  size_t i;
+  uint32_t hash;
+  struct uccn_node_s node;
+  struct uccn_raw_data_s resource;
+  struct sockaddr_in origin;
+  struct timespec later, next_deadline;
+  static const uint16_t reordered[NUM_FRAGMENTS] = { 2, 0, 3, 1 };
+
+  for (i = 0; i < CONTENT_SIZE; ++i) {
+    g_content[i] = (char)(i * 7);
+  }
+  if (test_node_init(&node, "tracker") != 0) {
+    fprintf(stderr, "Failed to initialize node\n");
+    return EXIT_FAILURE;
+  }
+  uccn_raw_data_init(&resource, "/test/fragments");
+  hash = resource.base.hash;
+  CHECK(uccn_track(&node, &resource.base, on_content, NULL) != NULL);
+  // Nobody listens there, nothing is sent back for content either way
+  origin.sin_family = AF_INET;
+  origin.sin_port = htons(9);
+  inet_aton("127.0.0.1", &origin.sin_addr);
+
+  // In order
+  for (i = 0; i < NUM_FRAGMENTS; ++i) {
+    CHECK(receive_fragment(&node, &origin, hash, 1, i) >= 0);
+    CHECK(num_received(i + 1 == NUM_FRAGMENTS) == (i + 1 == NUM_FRAGMENTS));
+  }
+  CHECK(g_intact);
+  CHECK(count_reassemblies(&node) == 0);
+
+  // Reordered, with a duplicate
+  g_num_received = 0;
+  for (i = 0; i < NUM_FRAGMENTS; ++i) {
+    CHECK(receive_fragment(&node, &origin, hash, 2, reordered[i]) >= 0);
+    if (i == 1) {
+      CHECK(receive_fragment(&node, &origin, hash, 2, reordered[i]) >= 0);
+    }
+  }
+  CHECK(num_received(1) == 1);
+  CHECK(g_intact);
+
+  // Lost fragment, content is dropped once superseded
+  g_num_received = 0;
+  CHECK(receive_fragment(&node, &origin, hash, 3, 0) >= 0);
+  CHECK(receive_fragment(&node, &origin, hash, 3, 2) >= 0);
+  CHECK(receive_fragment(&node, &origin, hash, 3, 3) >= 0);
+  CHECK(count_reassemblies(&node) == 1);
+  for (i = 0; i < NUM_FRAGMENTS; ++i) {
+    CHECK(receive_fragment(&node, &origin, hash, 4, i) >= 0);
+  }
+  CHECK(num_received(1) == 1);
+  CHECK(g_intact);
+  // The missing fragment showing up late changes nothing
+  CHECK(receive_fragment(&node, &origin, hash, 3, 1) >= 0);
+  CHECK(num_received(1) == 1);
+  CHECK(count_reassemblies(&node) == 0);
+
+  // Timed out, and then completed too late
+  g_num_received = 0;
+  CHECK(receive_fragment(&node, &origin, hash, 4, 1) >= 0);
+  CHECK(count_reassemblies(&node) == 0);
+  CHECK(receive_fragment(&node, &origin, hash, 5, 0) >= 0);
+  CHECK(receive_fragment(&node, &origin, hash, 5, 1) >= 0);
+  CHECK(count_reassemblies(&node) == 1);
+  clock_gettime(CLOCK_MONOTONIC, &later);
+  TIMESPEC_INF_INIT(&next_deadline);
+  uccn_expire_reassemblies(&node, &later, &next_deadline);
+  CHECK(count_reassemblies(&node) == 1);
+  CHECK(TIMESPEC_ISFINITE(&next_deadline));
+  later.tv_sec += CONFIG_UCCN_REASSEMBLY_TIMEOUT_MS / 1000 + 1;
+  uccn_expire_reassemblies(&node, &later, &next_deadline);
+  CHECK(count_reassemblies(&node) == 0);
+  CHECK(receive_fragment(&node, &origin, hash, 5, 2) >= 0);
+  CHECK(receive_fragment(&node, &origin, hash, 5, 3) >= 0);
+  CHECK(num_received(0) == 0);
+  CHECK(count_reassemblies(&node) == 0);
+  // Later content still goes through
+  for (i = 0; i < NUM_FRAGMENTS; ++i) {
+    CHECK(receive_fragment(&node, &origin, hash, 6, i) >= 0);
+  }
+  CHECK(num_received(1) == 1);
+  CHECK(g_intact);
+
+  CHECK(uccn_node_fini(&node) == 0);
+  return TEST_EXIT();
+}
+
+#else
+
+int main(void)
+{
+  return TEST_SKIPPED;
+}
+
+#endif
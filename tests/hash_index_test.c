@@ -0,0 +1,92 @@
+#include <stdint.h>
+
+#include "uccn/common/hash_index.h"
+
+#include "test.h"
+
+#define CAPACITY HASH_INDEX_CAPACITY(8)
+
+// Keys landing on the given slot, i.e. that collide with one another
+static uint32_t colliding_key(size_t slot, uint32_t n)
+{
+  uint32_t hi = n + 1;
+  return (hi << 16) | ((slot ^ hi) & 0xFFFF);
+}
+
+static void test_capacity(void)
+{
+  CHECK(HASH_INDEX_CAPACITY(1) == 2);
+  CHECK(HASH_INDEX_CAPACITY(5) == 16);
+  CHECK(HASH_INDEX_CAPACITY(8) == 16);
+  CHECK(HASH_INDEX_CAPACITY(9) == 32);
+  CHECK(hash_index_capacity(5) == HASH_INDEX_CAPACITY(5));
+  CHECK(hash_index_capacity(9) == HASH_INDEX_CAPACITY(9));
+}
+
+static void test_collisions(void)
+{
+  uint32_t i;
+  int values[8];
+  struct hash_index_s index;
+  struct hash_index_entry_s entries[CAPACITY];
+
+  hash_index_init(&index, entries, CAPACITY);
+  // The last slot, for probes to wrap around
+  for (i = 0; i < 4; ++i) {
+    CHECK(hash_index_slot(&index, colliding_key(CAPACITY - 1, i)) == CAPACITY - 1);
+    CHECK(hash_index_insert(&index, colliding_key(CAPACITY - 1, i), &values[i]) == 1);
+  }
+  // Right where the first cluster spilled over
+  for (i = 4; i < 8; ++i) {
+    CHECK(hash_index_insert(&index, colliding_key(0, i), &values[i]) == 1);
+  }
+  CHECK(index.count == 8);
+  for (i = 0; i < 4; ++i) {
+    CHECK(hash_index_find(&index, colliding_key(CAPACITY - 1, i)) == &values[i]);
+  }
+  for (i = 4; i < 8; ++i) {
+    CHECK(hash_index_find(&index, colliding_key(0, i)) == &values[i]);
+  }
+  // Misses probe past every colliding key
+  CHECK(hash_index_find(&index, colliding_key(CAPACITY - 1, 100)) == NULL);
+  CHECK(hash_index_find(&index, colliding_key(0, 100)) == NULL);
+
+  // Keys already in are updated, not added again
+  CHECK(hash_index_insert(&index, colliding_key(CAPACITY - 1, 2), &values[0]) == 0);
+  CHECK(hash_index_find(&index, colliding_key(CAPACITY - 1, 2)) == &values[0]);
+  CHECK(index.count == 8);
+}
+
+static void test_full_table(void)
+{
+  uint32_t i;
+  int values[CAPACITY];
+  struct hash_index_s index;
+  struct hash_index_entry_s entries[CAPACITY];
+
+  hash_index_init(&index, entries, CAPACITY);
+  CHECK(hash_index_insert(&index, 0, &values[0]) == -1);
+  for (i = 1; i <= CAPACITY / 2; ++i) {
+    CHECK(hash_index_insert(&index, colliding_key(3, i), &values[i - 1]) == 1);
+  }
+  // Half full is full, so that probes always end on an empty slot
+  CHECK(hash_index_insert(&index, colliding_key(3, 0), &values[0]) == -1);
+  CHECK(hash_index_insert(&index, 0xDEADBEEF, &values[0]) == -1);
+  CHECK(index.count == CAPACITY / 2);
+  for (i = 1; i <= CAPACITY / 2; ++i) {
+    CHECK(hash_index_find(&index, colliding_key(3, i)) == &values[i - 1]);
+  }
+  CHECK(hash_index_find(&index, 0xDEADBEEF) == NULL);
+  CHECK(hash_index_find(&index, 0) == NULL);
+  // Updates still go through
+  CHECK(hash_index_insert(&index, colliding_key(3, 1), &values[1]) == 0);
+  CHECK(hash_index_find(&index, colliding_key(3, 1)) == &values[1]);
+}
+
+int main(void)
+{
+  test_capacity();
+  test_collisions();
+  test_full_table();
+  return TEST_EXIT();
+}
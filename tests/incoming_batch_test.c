@@ -0,0 +1,96 @@
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/socket.h>
+
+#include "uccn/uccn.h"
+#include "uccn/uccn_internal.h"
+
+#include "test.h"
+
+// Only batches carry packets past a bad one, and receive workers would
+// take content off the node socket
+#if CONFIG_UCCN_BATCHED_IO && CONFIG_UCCN_NUM_RECEIVE_WORKERS == 0
+
+#define CONTENT_SIZE 16
+
+static size_t g_num_received;
+
+static void on_content(struct uccn_content_tracker_s * tracker, void * content)
+{
+  (void)tracker;
+  (void)content;
+  __atomic_add_fetch(&g_num_received, 1, __ATOMIC_RELEASE);
+}
+
+// Content received so far, waiting a while for as much as expected in case
+// it is dispatched by executor threads
+static size_t num_received(size_t expected)
+{
+  size_t i, count = 0;
+  struct timespec delay;
+
+  TIMESPEC_MICROSECONDS_INIT(&delay, 1000);
+  for (i = 0; i < 1000; ++i) {
+    count = __atomic_load_n(&g_num_received, __ATOMIC_ACQUIRE);
+    if (count >= expected) {
+      break;
+    }
+    nanosleep(&delay, NULL);
+  }
+  return count;
+}
+
+static int send_content(int sockfd, const struct sockaddr_in * address, uint32_t hash)
+{
+  char packet[UCCN_CONTENT_HEADER_SIZE + CONTENT_SIZE];
+  size_t length;
+
+  length = uccn_write_content_header(packet, hash, NULL, CONTENT_SIZE);
+  memset(&packet[length], 0x5A, CONTENT_SIZE);
+  return sendto(sockfd, packet, length + CONTENT_SIZE, 0,
+                (const struct sockaddr *)address, sizeof(*address)) < 0 ? -1 : 0;
+}
+
+int main(void)
+{
+  int sockfd;
+  struct uccn_node_s node;
+  struct uccn_raw_data_s resource;
+  // Never used by MessagePack
+  static const char garbage[] = { (char)0xC1, (char)0xC1 };
+
+  if (test_node_init(&node, "tracker") != 0) {
+    fprintf(stderr, "Failed to initialize node\n");
+    return EXIT_FAILURE;
+  }
+  uccn_raw_data_init(&resource, "/test/batch");
+  CHECK(uccn_track(&node, &resource.base, on_content, NULL) != NULL);
+  if ((sockfd = socket(PF_INET, SOCK_DGRAM, 0)) < 0) {
+    perror("Failed to create socket");
+    return EXIT_FAILURE;
+  }
+
+  // Content before and after a bad packet, all in the same batch
+  CHECK(send_content(sockfd, &node.address, resource.base.hash) == 0);
+  CHECK(sendto(sockfd, garbage, sizeof(garbage), 0, (struct sockaddr *)&node.address,
+               sizeof(node.address)) == sizeof(garbage));
+  CHECK(send_content(sockfd, &node.address, resource.base.hash) == 0);
+  CHECK(send_content(sockfd, &node.address, resource.base.hash) == 0);
+  // The bad packet is told about, once the rest is through
+  CHECK(uccn_process_incoming_unicast(&node) < 0);
+  CHECK(num_received(3) == 3);
+
+  close(sockfd);
+  CHECK(uccn_node_fini(&node) == 0);
+  return TEST_EXIT();
+}
+
+#else
+
+int main(void)
+{
+  return TEST_SKIPPED;
+}
+
+#endif
@@ -0,0 +1,170 @@
+#include <string.h>
+
+#include "uccn/uccn.h"
+#include "uccn/uccn_internal.h"
+
+#include "test.h"
+
+struct sample_s
+{
+  uint32_t sequence;
+  float value;
+};
+
+static const struct uccn_record_typesupport_s g_sample_typesupport =
+    UCCN_FLAT_TYPESUPPORT(struct sample_s, 0x5A3B1E01);
+
+// Borrows everything there is to borrow, checking loans are all apart
+static size_t borrow_all(struct uccn_content_provider_s * provider, void ** loans, size_t n)
+{
+  size_t i, j;
+
+  for (i = 0; i < n; ++i) {
+    if ((loans[i] = uccn_borrow(provider)) == NULL) {
+      break;
+    }
+    for (j = 0; j < i; ++j) {
+      CHECK(loans[j] != loans[i]);
+    }
+  }
+  CHECK(uccn_borrow(provider) == NULL);
+  return i;
+}
+
+// Objects from the provider pool go back whether published or discarded
+static void test_content_objects(struct uccn_node_s * node)
+{
+  size_t i, num_loans;
+  void * loans[CONFIG_UCCN_CONTENT_POOL_SIZE + 1];
+  struct sample_s * sample;
+  struct uccn_record_s record;
+  struct uccn_content_provider_s * provider;
+
+  uccn_record_init(&record, "/test/loans/record", &g_sample_typesupport);
+  provider = uccn_advertise(node, &record.base);
+  CHECK(provider != NULL);
+  if (provider == NULL) {
+    return;
+  }
+  CHECK(provider->pool.objects != NULL);
+
+  num_loans = borrow_all(provider, loans, CONFIG_UCCN_CONTENT_POOL_SIZE + 1);
+  CHECK(num_loans == CONFIG_UCCN_CONTENT_POOL_SIZE);
+  CHECK(provider->pool.in_use == (1u << CONFIG_UCCN_CONTENT_POOL_SIZE) - 1);
+
+  // A discarded object is lent again as it was left
+  sample = loans[0];
+  sample->sequence = 42;
+  uccn_discard(provider, sample);
+  CHECK(provider->pool.in_use == (1u << CONFIG_UCCN_CONTENT_POOL_SIZE) - 2);
+  loans[0] = uccn_borrow(provider);
+  CHECK(loans[0] == sample);
+  CHECK(sample->sequence == 42);
+  CHECK(uccn_borrow(provider) == NULL);
+
+  // Published objects go back too, even with nobody to publish to
+  for (i = 0; i < num_loans; ++i) {
+    CHECK(uccn_publish(provider, loans[i]) == 0);
+  }
+  CHECK(provider->pool.in_use == 0);
+
+  // Many more rounds than objects, for leaks to show up as failed loans
+  for (i = 0; i < 16 * CONFIG_UCCN_CONTENT_POOL_SIZE; ++i) {
+    sample = uccn_borrow(provider);
+    CHECK(sample != NULL);
+    if (sample == NULL) {
+      break;
+    }
+    sample->sequence = i;
+    if (i % 2 == 0) {
+      CHECK(uccn_publish(provider, sample) == 0);
+    } else {
+      uccn_discard(provider, sample);
+    }
+  }
+  CHECK(provider->pool.in_use == 0);
+}
+
+// Raw content providers get node loan buffers instead
+static void test_loan_buffers(struct uccn_node_s * node)
+{
+  size_t i, num_loans;
+  void * loans[CONFIG_UCCN_NUM_LOAN_BUFFERS + 1];
+  struct buffer_head_s * window;
+  struct uccn_raw_data_s resource;
+  struct uccn_content_provider_s * provider;
+
+  uccn_raw_data_init(&resource, "/test/loans/raw");
+  provider = uccn_advertise(node, &resource.base);
+  CHECK(provider != NULL);
+  if (provider == NULL) {
+    return;
+  }
+  CHECK(provider->pool.objects == NULL);
+
+  num_loans = borrow_all(provider, loans, CONFIG_UCCN_NUM_LOAN_BUFFERS + 1);
+  CHECK(num_loans == CONFIG_UCCN_NUM_LOAN_BUFFERS);
+#if CONFIG_UCCN_NUM_LOAN_BUFFERS > 0
+  CHECK(node->loan_buffers_in_use == (1u << CONFIG_UCCN_NUM_LOAN_BUFFERS) - 1);
+  for (i = 0; i < num_loans; ++i) {
+    window = loans[i];
+    CHECK(window->length == 0);
+    CHECK(window->size > 0);
+  }
+
+  // Discarded buffers are lent again
+  uccn_discard(provider, loans[0]);
+  CHECK(node->loan_buffers_in_use == (1u << CONFIG_UCCN_NUM_LOAN_BUFFERS) - 2);
+  CHECK(uccn_borrow(provider) == loans[0]);
+
+  // Overrun buffers fail to publish, and still go back. Pretend there is
+  // a peer to publish to, for the overrun to be checked at all.
+  window = loans[0];
+  window->length = window->size + 1;
+  __atomic_store_n(&provider->endpoint.num_peers, 1, __ATOMIC_RELAXED);
+  CHECK(uccn_publish(provider, window) < 0);
+  __atomic_store_n(&provider->endpoint.num_peers, 0, __ATOMIC_RELAXED);
+  CHECK(node->loan_buffers_in_use == (1u << CONFIG_UCCN_NUM_LOAN_BUFFERS) - 2);
+
+  // Borrowed buffers start empty again
+  window = uccn_borrow(provider);
+  CHECK(window == loans[0]);
+  CHECK(window != NULL && window->length == 0);
+  for (i = 0; i < num_loans; ++i) {
+    CHECK(uccn_publish(provider, loans[i]) == 0);
+  }
+  CHECK(node->loan_buffers_in_use == 0);
+
+  for (i = 0; i < 16 * CONFIG_UCCN_NUM_LOAN_BUFFERS; ++i) {
+    window = uccn_borrow(provider);
+    CHECK(window != NULL);
+    if (window == NULL) {
+      break;
+    }
+    window->length = 1;
+    if (i % 2 == 0) {
+      CHECK(uccn_publish(provider, window) == 0);
+    } else {
+      uccn_discard(provider, window);
+    }
+  }
+  CHECK(node->loan_buffers_in_use == 0);
+#else
+  (void)i;
+  (void)window;
+#endif
+}
+
+int main(void)
+{
+  struct uccn_node_s node;
+
+  if (test_node_init(&node, "provider") != 0) {
+    fprintf(stderr, "Failed to initialize node\n");
+    return EXIT_FAILURE;
+  }
+  test_content_objects(&node);
+  test_loan_buffers(&node);
+  CHECK(uccn_node_fini(&node) == 0);
+  return TEST_EXIT();
+}
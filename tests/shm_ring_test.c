@@ -0,0 +1,131 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "uccn/utilities/shm_ring.h"
+
+#include "test.h"
+
+#define CAPACITY 256
+
+static int push(struct shm_ring_s * ring, const char * data, size_t length)
+{
+  struct iovec iov[2];
+
+  // Split in two, as content goes in after its header
+  iov[0].iov_base = (void *)data;
+  iov[0].iov_len = length / 2;
+  iov[1].iov_base = (void *)(data + length / 2);
+  iov[1].iov_len = length - length / 2;
+  return shm_ring_push(ring, CAPACITY, iov, 2);
+}
+
+// Pops the oldest entry, checking it is as expected
+static bool pop(struct shm_ring_s * ring, const char * data, size_t length)
+{
+  void * entry;
+  ssize_t entry_length = shm_ring_peek(ring, CAPACITY, &entry);
+
+  if (entry_length != (ssize_t)length || memcmp(entry, data, length) != 0) {
+    return false;
+  }
+  shm_ring_pop(ring, length);
+  return true;
+}
+
+static void fill(char * data, size_t length, unsigned int seed)
+{
+  size_t i;
+  for (i = 0; i < length; ++i) {
+    data[i] = (char)(seed * 31 + i);
+  }
+}
+
+int main(void)
+{
+  size_t i, length, num_pushed, num_popped;
+  void * entry;
+  char data[CAPACITY], expected[CAPACITY];
+  struct shm_ring_s * ring = aligned_alloc(64, shm_ring_footprint(CAPACITY));
+
+  if (ring == NULL) {
+    fprintf(stderr, "Failed to allocate ring\n");
+    return EXIT_FAILURE;
+  }
+  shm_ring_init(ring, CAPACITY);
+
+  // Empty, then one entry in and out. Only the first push finds the
+  // consumer idle and in need of a wakeup.
+  CHECK(shm_ring_peek(ring, CAPACITY, &entry) == -1);
+  fill(data, 20, 1);
+  CHECK(push(ring, data, 20) == 1);
+  CHECK(push(ring, data, 20) == 0);
+  CHECK(pop(ring, data, 20));
+  CHECK(pop(ring, data, 20));
+  CHECK(shm_ring_peek(ring, CAPACITY, &entry) == -1);
+
+  // Full: 32 byte entries (8 byte headers), eight of them fit
+  shm_ring_init(ring, CAPACITY);
+  for (num_pushed = 0; num_pushed < 16; ++num_pushed) {
+    fill(data, 24, num_pushed);
+    if (push(ring, data, 24) < 0) {
+      break;
+    }
+  }
+  CHECK(num_pushed == CAPACITY / 32);
+  // Room for one more once the oldest is popped
+  fill(expected, 24, 0);
+  CHECK(pop(ring, expected, 24));
+  fill(data, 24, num_pushed);
+  CHECK(push(ring, data, 24) >= 0);
+  CHECK(push(ring, data, 24) == -1);
+  // Never more than it can hold
+  CHECK(push(ring, data, CAPACITY) == -1);
+
+  // Wrap around, many times over, with lengths that do not line up with
+  // the end of the ring
+  shm_ring_init(ring, CAPACITY);
+  num_pushed = num_popped = 0;
+  while (num_popped < 1000) {
+    length = 1 + (num_pushed * 37) % 100;
+    fill(data, length, num_pushed);
+    if (push(ring, data, length) >= 0) {
+      ++num_pushed;
+      continue;
+    }
+    // Full, drain a couple to make room
+    for (i = 0; i < 2 && num_popped < num_pushed; ++i, ++num_popped) {
+      length = 1 + (num_popped * 37) % 100;
+      fill(expected, length, num_popped);
+      if (!pop(ring, expected, length)) {
+        fprintf(stderr, "Entry %zu came out wrong\n", num_popped);
+        CHECK(false);
+        num_popped = 1000;
+        break;
+      }
+    }
+  }
+  CHECK(__atomic_load_n(&ring->head, __ATOMIC_RELAXED) > 10 * CAPACITY);
+
+  // Corrupt: positions further apart than the ring is long
+  shm_ring_init(ring, CAPACITY);
+  ring->head = 2 * CAPACITY;
+  CHECK(shm_ring_peek(ring, CAPACITY, &entry) == -2);
+  // Corrupt: an entry longer than what was pushed
+  shm_ring_init(ring, CAPACITY);
+  fill(data, 24, 0);
+  CHECK(push(ring, data, 24) == 1);
+  memset(ring->data, 0, 4);
+  ring->data[0] = 100;
+  CHECK(shm_ring_peek(ring, CAPACITY, &entry) == -2);
+  // Corrupt: an entry running past the end of the ring
+  shm_ring_init(ring, CAPACITY);
+  ring->head = ring->tail = CAPACITY - 32;
+  CHECK(push(ring, data, 24) == 1);
+  ring->head += 64;
+  memset(&ring->data[CAPACITY - 32], 0, 4);
+  ring->data[CAPACITY - 32] = 56;
+  CHECK(shm_ring_peek(ring, CAPACITY, &entry) == -2);
+
+  free(ring);
+  return TEST_EXIT();
+}
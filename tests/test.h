@@ -0,0 +1,43 @@
+#ifndef TESTS_TEST_H_
+#define TESTS_TEST_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "uccn/uccn.h"
+
+// Checks carry on past failures, tests exit with how many there were.
+// Tests that do not apply to a build may have nothing to check.
+static int g_test_failures __attribute__((unused)) = 0;
+
+#define CHECK(cond)                                                     \
+  do {                                                                  \
+    if (!(cond)) {                                                      \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      ++g_test_failures;                                                \
+    }                                                                   \
+  } while (0)
+
+#define TEST_EXIT() (g_test_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE)
+
+// Tells CTest that the test does not apply to this build
+#define TEST_SKIPPED 77
+
+// Brings up a node on the loopback interface, at default capacity
+static inline int test_node_init(struct uccn_node_s * node, const char * name)
+{
+  struct uccn_network_s network;
+#if CONFIG_UCCN_DYNAMIC_CAPACITY
+  struct uccn_node_capacity_s capacity = UCCN_NODE_CAPACITY_DEFAULT;
+#endif
+
+  inet_aton("127.0.0.1", &network.inetaddr);
+  inet_aton("255.0.0.0", &network.netmask);
+#if CONFIG_UCCN_DYNAMIC_CAPACITY
+  return uccn_node_init(node, &network, name, &capacity, NULL, 0);
+#else
+  return uccn_node_init(node, &network, name);
+#endif
+}
+
+#endif  // TESTS_TEST_H_
@@ -0,0 +1,274 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "uccn/common/time.h"
+#include "uccn/utilities/upoll.h"
+
+#include "test.h"
+
+#define RESOLUTION 1000000  // 1 ms ticks
+#define NUM_TIMERS 256
+
+// Ticks each level spans
+#define LEVEL_SPAN(level) ((uint64_t)1 << (UPOLL_WHEEL_SLOT_BITS * (level)))
+#define WHEEL_SPAN LEVEL_SPAN(UPOLL_WHEEL_NUM_LEVELS)
+
+static const struct timespec g_origin = { .tv_sec = 1000, .tv_nsec = 0 };
+
+static struct timespec tick_time(uint64_t ticks)
+{
+  struct timespec time = g_origin;
+  struct timespec offset;
+
+  offset.tv_sec = ticks / 1000;
+  offset.tv_nsec = (ticks % 1000) * RESOLUTION;
+  timespec_add(&time, &offset);
+  return time;
+}
+
+static uint64_t time_ticks(const struct timespec * time)
+{
+  return (uint64_t)(time->tv_sec - g_origin.tv_sec) * 1000 +
+      (time->tv_nsec - g_origin.tv_nsec) / RESOLUTION;
+}
+
+// Timers the wheel should hold, sorted by expiry
+struct reference_s
+{
+  size_t size;
+  uint64_t expiries[NUM_TIMERS];
+  size_t ids[NUM_TIMERS];
+};
+
+static void reference_remove(struct reference_s * ref, size_t id)
+{
+  size_t i;
+
+  for (i = 0; i < ref->size; ++i) {
+    if (ref->ids[i] == id) {
+      --ref->size;
+      memmove(&ref->expiries[i], &ref->expiries[i + 1], (ref->size - i) * sizeof(uint64_t));
+      memmove(&ref->ids[i], &ref->ids[i + 1], (ref->size - i) * sizeof(size_t));
+      return;
+    }
+  }
+}
+
+static void reference_insert(struct reference_s * ref, size_t id, uint64_t expiry)
+{
+  size_t i;
+
+  reference_remove(ref, id);
+  for (i = ref->size; i > 0 && ref->expiries[i - 1] > expiry; --i) {
+    ref->expiries[i] = ref->expiries[i - 1];
+    ref->ids[i] = ref->ids[i - 1];
+  }
+  ref->expiries[i] = expiry;
+  ref->ids[i] = id;
+  ++ref->size;
+}
+
+struct fixture_s
+{
+  struct upoll_wheel_s wheel;
+  struct upoll_timer_s timers[NUM_TIMERS];
+  struct reference_s ref;
+  uint64_t now;
+};
+
+static void fixture_init(struct fixture_s * fixture)
+{
+  size_t i;
+
+  memset(fixture, 0, sizeof(*fixture));
+  upoll_wheel_init(&fixture->wheel, &g_origin, RESOLUTION);
+  for (i = 0; i < NUM_TIMERS; ++i) {
+    upoll_timer_init(&fixture->timers[i], (void *)(uintptr_t)i);
+  }
+}
+
+static void schedule(struct fixture_s * fixture, size_t id, uint64_t expiry)
+{
+  struct timespec deadline = tick_time(expiry);
+
+  upoll_wheel_schedule(&fixture->wheel, &fixture->timers[id], &deadline);
+  reference_insert(&fixture->ref, id, expiry);
+}
+
+static void cancel(struct fixture_s * fixture, size_t id)
+{
+  upoll_wheel_cancel(&fixture->wheel, &fixture->timers[id]);
+  reference_remove(&fixture->ref, id);
+}
+
+// Checks the next deadline is never past the earliest expiry
+static uint64_t check_next_deadline(struct fixture_s * fixture)
+{
+  struct timespec deadline;
+
+  upoll_wheel_next_deadline(&fixture->wheel, &deadline);
+  if (fixture->ref.size == 0) {
+    CHECK(!TIMESPEC_ISFINITE(&deadline));
+    return UINT64_MAX;
+  }
+  CHECK(TIMESPEC_ISFINITE(&deadline));
+  if (!TIMESPEC_ISFINITE(&deadline)) {
+    return UINT64_MAX;
+  }
+  CHECK(time_ticks(&deadline) <= fixture->ref.expiries[0] ||
+        time_ticks(&deadline) <= fixture->now);
+  return time_ticks(&deadline);
+}
+
+// Advances both the wheel and the reference, and checks that timers
+// expired in either one are the same. Returns how many did.
+static size_t advance(struct fixture_s * fixture, uint64_t now)
+{
+  size_t i, id, num_expired = 0;
+  bool expired[NUM_TIMERS];
+  struct timespec current_time = tick_time(now);
+  struct upoll_timer_s * timer;
+
+  fixture->now = now;
+  memset(expired, 0, sizeof(expired));
+  upoll_wheel_advance(&fixture->wheel, &current_time);
+  while ((timer = upoll_wheel_next_expired(&fixture->wheel)) != NULL) {
+    id = (uintptr_t)timer->arg;
+    CHECK(!upoll_timer_pending(timer));
+    CHECK(!expired[id]);
+    expired[id] = true;
+    ++num_expired;
+  }
+  for (i = 0; i < fixture->ref.size && fixture->ref.expiries[i] <= now; ++i) {
+    CHECK(expired[fixture->ref.ids[i]]);
+    expired[fixture->ref.ids[i]] = false;
+  }
+  CHECK(i == num_expired);
+  for (id = 0; id < NUM_TIMERS; ++id) {
+    CHECK(!expired[id]);
+  }
+  fixture->ref.size -= i;
+  memmove(fixture->ref.expiries, &fixture->ref.expiries[i], fixture->ref.size * sizeof(uint64_t));
+  memmove(fixture->ref.ids, &fixture->ref.ids[i], fixture->ref.size * sizeof(size_t));
+  for (i = 0; i < fixture->ref.size; ++i) {
+    CHECK(upoll_timer_pending(&fixture->timers[fixture->ref.ids[i]]));
+  }
+  return num_expired;
+}
+
+// Timers around level boundaries have to cascade down to expire on time
+static void test_cascade(void)
+{
+  size_t id = 0, level;
+  uint64_t tick;
+  static struct fixture_s fixture;
+
+  fixture_init(&fixture);
+  for (level = 0; level < UPOLL_WHEEL_NUM_LEVELS; ++level) {
+    schedule(&fixture, id++, LEVEL_SPAN(level + 1) - 1);
+    schedule(&fixture, id++, LEVEL_SPAN(level + 1));
+    schedule(&fixture, id++, LEVEL_SPAN(level + 1) + 1);
+    schedule(&fixture, id++, 3 * LEVEL_SPAN(level) + 5);
+  }
+  CHECK(fixture.wheel.overflow != NULL);
+
+  // Tick by tick up to the top level, for every cascade to happen
+  for (tick = 1; tick <= LEVEL_SPAN(UPOLL_WHEEL_NUM_LEVELS - 1) + 1; ++tick) {
+    advance(&fixture, tick);
+  }
+  // Then by leaps, which pass over many slots at once
+  for (; fixture.ref.size > 0; tick += 12345) {
+    advance(&fixture, tick);
+  }
+  CHECK(fixture.wheel.overflow == NULL);
+  check_next_deadline(&fixture);
+}
+
+// Timers beyond the top level's turn wait in the overflow list, and
+// following next deadlines brings them down in time
+static void test_overflow(void)
+{
+  size_t num_expired = 0, num_advances = 0;
+  uint64_t deadline;
+  static struct fixture_s fixture;
+
+  fixture_init(&fixture);
+  schedule(&fixture, 0, WHEEL_SPAN - 1);
+  schedule(&fixture, 1, WHEEL_SPAN);
+  schedule(&fixture, 2, 2 * WHEEL_SPAN + 7);
+  schedule(&fixture, 3, 5 * WHEEL_SPAN + 3);
+  CHECK(fixture.wheel.overflow != NULL);
+
+  while (fixture.ref.size > 0 && num_advances < 1000) {
+    deadline = check_next_deadline(&fixture);
+    num_expired += advance(&fixture, deadline);
+    ++num_advances;
+  }
+  CHECK(num_expired == 4);
+  // One advance per level and overflow turn at most, for each timer
+  CHECK(num_advances <= 4 * (UPOLL_WHEEL_NUM_LEVELS + 6));
+
+  // Deadlines already past expire on the next advance
+  fixture_init(&fixture);
+  advance(&fixture, 100);
+  schedule(&fixture, 0, 50);
+  CHECK(check_next_deadline(&fixture) == 100);
+  CHECK(advance(&fixture, 101) == 1);
+  // Overflowing timers may be cancelled too
+  schedule(&fixture, 1, 3 * WHEEL_SPAN);
+  CHECK(fixture.wheel.overflow != NULL);
+  cancel(&fixture, 1);
+  CHECK(fixture.wheel.overflow == NULL);
+  CHECK(advance(&fixture, 4 * WHEEL_SPAN) == 0);
+  check_next_deadline(&fixture);
+}
+
+// Rescheduling, cancelling and advancing at random, near and far
+static void test_random(void)
+{
+  int op, step;
+  size_t id;
+  uint64_t span, deadline;
+  static struct fixture_s fixture;
+
+  srand(7);
+  fixture_init(&fixture);
+  for (step = 0; step < 200000; ++step) {
+    op = rand() % 10;
+    id = rand() % NUM_TIMERS;
+    if (op < 4) {
+      switch (rand() % 4) {
+        case 0:
+          span = rand() % 64;
+          break;
+        case 1:
+          span = rand() % LEVEL_SPAN(2);
+          break;
+        case 2:
+          span = (uint64_t)rand() % LEVEL_SPAN(UPOLL_WHEEL_NUM_LEVELS);
+          break;
+        default:
+          span = (uint64_t)rand() % (3 * WHEEL_SPAN);
+          break;
+      }
+      schedule(&fixture, id, fixture.now + span);
+    } else if (op < 5) {
+      cancel(&fixture, id);
+    } else {
+      deadline = check_next_deadline(&fixture);
+      if (deadline != UINT64_MAX && deadline > fixture.now && rand() % 2 == 0) {
+        advance(&fixture, deadline);
+      } else {
+        advance(&fixture, fixture.now + rand() % 300);
+      }
+    }
+  }
+}
+
+int main(void)
+{
+  test_cascade();
+  test_overflow();
+  test_random();
+  return TEST_EXIT();
+}